@@ -44,6 +44,12 @@ namespace ACDCGenerator {
  * are then sampled rather efficiently. Functions with narrow peaks
  * should, however, be avoided since there is no guarantee that the
  * peack is actually hit.
+ *
+ * The cells are kept in a binary tree for each function, which is
+ * refined in the compensation procedure. When not compensating, cells
+ * are instead chosen from a flat ACDCGenCellTable of all the cells
+ * which have not been split, which is rebuilt whenever the trees have
+ * changed.
  */
 template <typename Rnd, typename FncPtr>
 class ACDCGen {
@@ -94,6 +100,16 @@ public:
    */
   inline bool addFunction(DimType dim, FncPtrType f, double maxrat = -1.0);
 
+  /**
+   * Add a function \a f of a given dimension, \a dim, for which the
+   * tree of cells has already been built by adding an equivalent
+   * function last to the generator \a built, typically on a separate
+   * thread. The tree of cells is moved from \a built to this
+   * generator, and the function is removed from \a built. Returns
+   * the value returned when the function was added to \a built.
+   */
+  inline bool addFunction(DimType dim, FncPtrType f, ACDCGen & built);
+
   /**
    * Remove all added functions and reset the generator;
    */
@@ -325,17 +341,22 @@ public:
   /**
    * This function is to be used in ThePEG for output to
    * a persistent stream and will not work properly for normal
-   * ostreams.
+   * ostreams. If \a functions is false, the function objects are
+   * not written, so that the cells can be read in again for other
+   * function objects.
    */
   template <typename POStream>
-  void output(POStream &) const;
+  void output(POStream &, bool functions = true) const;
 
   /**
    * This function is to be used in ThePEG for input from a persistent
-   * stream and will not work properly for normal istreams.
+   * stream and will not work properly for normal istreams. If \a
+   * functions is false, the stream must have been written by
+   * output() without function objects, and all function objects are
+   * set to \a f instead.
    */
   template <typename PIStream>
-  void input(PIStream &);
+  void input(PIStream &, bool functions = true, FncPtr f = FncPtr());
 
 private:
 
@@ -400,7 +421,9 @@ private:
 
   /**
    * Choose a function according to its overestimated integral and
-   * choose a cell to generate a point in.
+   * choose a cell to generate a point in. Unless compensating, the
+   * cell is chosen directly from a flat table of the cells which have
+   * not been split, which is rebuilt whenever the cells have changed.
    */
   inline void chooseCell(DVector & lo, DVector & up);
 
@@ -512,6 +535,12 @@ private:
    */
   double theLastF;
 
+  /**
+   * The flat table of the cells which have not been split, used to
+   * choose cells when not compensating.
+   */
+  ACDCGenCellTable theCellTable;
+
   /**
    * A helper struct representing a level of compensation.
    */
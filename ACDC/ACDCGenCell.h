@@ -234,6 +234,127 @@ private:
 };
 
 
+/**
+ * ACDCGenCellTable is a flat representation of the cells which have
+ * not been split in the trees of ACDCGenCell objects used for a
+ * number of functions. The cells are stored in a contiguous array
+ * together with their corners, and an alias table over their
+ * overestimated integrals allows a cell to be chosen, among all
+ * functions, using a single random number in constant time, rather
+ * than walking the tree from the root cell. The table must be rebuilt
+ * whenever the trees are changed.
+ */
+class ACDCGenCellTable {
+
+public:
+
+  /**
+   * The default constructor gives an invalid table.
+   */
+  ACDCGenCellTable() : isValid(false) {}
+
+  /**
+   * Build the table from the given \a roots of the trees with the
+   * corresponding dimensions, \a dims. Null root cells are
+   * ignored. Cells with a zero overestimated integral are not
+   * included.
+   */
+  inline void build(const vector<ACDCGenCell*> & roots,
+		    const vector<DimType> & dims);
+
+  /**
+   * Mark the table as invalid, to be rebuilt before it is used next.
+   */
+  inline void invalidate();
+
+  /**
+   * Return true if the table has been built since it was last
+   * invalidated.
+   */
+  inline bool valid() const;
+
+  /**
+   * Return true if the table has no cells, which is the case if the
+   * sum of the overestimated integrals was zero or not finite.
+   */
+  inline bool empty() const;
+
+  /**
+   * Choose a cell according to their overestimated integrals, given
+   * a flat random number \a r in ]0,1[, and return its index.
+   */
+  inline long select(double r) const;
+
+  /**
+   * Return the cell with the given index.
+   */
+  inline ACDCGenCell * cell(long i) const;
+
+  /**
+   * Return the index of the function of the cell with the given index.
+   */
+  inline vector<ACDCGenCell*>::size_type function(long i) const;
+
+  /**
+   * Set \a lo and \a up to the lower-left and upper-right corners of
+   * the cell with the given index.
+   */
+  inline void corners(long i, DVector & lo, DVector & up) const;
+
+private:
+
+  /**
+   * Add all cells which have not been split in the tree with the
+   * given \a root cell, with corners \a lo and \a up, for the
+   * function with index \a f, and append their overestimated
+   * integrals to \a w.
+   */
+  inline void collect(ACDCGenCell * root, DVector & lo, DVector & up,
+		      vector<ACDCGenCell*>::size_type f, DVector & w);
+
+  /**
+   * A cell which has not been split.
+   */
+  struct Leaf {
+    /** The cell. */
+    ACDCGenCell * cell;
+    /** The index of the function. */
+    vector<ACDCGenCell*>::size_type function;
+    /** The position of the lower-left corner in theCorners. */
+    DVector::size_type offset;
+    /** The dimension of the cell. */
+    DimType dim;
+  };
+
+  /**
+   * The cells which have not been split.
+   */
+  vector<Leaf> theLeaves;
+
+  /**
+   * The lower-left corners, followed by the upper-right corners, of
+   * all the cells in theLeaves.
+   */
+  DVector theCorners;
+
+  /**
+   * The probability of keeping a cell selected in the alias table
+   * rather than choosing its alias.
+   */
+  DVector theProbabilities;
+
+  /**
+   * The alias for each cell in the alias table.
+   */
+  vector<long> theAliases;
+
+  /**
+   * True if the table has been built since it was last invalidated.
+   */
+  bool isValid;
+
+};
+
 /**
  * This is a class describing cells to the outside world to be used
  * for debugging purposes. They only make sense if extracted with the
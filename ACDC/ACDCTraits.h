@@ -19,10 +19,11 @@ struct ACDCTraitsType {};
 
 /**
  * ACDCFncTraits defines the interface to functions to be sampled by
- * ACDCGen. It only defines one function which defines how the
- * functions are called. If the default implementation is not
- * suitable, ACDCFncTraits may be specialized for a function class
- * implementing a function with the same signature.
+ * ACDCGen. It defines how the functions are called, either for one
+ * point at the time or for a block of points. If the default
+ * implementation is not suitable, ACDCFncTraits may be specialized
+ * for a function class implementing functions with the same
+ * signatures.
  */
 template <typename FncPtr>
 struct ACDCFncTraits: public ACDCTraitsType {
@@ -35,6 +36,23 @@ struct ACDCFncTraits: public ACDCTraitsType {
     return (*f)(x);
   }
 
+  /**
+   * Call a function to be sampled by ACDCGen for a block of \a n
+   * points of dimension \a dim. The points are given in \a x with
+   * all the first coordinates first, followed by all the second
+   * coordinates etc., so that coordinate \a d of point \a i is
+   * <code>x[d*n + i]</code>. The function values are returned in \a
+   * res. This default version calls value() for each point.
+   */
+  static inline void values(const FncPtr & f, int n, DimType dim,
+			    const double * x, double * res) {
+    DVector xi(dim);
+    for ( int i = 0; i < n; ++i ) {
+      for ( DimType d = 0; d < dim; ++d ) xi[d] = x[d*n + i];
+      res[i] = value(f, xi);
+    }
+  }
+
 };
 
 /**
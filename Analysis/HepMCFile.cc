@@ -22,12 +22,62 @@
 #include "ThePEG/Vectors/HepMCConverter.h"
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * A stream buffer writing to a CFile.
+ */
+class CFileBuffer: public std::streambuf {
+
+public:
+
+  /** Create a buffer writing to the given file. */
+  CFileBuffer(CFile & f): file(f), buffer(1 << 16) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+  }
+
+  /** The destructor writes out the remaining buffer. */
+  ~CFileBuffer() { sync(); }
+
+protected:
+
+  /** Write out the full buffer and then the character \a c. */
+  virtual int_type overflow(int_type c) {
+    if ( sync() != 0 ) return traits_type::eof();
+    if ( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  /** Write out the buffer. */
+  virtual int sync() {
+    size_t n = pptr() - pbase();
+    if ( n > 0 && !file.write(pbase(), n) ) return -1;
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return 0;
+  }
+
+private:
+
+  /** The file written to. */
+  CFile & file;
+
+  /** The buffer. */
+  vector<char> buffer;
+
+};
+
+}
+
 HepMCFile::HepMCFile() 
   : _eventNumber(1), _format(1), _filename(),
 #ifdef HAVE_HEPMC_ROOTIO 
    _ttreename(),_tbranchname(),
 #endif
-    _unitchoice(), _geneventPrecision(16), _addHI(0) {}
+    _unitchoice(), _geneventPrecision(16), _addHI(0),
+    _queueDepth(0), _compression(0), _stopWriting(false) {}
 
 // Cannot copy streams. 
 // Let doinitrun() take care of their initialization.
@@ -39,7 +89,23 @@ HepMCFile::HepMCFile(const HepMCFile & x)
     _ttreename(x._ttreename),_tbranchname(x._tbranchname),
 #endif
     _hepmcio(), _hepmcdump(), _unitchoice(x._unitchoice), 
-    _geneventPrecision(x._geneventPrecision) {}
+    _geneventPrecision(x._geneventPrecision),
+    _queueDepth(x._queueDepth), _compression(x._compression),
+    _stopWriting(false) {}
+
+HepMCFile::~HepMCFile() {
+  // The writer thread is normally stopped in dofinish(), but must
+  // not be left running if the run was aborted.
+  if ( _writer.joinable() ) {
+    {
+      std::lock_guard<std::mutex> lock(_queueMutex);
+      _stopWriting = true;
+    }
+    _queueChanged.notify_all();
+    _writer.join();
+  }
+  for ( int i = 0, N = _queue.size(); i < N; ++i ) delete _queue[i].event;
+}
 
 IBPtr HepMCFile::clone() const {
   return new_ptr(*this);
@@ -55,12 +121,14 @@ void HepMCFile::doinitrun() {
    if ( _filename.empty() )
       _filename = generator()->filename() + ".hepmc";
 
+  std::ostream * os = compressedStream();
 
   switch ( _format ) {
 #ifdef HAVE_HEPMC3
   default: {
-    HepMC::WriterAsciiHepMC2 * tmpio 
-      = new HepMC::WriterAsciiHepMC2(_filename.c_str());
+    HepMC::WriterAsciiHepMC2 * tmpio = os?
+      new HepMC::WriterAsciiHepMC2(*os):
+      new HepMC::WriterAsciiHepMC2(_filename.c_str());
     tmpio->set_precision(_geneventPrecision);
     _hepmcio = tmpio;
   }
@@ -68,8 +136,9 @@ void HepMCFile::doinitrun() {
   case 6: {
     if ( _filename.empty() )
       _filename = generator()->filename() + ".hepmc";
-    HepMC::WriterAscii * tmpio 
-      = new HepMC::WriterAscii(_filename.c_str(),NULL);
+    HepMC::WriterAscii * tmpio = os?
+      new HepMC::WriterAscii(*os,NULL):
+      new HepMC::WriterAscii(_filename.c_str(),NULL);
     tmpio->set_precision(_geneventPrecision);
     _hepmcio = tmpio;
   }
@@ -77,8 +146,9 @@ void HepMCFile::doinitrun() {
   case 7: {
     if ( _filename.empty() )
       _filename = generator()->filename() + ".hepevt";
-    HepMC::WriterHEPEVT * tmpio 
-      = new  HepMC::WriterHEPEVT(_filename.c_str()); 
+    HepMC::WriterHEPEVT * tmpio = os?
+      new HepMC::WriterHEPEVT(*os):
+      new HepMC::WriterHEPEVT(_filename.c_str());
     _hepmcio = tmpio;
   }
     break;
@@ -102,8 +172,9 @@ void HepMCFile::doinitrun() {
 #endif
 #else
   default: {
-    HepMC::IO_GenEvent * tmpio 
-      = new HepMC::IO_GenEvent(_filename.c_str(), ios::out);
+    HepMC::IO_GenEvent * tmpio = os?
+      new HepMC::IO_GenEvent(*os):
+      new HepMC::IO_GenEvent(_filename.c_str(), ios::out);
     tmpio->precision(_geneventPrecision);
     _hepmcio = tmpio;
   }
@@ -113,12 +184,86 @@ void HepMCFile::doinitrun() {
     break;
   case 5: 
     _hepmcio = 0; 
-    _hepmcdump.open(_filename.c_str()); 
+    if ( !os ) _hepmcdump.open(_filename.c_str()); 
     break;
 #endif
   }
+
+  if ( _queueDepth > 0 ) {
+    _stopWriting = false;
+    _writerError = std::exception_ptr();
+    _writer = std::thread(&HepMCFile::writerLoop, this);
+  }
+}
+
+std::ostream * HepMCFile::compressedStream() {
+  if ( !_compression ) return 0;
+#ifdef HAVE_HEPMC3
+  bool text = _format != 8 && _format != 9;
+#else
+  bool text = _format != 2;
+#endif
+  if ( !text ) {
+    generator()->logWarning(
+      HepMCFileError() << "The output format chosen for " << name()
+      << " cannot be compressed. The output will not be compressed."
+      << Exception::warning);
+    return 0;
+  }
+  if ( _filename.size() < 3 || _filename.substr(_filename.size() - 3) != ".gz" )
+    _filename += ".gz";
+  _cfile.open(_filename, "w");
+  _cbuffer.reset(new CFileBuffer(_cfile));
+  _cstream.reset(new std::ostream(_cbuffer.get()));
+  return _cstream.get();
+}
+
+void HepMCFile::writerLoop() {
+  while ( true ) {
+    QueuedEvent qe;
+    {
+      std::unique_lock<std::mutex> lock(_queueMutex);
+      _queueChanged.wait(lock, [this]{ return _stopWriting || !_queue.empty(); });
+      if ( _queue.empty() ) return;
+      qe = _queue.front();
+    }
+    // Write the event while it is still in the queue, so that the
+    // number of converted events in memory is limited by the depth.
+    try {
+      if ( !_writerError ) write(qe);
+      else delete qe.event;
+    }
+    catch ( ... ) {
+      delete qe.event;
+      std::lock_guard<std::mutex> lock(_queueMutex);
+      _writerError = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_queueMutex);
+      _queue.pop_front();
+    }
+    _queueChanged.notify_all();
+  }
+}
+
+void HepMCFile::stopWriter() {
+  if ( !_writer.joinable() ) return;
+  {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _stopWriting = true;
+  }
+  _queueChanged.notify_all();
+  _writer.join();
+  if ( _writerError ) {
+    std::exception_ptr err = _writerError;
+    _writerError = std::exception_ptr();
+    std::rethrow_exception(err);
+  }
 }
 void HepMCFile::dofinish() {
+  // Make sure all converted events have been written before the
+  // file is closed.
+  stopWriter();
 #ifdef HAVE_HEPMC3
   _hepmcio->close();
   delete _hepmcio;
@@ -130,6 +275,12 @@ void HepMCFile::dofinish() {
   else
     _hepmcdump.close();
 #endif
+  if ( _cstream ) {
+    _cstream->flush();
+    _cstream.reset();
+    _cbuffer.reset();
+    _cfile.close();
+  }
   AnalysisHandler::dofinish();
   cout << "\nHepMCFile: generated HepMC output.\n";
 }
@@ -145,15 +296,13 @@ void HepMCFile::analyze(tEventPtr event, long, int, int) {
   case 2:  eUnit = GeV; lUnit = centimeter; break;
   case 3:  eUnit = MeV; lUnit = centimeter; break;
   }
+  QueuedEvent qe;
 #ifdef HAVE_HEPMC3
-    _hepmcio->set_run_info(std::make_shared<HepMC::GenRunInfo>());
-    std::vector<std::string>  w_names;
-    w_names.push_back("Default");
+    qe.weightNames.push_back("Default");
     for ( map<string,double>::const_iterator w = event->optionalWeights().begin();
      w != event->optionalWeights().end(); ++w ) {
-     w_names.push_back(w->first);
+     qe.weightNames.push_back(w->first);
     }
-    _hepmcio->run_info()->set_weight_names(w_names);  
 #endif
 
   HepMC::GenEvent * hepmc 
@@ -181,28 +330,56 @@ void HepMCFile::analyze(tEventPtr event, long, int, int) {
 
   }
 
+  qe.event = hepmc;
+  if ( !_writer.joinable() ) {
+    write(qe);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(_queueMutex);
+  _queueChanged.wait(lock, [this]{ return int(_queue.size()) < _queueDepth; });
+  if ( _writerError ) {
+    // Report the failure of the writer thread as soon as possible.
+    lock.unlock();
+    delete hepmc;
+    stopWriter();
+    return;
+  }
+  _queue.push_back(qe);
+  lock.unlock();
+  _queueChanged.notify_all();
+
+}
+
+void HepMCFile::write(const QueuedEvent & qe) {
+  HepMC::GenEvent * hepmc = qe.event;
 #ifdef HAVE_HEPMC3
+  _hepmcio->set_run_info(std::make_shared<HepMC::GenRunInfo>());
+  _hepmcio->run_info()->set_weight_names(qe.weightNames);
   hepmc->set_run_info( _hepmcio->run_info()); 
   _hepmcio->write_event(*hepmc);
 #else
   if (_hepmcio)
     _hepmcio->write_event(hepmc);
+  else if ( _cstream )
+    hepmc->print(*_cstream);
   else
     hepmc->print(_hepmcdump);
 #endif
 
   delete hepmc;
-
 }
 
 void HepMCFile::persistentOutput(PersistentOStream & os) const {
   os << _eventNumber << _format << _filename 
-     << _unitchoice << _geneventPrecision << _addHI;
+     << _unitchoice << _geneventPrecision << _addHI
+     << _queueDepth << _compression;
 }
 
 void HepMCFile::persistentInput(PersistentIStream & is, int) {
   is >> _eventNumber >> _format >> _filename 
-     >> _unitchoice >> _geneventPrecision >> _addHI;
+     >> _unitchoice >> _geneventPrecision >> _addHI
+     >> _queueDepth >> _compression;
 }
 
 
@@ -337,4 +514,34 @@ void HepMCFile::Init() {
      "Always add Heavy Ion info.",
      1);
 
+  static Parameter<HepMCFile,int> interfaceQueueDepth
+    ("QueueDepth",
+     "If larger than zero, the events are written out by a separate "
+     "thread, so that the generation of the following events is not "
+     "held up by the output. The events are converted when they are "
+     "analyzed and this gives the maximum number of converted events "
+     "waiting to be written out. If the queue is full, the generation "
+     "waits for the writer thread. All events are written before the "
+     "file is closed at the end of the run.",
+     &HepMCFile::_queueDepth, 0, 0, 0,
+     false, false, Interface::lowerlim);
+
+  static Switch<HepMCFile,int> interfaceCompression
+    ("Compression",
+     "Compression of the output file. Only the text formats can be "
+     "compressed.",
+     &HepMCFile::_compression, 0, false, false);
+  static SwitchOption interfaceCompressionNone
+    (interfaceCompression,
+     "None",
+     "The output is not compressed.",
+     0);
+  static SwitchOption interfaceCompressionGzip
+    (interfaceCompression,
+     "Gzip",
+     "The output is compressed with gzip, in-process if zlib was "
+     "found when ThePEG was configured, and \".gz\" is added to the "
+     "file name if not already present.",
+     1);
+
 }
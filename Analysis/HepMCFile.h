@@ -18,11 +18,27 @@
 #include "ThePEG/Repository/CurrentGenerator.h"
 #include "ThePEG/Repository/EventGenerator.h"
 #include "ThePEG/Config/HepMCHelper.h"
+#include "ThePEG/Utilities/CFile.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <exception>
 namespace ThePEG {
 
 /** \ingroup Analysis
  * The HepMCFile class outputs ThePEG events in HepMC format.
  *
+ * Optionally the converted events may be written out by a separate
+ * writer thread (see the QueueDepth interface), so that formatting
+ * and disk I/O overlap with the generation of the following
+ * events. The events are converted in analyze() and are put in a
+ * queue, and if the queue is full analyze() waits until the writer
+ * thread has caught up. All queued events are written before the
+ * file is closed in dofinish(). The text formats may also be
+ * compressed in-process with gzip (see the Compression interface).
+ *
  * @see \ref HepMCFileInterfaces "The interfaces"
  * defined for HepMCFile.
  */
@@ -41,6 +57,11 @@ public:
    * The copy constructor.
    */
   HepMCFile(const HepMCFile &);
+
+  /**
+   * The destructor.
+   */
+  virtual ~HepMCFile();
   //@}
 
 public:
@@ -127,6 +148,49 @@ protected:
   virtual void dofinish();
   //@}
 
+public:
+
+  /** @cond EXCEPTIONCLASSES */
+  /** Exception class used by HepMCFile if the output could not be
+      written as requested. */
+  class HepMCFileError: public Exception {};
+  /** @endcond */
+
+private:
+
+  /**
+   * A converted event waiting to be written out.
+   */
+  struct QueuedEvent {
+    /** The converted event. */
+    HepMC::GenEvent * event;
+    /** The names of the weights of the event. */
+    vector<string> weightNames;
+  };
+
+  /**
+   * Write out and delete a converted event. In asynchronous mode
+   * this is only called from the writer thread.
+   */
+  void write(const QueuedEvent & qe);
+
+  /**
+   * The function run by the writer thread.
+   */
+  void writerLoop();
+
+  /**
+   * Wait for the writer thread to write all queued events and stop
+   * it. If the writer thread failed, the exception is rethrown.
+   */
+  void stopWriter();
+
+  /**
+   * If the output should be compressed, open the compressed file and
+   * return a stream writing to it, otherwise return null.
+   */
+  std::ostream * compressedStream();
+
 private:
 
   /**
@@ -198,6 +262,63 @@ private:
    */
   int _addHI;
 
+  /**
+   * The maximum number of converted events waiting to be written by
+   * the writer thread. If zero, events are written synchronously in
+   * analyze().
+   */
+  int _queueDepth;
+
+  /**
+   * Choice of compression of the output file.
+   */
+  int _compression;
+
+  /**
+   * The writer thread.
+   */
+  std::thread _writer;
+
+  /**
+   * The converted events waiting to be written.
+   */
+  std::deque<QueuedEvent> _queue;
+
+  /**
+   * Mutex protecting _queue, _stopWriting and _writerError.
+   */
+  std::mutex _queueMutex;
+
+  /**
+   * Signals that an event has been put in or taken from the queue.
+   */
+  std::condition_variable _queueChanged;
+
+  /**
+   * Set when the writer thread should stop after the queue is empty.
+   */
+  bool _stopWriting;
+
+  /**
+   * Set if writing an event failed in the writer thread.
+   */
+  std::exception_ptr _writerError;
+
+  /**
+   * The compressed output file.
+   */
+  CFile _cfile;
+
+  /**
+   * The buffer used to write to the compressed output file.
+   */
+  std::unique_ptr<std::streambuf> _cbuffer;
+
+  /**
+   * The stream used to write to the compressed output file.
+   */
+  std::unique_ptr<std::ostream> _cstream;
+
 };
 
 }
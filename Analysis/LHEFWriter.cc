@@ -0,0 +1,481 @@
+// -*- C++ -*-
+//
+// LHEFWriter.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the LHEFWriter class.
+//
+
+#include "LHEFWriter.h"
+#include "ThePEG/Interface/ClassDocumentation.h"
+#include "ThePEG/Interface/Parameter.h"
+#include "ThePEG/Interface/Switch.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/EventRecord/SubProcess.h"
+#include "ThePEG/EventRecord/ColourLine.h"
+#include "ThePEG/Handlers/EventHandler.h"
+#include "ThePEG/Handlers/XComb.h"
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DescribeClass.h"
+#include "ThePEG/Utilities/CFile.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstdio>
+
+using namespace ThePEG;
+
+/**
+ * Writes buffers to the file given in the constructor, either
+ * directly or on a separate thread. In the latter case at most
+ * maxQueue buffers are kept waiting, after which write() blocks until
+ * the thread has caught up.
+ */
+class LHEFWriter::Output {
+
+public:
+
+  /**
+   * Open the file called \a filename, and start a thread writing to
+   * it if \a threaded is true.
+   */
+  Output(string filename, bool threaded)
+    : file(filename, "w"), done(false), error(false) {
+    if ( threaded ) thread = std::thread(&Output::run, this);
+  }
+
+  /**
+   * Write all remaining buffers and close the file.
+   */
+  ~Output() {
+    if ( thread.joinable() ) {
+      {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+      }
+      cond.notify_all();
+      thread.join();
+    }
+    file.close();
+  }
+
+  /**
+   * Write the contents of \a buffer to the file, leaving \a buffer
+   * empty.
+   */
+  void write(string & buffer) {
+    if ( !thread.joinable() ) {
+      put(buffer);
+      buffer.clear();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    while ( queue.size() >= maxQueue ) cond.wait(lock);
+    queue.push_back(string());
+    queue.back().swap(buffer);
+    lock.unlock();
+    cond.notify_all();
+  }
+
+  /**
+   * Return true if writing to the file has failed.
+   */
+  bool failed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+  }
+
+private:
+
+  /**
+   * Write \a buffer to the file.
+   */
+  void put(const string & buffer) {
+    if ( !buffer.empty() && !file.write(buffer.data(), buffer.size()) ) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = true;
+    }
+  }
+
+  /**
+   * The function run by the writing thread.
+   */
+  void run() {
+    string buffer;
+    while ( true ) {
+      std::unique_lock<std::mutex> lock(mutex);
+      while ( queue.empty() && !done ) cond.wait(lock);
+      if ( queue.empty() ) return;
+      buffer.swap(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      cond.notify_all();
+      put(buffer);
+      buffer.clear();
+    }
+  }
+
+  /**
+   * The maximum number of buffers waiting to be written.
+   */
+  static const size_t maxQueue = 4;
+
+  /**
+   * The file written to.
+   */
+  CFile file;
+
+  /**
+   * The thread writing to the file, if any.
+   */
+  std::thread thread;
+
+  /**
+   * Protects the queue and the flags.
+   */
+  std::mutex mutex;
+
+  /**
+   * Signals changes of the queue.
+   */
+  std::condition_variable cond;
+
+  /**
+   * The buffers waiting to be written.
+   */
+  std::deque<string> queue;
+
+  /**
+   * Set when no more buffers will be written.
+   */
+  bool done;
+
+  /**
+   * Set if writing to the file failed.
+   */
+  bool error;
+
+};
+
+LHEFWriter::LHEFWriter()
+  : theBufferSize(1024), theBackgroundWriting(true), theOutput(0),
+    theBeams(0, 0), theBeamEnergies(0.0, 0.0), theInitPosition(-1),
+    theNEvents(0), theMaxWeight(0.0), theMinWeight(0.0),
+    theSumWeights(0.0), theMaxXWGTUP(0.0), theIDWTUP(3),
+    theNegativeWeights(false) {}
+
+// Cannot copy the output.
+// Let doinitrun() take care of its initialization.
+LHEFWriter::LHEFWriter(const LHEFWriter & x)
+  : AnalysisHandler(x), theFilename(x.theFilename),
+    theBufferSize(x.theBufferSize),
+    theBackgroundWriting(x.theBackgroundWriting), theOutput(0),
+    theBeams(0, 0), theBeamEnergies(0.0, 0.0), theInitPosition(-1),
+    theNEvents(0), theMaxWeight(0.0), theMinWeight(0.0),
+    theSumWeights(0.0), theMaxXWGTUP(0.0), theIDWTUP(3),
+    theNegativeWeights(false) {}
+
+LHEFWriter::~LHEFWriter() {
+  delete theOutput;
+}
+
+IBPtr LHEFWriter::clone() const {
+  return new_ptr(*this);
+}
+
+IBPtr LHEFWriter::fullclone() const {
+  return new_ptr(*this);
+}
+
+void LHEFWriter::doinitrun() {
+  AnalysisHandler::doinitrun();
+  if ( theFilename.empty() )
+    theFilename = generator()->filename() + ".lhe";
+  delete theOutput;
+  theOutput = 0;
+  theBuffer.clear();
+  theBuffer.reserve(theBufferSize*1024 + 4096);
+  theInitPosition = -1;
+  theNEvents = 0;
+  theMaxWeight = 0.0;
+  theMinWeight = 0.0;
+  theSumWeights = 0.0;
+  theMaxXWGTUP = 0.0;
+  // Weighted events must be written with IDWTUP=4 from the start,
+  // as the HEPRUP block cannot be rewritten in compressed files.
+  theIDWTUP = generator()->eventHandler()->weighted()? 4: 3;
+  theNegativeWeights = false;
+  theOutput = new Output(theFilename, theBackgroundWriting);
+}
+
+void LHEFWriter::dofinish() {
+  if ( theOutput ) {
+    if ( theInitPosition < 0 ) writeInit(tcEventPtr());
+    theBuffer += "</LesHouchesEvents>\n";
+    flush();
+    delete theOutput;
+    theOutput = 0;
+    // Now that the final cross section is known, rewrite the HEPRUP
+    // block if possible. Unless all events had the same absolute
+    // weight, they should be used with their weights (IDWTUP=4).
+    int idwtup = theMinWeight == theMaxWeight? theIDWTUP: 4;
+    string init = initBlock(generator()->integratedXSec()/picobarn,
+			    generator()->integratedXSecErr()/picobarn,
+			    theMaxXWGTUP, theNegativeWeights? -idwtup: idwtup);
+    if ( !plainFile() && idwtup != theIDWTUP )
+      Throw<Exception>()
+	<< "LHEFWriter '" << name() << "' wrote events with varying "
+	<< "weights to '" << theFilename << "' which could not be updated "
+	<< "to say so. Switch on weighted events in the event handler to "
+	<< "write IDWTUP=4 from the start." << Exception::warning;
+    if ( plainFile() ) {
+      std::FILE * f = std::fopen(theFilename.c_str(), "r+");
+      string old(init.size(), ' ');
+      if ( f && std::fseek(f, theInitPosition, SEEK_SET) == 0 &&
+	   std::fread(&old[0], 1, old.size(), f) == old.size() &&
+	   old.compare(0, 7, "<init>\n") == 0 &&
+	   old.compare(old.size() - 8, 8, "</init>\n") == 0 &&
+	   std::fseek(f, theInitPosition, SEEK_SET) == 0 )
+	std::fwrite(init.data(), 1, init.size(), f);
+      else
+	Throw<Exception>()
+	  << "LHEFWriter '" << name() << "' could not update the cross "
+	  << "section in '" << theFilename << "'." << Exception::warning;
+      if ( f ) std::fclose(f);
+    }
+    generator()->log() << "LHEFWriter '" << name() << "' wrote "
+		       << theNEvents << " events to '" << theFilename
+		       << "'." << endl;
+  }
+  AnalysisHandler::dofinish();
+}
+
+bool LHEFWriter::plainFile() const {
+  const char * suffix[] = { ".gz", ".bz2", ".xz", ".zst" };
+  if ( theFilename.empty() || theFilename[0] == '|' ) return false;
+  for ( int i = 0; i < 4; ++i ) {
+    string s = suffix[i];
+    if ( theFilename.size() > s.size() &&
+	 theFilename.compare(theFilename.size() - s.size(), s.size(), s) == 0 )
+      return false;
+  }
+  return true;
+}
+
+string LHEFWriter::
+initBlock(double xsec, double xerr, double xmax, int idwtup) const {
+  char line[256];
+  string init = "<init>\n";
+  std::snprintf(line, sizeof(line),
+		" %8ld %8ld %18.10e %18.10e 0 0 0 0 %2d 1\n",
+		theBeams.first, theBeams.second,
+		theBeamEnergies.first, theBeamEnergies.second, idwtup);
+  init += line;
+  std::snprintf(line, sizeof(line), " %18.10e %18.10e %18.10e 1\n",
+		xsec, xerr, xmax);
+  init += line;
+  init += "</init>\n";
+  return init;
+}
+
+void LHEFWriter::writeInit(tcEventPtr event) {
+  if ( event ) {
+    theBeams = make_pair(event->incoming().first->id(),
+			 event->incoming().second->id());
+    theBeamEnergies = make_pair(event->incoming().first->momentum().e()/GeV,
+				event->incoming().second->momentum().e()/GeV);
+  } else {
+    const cPDPair & inc = generator()->eventHandler()->incoming();
+    if ( inc.first && inc.second )
+      theBeams = make_pair(inc.first->id(), inc.second->id());
+  }
+  theBuffer += "<LesHouchesEvents version=\"3.0\">\n<header>\n<!-- Written by "
+    "ThePEG::LHEFWriter '" + name() + "' in run '" + generator()->runName() +
+    "' -->\n</header>\n";
+  theInitPosition = theBuffer.size();
+  // The cross section is not known until the end of the run, for now
+  // use the current estimate.
+  theBuffer += initBlock(generator()->integratedXSec()/picobarn,
+			 generator()->integratedXSecErr()/picobarn,
+			 generator()->integratedXSec()/picobarn, theIDWTUP);
+}
+
+void LHEFWriter::flush() {
+  if ( theBuffer.empty() ) return;
+  theOutput->write(theBuffer);
+  if ( theOutput->failed() )
+    throw Exception() << "LHEFWriter '" << name() << "' could not write to '"
+		      << theFilename << "'." << Exception::runerror;
+}
+
+void LHEFWriter::analyze(tEventPtr event, long, int loop, int state) {
+  if ( loop > 0 || state != 0 || !event || !theOutput ) return;
+  tSubProPtr sub = event->primarySubProcess();
+  if ( !sub ) return;
+  if ( theInitPosition < 0 ) writeInit(event);
+
+  tPVector particles;
+  particles.push_back(sub->incoming().first);
+  particles.push_back(sub->incoming().second);
+  particles.insert(particles.end(),
+		   sub->intermediates().begin(), sub->intermediates().end());
+  particles.insert(particles.end(),
+		   sub->outgoing().begin(), sub->outgoing().end());
+  const int nin = 2;
+  const int nint = sub->intermediates().size();
+
+  double weight = event->weight();
+  theMinWeight = theNEvents? min(theMinWeight, abs(weight)): abs(weight);
+  theMaxWeight = max(theMaxWeight, abs(weight));
+  if ( weight < 0.0 ) theNegativeWeights = true;
+
+  // The weights are written in pb, normalized so that their average
+  // is the cross section, as required for IDWTUP=4. The current
+  // estimate of the cross section is used.
+  theSumWeights += weight;
+  double xwgtup = generator()->integratedXSec()/picobarn;
+  if ( theSumWeights != 0.0 ) xwgtup *= weight*(theNEvents + 1)/theSumWeights;
+  theMaxXWGTUP = max(theMaxXWGTUP, abs(xwgtup));
+
+  // Take the scale and couplings from the XComb of the event handler
+  // which generated this event. In a multi-threaded run this is the
+  // handler of one of the worker generators, rather than the one of
+  // this generator.
+  double scale = -1.0;
+  double aEM = -1.0;
+  double aS = -1.0;
+  tcEHPtr eh = event->primaryCollision()?
+    dynamic_ptr_cast<tcEHPtr>(event->primaryCollision()->handler()): tcEHPtr();
+  if ( eh && eh->lastXCombPtr() ) {
+    scale = sqrt(eh->lastScale())/GeV;
+    aEM = eh->lastAlphaEM();
+    aS = eh->lastAlphaS();
+  }
+
+  char line[512];
+  std::snprintf(line, sizeof(line),
+		"<event>\n %d %d %+.10e %.10e %.10e %.10e\n",
+		int(particles.size()), 1, xwgtup, scale, aEM, aS);
+  theBuffer += line;
+
+  map<tcColinePtr,int> colourIndex;
+  for ( int i = 0, N = particles.size(); i < N; ++i ) {
+    tcPPtr p = particles[i];
+    int status = i < nin? -1: ( i < nin + nint? 2: 1 );
+    int m1 = 0;
+    int m2 = 0;
+    if ( i >= nin ) {
+      for ( int ip = 0, Np = p->parents().size(); ip < Np; ++ip )
+	for ( int j = 0; j < N; ++j ) {
+	  if ( particles[j] != p->parents()[ip] ) continue;
+	  m1 = m1? min(m1, j + 1): j + 1;
+	  m2 = max(m2, j + 1);
+	}
+      if ( !m1 ) {
+	m1 = 1;
+	m2 = 2;
+      }
+      else if ( m1 == m2 ) m2 = 0;
+    }
+    int col[2] = { 0, 0 };
+    tcColinePtr lines[2] = { p->colourLine(), p->antiColourLine() };
+    for ( int ic = 0; ic < 2; ++ic ) {
+      if ( !lines[ic] ) continue;
+      map<tcColinePtr,int>::iterator it = colourIndex.find(lines[ic]);
+      if ( it == colourIndex.end() )
+	it = colourIndex.insert(make_pair(lines[ic],
+					  int(501 + colourIndex.size()))).first;
+      col[ic] = it->second;
+    }
+    const Lorentz5Momentum & mom = p->momentum();
+    std::snprintf(line, sizeof(line),
+		  " %8ld %2d %4d %4d %4d %4d %+.10e %+.10e %+.10e %.10e "
+		  "%.10e %.4e %.4e\n",
+		  p->id(), status, m1, m2, col[0], col[1],
+		  double(mom.x()/GeV), double(mom.y()/GeV),
+		  double(mom.z()/GeV), double(mom.e()/GeV),
+		  double(mom.mass()/GeV), 0.0, 9.0);
+    theBuffer += line;
+  }
+
+  const map<string,double> & weights = event->optionalWeights();
+  if ( !weights.empty() ) {
+    theBuffer += "<rwgt>\n";
+    for ( map<string,double>::const_iterator w = weights.begin();
+	  w != weights.end(); ++w ) {
+      std::snprintf(line, sizeof(line), "'> %+.10e </wgt>\n", w->second);
+      theBuffer += "<wgt id='" + w->first + line;
+    }
+    theBuffer += "</rwgt>\n";
+  }
+  theBuffer += "</event>\n";
+  ++theNEvents;
+
+  if ( theBuffer.size() >= size_t(theBufferSize)*1024 ) flush();
+}
+
+void LHEFWriter::persistentOutput(PersistentOStream & os) const {
+  os << theFilename << theBufferSize << theBackgroundWriting;
+}
+
+void LHEFWriter::persistentInput(PersistentIStream & is, int) {
+  is >> theFilename >> theBufferSize >> theBackgroundWriting;
+}
+
+// *** Attention *** The following static variable is needed for the type
+// description system in ThePEG. Please check that the template arguments
+// are correct (the class and its base class), and that the constructor
+// arguments are correct (the class name and the name of the dynamically
+// loadable library where the class implementation can be found).
+DescribeClass<LHEFWriter,AnalysisHandler>
+  describeThePEGLHEFWriter("ThePEG::LHEFWriter", "LHEFWriter.so");
+
+void LHEFWriter::Init() {
+
+  static ClassDocumentation<LHEFWriter> documentation
+    ("This analysis handler writes the primary sub-process of each event "
+     "to a file in the Les Houches Event File format.");
+
+  static Parameter<LHEFWriter,string> interfaceFilename
+    ("Filename",
+     "Name of the output file. If empty, the name of the run followed by "
+     "<code>.lhe</code> is used. If the name ends in <code>.gz</code>, "
+     "<code>.bz2</code>, <code>.xz</code> or <code>.zst</code> the file "
+     "is compressed, but the cross section given in the file will then "
+     "only be the estimate when the first event was written. The event "
+     "weights are given in pb, and for weighted events the weight "
+     "option is set to IDWTUP=4, so that the cross section is given by "
+     "the average weight also in compressed files.",
+     &LHEFWriter::theFilename, "");
+
+  static Parameter<LHEFWriter,int> interfaceBufferSize
+    ("BufferSize",
+     "The size (in kB) of the buffer collecting events before they are "
+     "written to the file.",
+     &LHEFWriter::theBufferSize, 1024, 1, 0,
+     true, false, Interface::lowerlim);
+
+  static Switch<LHEFWriter,bool> interfaceBackgroundWriting
+    ("BackgroundWriting",
+     "Write (and compress) the buffered events on a separate thread.",
+     &LHEFWriter::theBackgroundWriting, true, true, false);
+  static SwitchOption interfaceBackgroundWritingYes
+    (interfaceBackgroundWriting,
+     "Yes",
+     "Write the events on a separate thread.",
+     true);
+  static SwitchOption interfaceBackgroundWritingNo
+    (interfaceBackgroundWriting,
+     "No",
+     "Write the events on the main thread.",
+     false);
+
+}
@@ -0,0 +1,273 @@
+// -*- C++ -*-
+//
+// LHEFWriter.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef THEPEG_LHEFWriter_H
+#define THEPEG_LHEFWriter_H
+//
+// This is the declaration of the LHEFWriter class.
+//
+
+#include "ThePEG/Handlers/AnalysisHandler.h"
+
+namespace ThePEG {
+
+/** \ingroup Analysis
+ * The LHEFWriter class writes the primary sub-process of each event
+ * to a file in the Les Houches Event File format, so that the
+ * generated hard events can be read back in with a
+ * LesHouchesFileReader, e.g. to be showered in many independent
+ * jobs.
+ *
+ * Each event is written as a HEPEUP block with the incoming,
+ * intermediate and outgoing particles of the sub-process, their
+ * colour connections and the weight of the event, followed by any
+ * optional weights in an <code>rwgt</code> block. The HEPRUP block
+ * is written with a single process before the first event, with the
+ * beams taken from the first event and the cross section estimated
+ * so far. When the run is finished and the file is not compressed,
+ * the HEPRUP block is rewritten in place with the final cross
+ * section. The weights are always written with IDWTUP set to (minus)
+ * three, so that the cross section is taken from the HEPRUP block
+ * when the file is read.
+ *
+ * The events are formatted into a buffer which, when full, is
+ * written to the file, optionally on a separate thread to let the
+ * writing and compression run in parallel with the generation. Files
+ * with names ending in ".gz", ".bz2", ".xz" or ".zst" are compressed
+ * as described for the CFile class.
+ *
+ * @see \ref LHEFWriterInterfaces "The interfaces"
+ * defined for LHEFWriter.
+ * @see LesHouchesFileReader
+ */
+class LHEFWriter: public AnalysisHandler {
+
+public:
+
+  /** @name Standard constructors and destructors. */
+  //@{
+  /**
+   * The default constructor.
+   */
+  LHEFWriter();
+
+  /**
+   * The copy constructor.
+   */
+  LHEFWriter(const LHEFWriter &);
+
+  /**
+   * The destructor.
+   */
+  virtual ~LHEFWriter();
+  //@}
+
+public:
+
+  /** @name Virtual functions required by the AnalysisHandler class. */
+  //@{
+  /**
+   * Write the primary sub-process of the given Event to the
+   * file. Nothing is done unless the event is fully generated and has
+   * not been manipulated.
+   * @param event pointer to the Event to be analyzed.
+   * @param ieve the event number.
+   * @param loop the number of times this event has been presented.
+   * If negative the event is now fully generated.
+   * @param state a number different from zero if the event has been
+   * manipulated in some way since it was last presented.
+   */
+  virtual void analyze(tEventPtr event, long ieve, int loop, int state);
+  //@}
+
+public:
+
+  /** @name Functions used by the persistent I/O system. */
+  //@{
+  /**
+   * Function used to write out object persistently.
+   * @param os the persistent output stream written to.
+   */
+  void persistentOutput(PersistentOStream & os) const;
+
+  /**
+   * Function used to read in object persistently.
+   * @param is the persistent input stream read from.
+   * @param version the version number of the object when written.
+   */
+  void persistentInput(PersistentIStream & is, int version);
+  //@}
+
+  /**
+   * The standard Init function used to initialize the interfaces.
+   * Called exactly once for each class by the class description system
+   * before the main function starts or
+   * when this class is dynamically loaded.
+   */
+  static void Init();
+
+protected:
+
+  /** @name Clone Methods. */
+  //@{
+  /**
+   * Make a simple clone of this object.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr clone() const;
+
+  /** Make a clone of this object, possibly modifying the cloned object
+   * to make it sane.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr fullclone() const;
+  //@}
+
+protected:
+
+  /** @name Standard Interfaced functions. */
+  //@{
+  /**
+   * Initialize this object. Called in the run phase just before
+   * a run begins.
+   */
+  virtual void doinitrun();
+
+  /**
+   * Finalize this object. Called in the run phase just after a
+   * run has ended. Used eg. to write out statistics.
+   */
+  virtual void dofinish();
+  //@}
+
+private:
+
+  /**
+   * Helper class writing buffers to the file, possibly on a separate
+   * thread.
+   */
+  class Output;
+
+  /**
+   * Return the HEPRUP block with the given cross section, error,
+   * maximum weight and weight option. All fields which may change
+   * during the run have a fixed width, so that the block can be
+   * rewritten in place.
+   */
+  string initBlock(double xsec, double xerr, double xmax, int idwtup) const;
+
+  /**
+   * Write the header and the HEPRUP block, taking the beams from the
+   * given event.
+   */
+  void writeInit(tcEventPtr event);
+
+  /**
+   * Hand the current buffer over to be written to the file.
+   */
+  void flush();
+
+  /**
+   * Return true if the file is written without compression, so that
+   * it can be modified in place.
+   */
+  bool plainFile() const;
+
+private:
+
+  /**
+   * The name of the file to be written.
+   */
+  string theFilename;
+
+  /**
+   * The size (in kB) of the buffer collecting events before they are
+   * written to the file.
+   */
+  int theBufferSize;
+
+  /**
+   * If true, the buffers are written to the file on a separate
+   * thread.
+   */
+  bool theBackgroundWriting;
+
+  /**
+   * The object writing to the file.
+   */
+  Output * theOutput;
+
+  /**
+   * The buffer of formatted events.
+   */
+  string theBuffer;
+
+  /**
+   * The identities of the beam particles.
+   */
+  pair<long,long> theBeams;
+
+  /**
+   * The energies (in GeV) of the beam particles.
+   */
+  pair<double,double> theBeamEnergies;
+
+  /**
+   * The position of the HEPRUP block in the file, or -1 if it has not
+   * been written.
+   */
+  long theInitPosition;
+
+  /**
+   * The number of events written.
+   */
+  long theNEvents;
+
+  /**
+   * The largest absolute value of the event weights.
+   */
+  double theMaxWeight;
+
+  /**
+   * The smallest absolute value of the event weights.
+   */
+  double theMinWeight;
+
+  /**
+   * The sum of the event weights.
+   */
+  double theSumWeights;
+
+  /**
+   * The largest absolute value of the weights (in pb) written.
+   */
+  double theMaxXWGTUP;
+
+  /**
+   * The weight option (IDWTUP) written in the HEPRUP block.
+   */
+  int theIDWTUP;
+
+  /**
+   * True if negative weights have been written.
+   */
+  bool theNegativeWeights;
+
+private:
+
+  /**
+   * The assignment operator is private and must never be called.
+   * In fact, it should not even be implemented.
+   */
+  LHEFWriter & operator=(const LHEFWriter &) = delete;
+
+};
+
+}
+
+#endif /* THEPEG_LHEFWriter_H */
@@ -141,12 +141,13 @@ struct HepMCTraits<HepMC::GenEvent>
     e.add_vertex(v);
   }
 
-  /** Set the beam particles for the event.*/
+  /** Set the beam particles for the event. Either particle may be
+      null if it was not found, in which case no beams are set. */
   static void setBeamParticles(EventT & e, ParticlePtrT p1, ParticlePtrT p2) {
     //    e.set_beam_particles(p1,p2);
-    p1->set_status(4);
-    p2->set_status(4);
-    e.set_beam_particles(p1, p2);
+    if ( p1 ) p1->set_status(4);
+    if ( p2 ) p2->set_status(4);
+    if ( p1 && p2 ) e.set_beam_particles(p1, p2);
   }
 
   /** Create a new particle object with momentum \a p, PDG number \a
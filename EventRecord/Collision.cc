@@ -99,8 +99,8 @@ void Collision::removeSubProcess(tSubProPtr p) {
 }
 
 void Collision::addParticle(tPPtr p) {
-  allParticles.insert(p);
   if ( event() ) event()->addParticle(p);
+  allParticles.insert(p);
 }
 
 void Collision::removeEntry(tPPtr p) {
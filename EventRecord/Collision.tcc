@@ -38,8 +38,8 @@ void Collision::select(OutputIterator r, const SelectorBase & s) const {
 
 template <class Iterator>
 void Collision::addParticles(Iterator first, Iterator last) {
-  allParticles.insert(first, last);
   if ( event() ) event()->addParticles(first, last);
+  allParticles.insert(first, last);
 }
 
 }
@@ -13,6 +13,7 @@
 #include "EventConfig.h"
 #include "ThePEG/Utilities/ClassDescription.h"
 #include "ThePEG/EventRecord/ColourSinglet.h"
+#include "ThePEG/EventRecord/EventPool.h"
 
 namespace ThePEG {
 
@@ -76,6 +77,20 @@ public:
    */
   virtual ~ColourLine();
 
+  /**
+   * Allocate the memory for a new ColourLine from the EventPool.
+   */
+  static void * operator new(size_t size) {
+    return EventPool<ColourLine>::allocate(size);
+  }
+
+  /**
+   * Release the memory of a deleted ColourLine to the EventPool.
+   */
+  static void operator delete(void * p, size_t size) {
+    EventPool<ColourLine>::release(p, size);
+  }
+
 public:
 
   /** @name Access particles connected to the colour line. */
@@ -24,7 +24,8 @@ using namespace ThePEG;
 Event::Event(const PPair & newIncoming, tcEventBasePtr newHandler,
 	     string newName, long newNumber, double newWeight)
   : Named(newName), theIncoming(newIncoming), theHandler(newHandler),
-    theNumber(newNumber), theWeight(newWeight), theParticleNumber(0) {
+    theNumber(newNumber), theWeight(newWeight), theParticleNumber(0),
+    theColumnsNumber(-1), theColumnsParticles(0), theColumnsSteps(0) {
   addParticle(incoming().first);
   addParticle(incoming().second);
 }
@@ -35,7 +36,8 @@ Event::Event(const Event & e)
     allSteps(e.allSteps), allSubProcesses(e.allSubProcesses),
     allParticles(e.allParticles), theHandler(e.theHandler),
     theNumber(e.theNumber), theWeight(e.theWeight),
-    theParticleNumber(e.theParticleNumber) {}
+    theParticleNumber(e.theParticleNumber),
+    theColumnsNumber(-1), theColumnsParticles(0), theColumnsSteps(0) {}
 
 Event::~Event() {
   for ( int i = 0, N = theCollisions.size(); i < N; ++i )
@@ -48,6 +50,7 @@ Event::~Event() {
   allParticles.clear();
   theHandler = tcEventBasePtr();
   theColourLines.clear();
+  theFinalStateColumns.clear();
   theNumber = -1;
   theWeight = 0.0;
 }
@@ -93,12 +96,29 @@ void Event::addCollision(tCollPtr c) {
 void Event::addParticle(tPPtr p) {
   if ( !p ) return;
   if ( member(allParticles, p) ) return;
-  allParticles.insert(p);
   p->number(++theParticleNumber);
+  if ( !p->index() ) p->index(theParticleNumber);
+  allParticles.insert(p);
 }
 
 void Event::transform(const LorentzRotation & r) {
   for_each(allParticles, Transformer(r));
+  invalidateColumns();
+}
+
+const ParticleColumns & Event::finalStateColumns() const {
+  if ( theColumnsNumber != theParticleNumber ||
+       theColumnsParticles != long(allParticles.size()) ||
+       theColumnsSteps != long(allSteps.size()) ) {
+    tPVector final;
+    final.reserve(theFinalStateColumns.size());
+    selectFinalState(back_inserter(final));
+    theFinalStateColumns.fill(final);
+    theColumnsNumber = theParticleNumber;
+    theColumnsParticles = allParticles.size();
+    theColumnsSteps = allSteps.size();
+  }
+  return theFinalStateColumns;
 }
 
 int Event::colourLineIndex(tcColinePtr line) const {
@@ -154,8 +174,13 @@ EventPtr Event::clone() const {
   for ( StepSet::const_iterator sit = allSteps.begin();
         sit != allSteps.end(); ++sit ) trans[*sit] = (**sit).clone();
   for ( ParticleSet::const_iterator pit = allParticles.begin();
-	pit != allParticles.end(); ++pit )
-    trans[*pit] = (**pit).clone();
+	pit != allParticles.end(); ++pit ) {
+    PPtr p = (**pit).clone();
+    // Copies get a new index when added to an event, but here the
+    // clone takes the place of the original.
+    p->index((**pit).index());
+    trans[*pit] = p;
+  }
   newEvent->rebind(trans);
   return newEvent;
 }
@@ -13,6 +13,7 @@
 #include "Particle.h"
 #include "StandardSelectors.h"
 #include "SubProcess.h"
+#include "ParticleColumns.h"
 #include "ThePEG/Utilities/Named.h"
 #include "ThePEG/Utilities/AnyReference.h"
 
@@ -133,6 +134,22 @@ public:
     return ret;
   }
 
+  /**
+   * Return a columnar snapshot of the final state particles in this
+   * Event, in the same order as given by getFinalState(). The
+   * snapshot is cached and only rebuilt if particles or steps have
+   * been added or removed, or if transform() has been called, since
+   * the last call. If the momenta of the particles are changed in
+   * any other way, invalidateColumns() must be called.
+   */
+  const ParticleColumns & finalStateColumns() const;
+
+  /**
+   * Make sure that the next call to finalStateColumns() rebuilds the
+   * snapshot.
+   */
+  void invalidateColumns() const { theColumnsNumber = -1; }
+
   /**
    * Return a pointer to the primary Collision in this Event. May
    * be the null pointer.
@@ -421,6 +438,27 @@ private:
    */
   long theParticleNumber;
 
+  /**
+   * The cached snapshot of the final state.
+   */
+  mutable ParticleColumns theFinalStateColumns;
+
+  /**
+   * The value of theParticleNumber when theFinalStateColumns was
+   * filled, or -1 if it needs to be filled.
+   */
+  mutable long theColumnsNumber;
+
+  /**
+   * The number of particles when theFinalStateColumns was filled.
+   */
+  mutable long theColumnsParticles;
+
+  /**
+   * The number of steps when theFinalStateColumns was filled.
+   */
+  mutable long theColumnsSteps;
+
   /**
    * The meta information
    */
@@ -72,8 +72,10 @@ typedef Ptr<ParticleDataClass>::transient_const_pointer tcEventPDPtr;
 typedef vector<tPPtr> tParticleVector;
 /** A vector of pointers to Particle. */
 typedef vector<PPtr> ParticleVector;
-/** A set of pointers to Particle. */
-typedef set<PPtr, less<PPtr> > ParticleSet;
+class ParticleStore;
+/** The container used for the particles in Step, Collision and
+    Event, with the interface of a set of pointers to Particle. */
+typedef ParticleStore ParticleSet;
 /** A set of transient pointers to Particle. */
 typedef set<tPPtr, less<tPPtr> > tParticleSet;
 /** A set of transient pointers to const Particle. */
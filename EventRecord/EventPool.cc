@@ -0,0 +1,25 @@
+// -*- C++ -*-
+//
+// EventPool.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the EventPoolBase class.
+//
+
+#include "EventPool.h"
+
+using namespace ThePEG;
+
+bool EventPoolBase::isEnabled = true;
+
+const size_t EventPoolBase::maxCached;
+
+EventPoolCounters & EventPoolBase::counters() {
+  static thread_local EventPoolCounters c;
+  return c;
+}
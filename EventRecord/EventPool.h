@@ -0,0 +1,180 @@
+// -*- C++ -*-
+//
+// EventPool.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_EventPool_H
+#define ThePEG_EventPool_H
+// This is the declaration of the EventPool class.
+
+#include "ThePEG/Config/ThePEG.h"
+#include <new>
+
+namespace ThePEG {
+
+/**
+ * Counters of the allocations made through EventPool objects in the
+ * current thread.
+ */
+struct EventPoolCounters {
+
+  /** The default constructor sets all counters to zero. */
+  EventPoolCounters(): allocated(0), reused(0), released(0), freed(0) {}
+
+  /** The number of blocks allocated from the system. */
+  long allocated;
+
+  /** The number of allocations served by a released block. */
+  long reused;
+
+  /** The number of blocks released to be reused. */
+  long released;
+
+  /** The number of released blocks returned to the system. */
+  long freed;
+
+};
+
+/**
+ * EventPoolBase holds the counters and settings common to all
+ * EventPool classes.
+ */
+class EventPoolBase {
+
+public:
+
+  /**
+   * The counters of the allocations made through any EventPool in the
+   * current thread.
+   */
+  static EventPoolCounters & counters();
+
+  /**
+   * Return true if released blocks are kept to be reused.
+   */
+  static bool enabled() { return isEnabled; }
+
+  /**
+   * Switch on or off the reuse of released blocks. This should only
+   * be done when no events are being generated in other threads.
+   */
+  static void enabled(bool on) { isEnabled = on; }
+
+  /**
+   * The maximum number of released blocks kept for each class in each
+   * thread. Blocks released beyond this are returned to the system.
+   */
+  static const size_t maxCached = 65536;
+
+private:
+
+  /**
+   * True if released blocks are kept to be reused.
+   */
+  static bool isEnabled;
+
+};
+
+/**
+ * EventPool is used by the classes of the event record, such as
+ * Particle and Step, to allocate their objects. Released objects of
+ * class <code>T</code> are kept in a list per thread, and are reused
+ * for new objects of the same class instead of being returned to the
+ * system. Since the objects of an event are released together when
+ * the Event is deleted, the next event of the same size is built
+ * without calling the system allocator at all.
+ *
+ * Objects of classes derived from <code>T</code> with a different
+ * size, are allocated directly from the system. All blocks are
+ * allocated individually, so a block may be released in another
+ * thread than the one it was allocated in.
+ *
+ * A class uses the pool by defining
+ * <code>operator new(size_t)</code> to call allocate() and
+ * <code>operator delete(void *, size_t)</code> to call release().
+ */
+template <typename T>
+class EventPool: public EventPoolBase {
+
+public:
+
+  /**
+   * Allocate a block of the given \a size.
+   */
+  static void * allocate(size_t size) {
+    if ( size == sizeof(T) && !finished() ) {
+      Cache & c = cache();
+      if ( !c.blocks.empty() ) {
+	void * p = c.blocks.back();
+	c.blocks.pop_back();
+	++counters().reused;
+	return p;
+      }
+    }
+    ++counters().allocated;
+    return ::operator new(size);
+  }
+
+  /**
+   * Release a block \a p of the given \a size.
+   */
+  static void release(void * p, size_t size) {
+    if ( !p ) return;
+    if ( size == sizeof(T) && enabled() && !finished() ) {
+      Cache & c = cache();
+      if ( c.blocks.size() < maxCached ) {
+	c.blocks.push_back(p);
+	++counters().released;
+	return;
+      }
+    }
+    ++counters().freed;
+    ::operator delete(p);
+  }
+
+  /**
+   * Return the number of released blocks kept in the current thread.
+   */
+  static size_t cached() { return finished()? 0: cache().blocks.size(); }
+
+private:
+
+  /**
+   * The released blocks of one thread.
+   */
+  struct Cache {
+    /** Return all blocks to the system. */
+    ~Cache() {
+      for ( size_t i = 0; i < blocks.size(); ++i ) ::operator delete(blocks[i]);
+      finished() = true;
+    }
+    /** The released blocks. */
+    vector<void *> blocks;
+  };
+
+  /**
+   * The released blocks of the current thread.
+   */
+  static Cache & cache() {
+    static thread_local Cache c;
+    return c;
+  }
+
+  /**
+   * True if the Cache of the current thread has been destroyed. Objects
+   * which are deleted after that, e.g. by the destructors of static
+   * objects, are returned directly to the system.
+   */
+  static bool & finished() {
+    static thread_local bool f = false;
+    return f;
+  }
+
+};
+
+}
+
+#endif /* ThePEG_EventPool_H */
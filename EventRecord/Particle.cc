@@ -35,7 +35,7 @@ Particle::ParticleRep::ParticleRep(const ParticleRep & p)
     thePrevious(p.thePrevious), theNext(p.theNext),
     theBirthStep(p.theBirthStep), theVertex(p.theVertex),
     theLifeLength(p.theLifeLength), theScale(p.theScale),
-    theVetoScale(p.theVetoScale), theNumber(p.theNumber), 
+    theVetoScale(p.theVetoScale), theNumber(p.theNumber), theIndex(0),
     theExtraInfo(p.theExtraInfo.size()) {
   if ( p.theColourInfo )
     theColourInfo = dynamic_ptr_cast<CBPtr>(p.theColourInfo->clone());
@@ -502,10 +502,11 @@ void Particle::persistentOutput(PersistentOStream & os) const {
      << ounit(rep().theVertex, mm) << ounit(rep().theLifeLength, mm)
      << ounit(rep().theScale, GeV2) << ounit(rep().theVetoScale, GeV2) 
      << rep().theNumber << rep().theDecayMode
-     << rep().theColourInfo << rep().theSpinInfo << rep().theExtraInfo;
+     << rep().theColourInfo << rep().theSpinInfo << rep().theExtraInfo
+     << rep().theIndex;
 }
 
-void Particle::persistentInput(PersistentIStream & is, int) {
+void Particle::persistentInput(PersistentIStream & is, int version) {
   bool readRep;
   EventConfig::getParticleData(is, theData);
   is >> iunit(theMomentum, GeV) >> theStatus >> readRep;
@@ -518,6 +519,9 @@ void Particle::persistentInput(PersistentIStream & is, int) {
      >> iunit(rep().theScale, GeV2) >> iunit(rep().theVetoScale, GeV2) 
      >> rep().theNumber >> rep().theDecayMode
      >> rep().theColourInfo >> rep().theSpinInfo >> rep().theExtraInfo;
+  // The index was not written before version 1.
+  if ( version >= 1 ) is >> rep().theIndex;
+  else rep().theIndex = 0;
 }
 
 ClassDescription<Particle> Particle::initParticle;
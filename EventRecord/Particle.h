@@ -16,6 +16,7 @@
 #include "ThePEG/Utilities/ClassDescription.h"
 #include "ThePEG/EventRecord/MultiColour.h"
 #include "ThePEG/EventRecord/SpinInfo.h"
+#include "ThePEG/EventRecord/EventPool.h"
 #include "ThePEG/PDT/ParticleData.h"
 
 namespace ThePEG {
@@ -115,6 +116,20 @@ public:
    * Destructor.
    */
   virtual ~Particle();
+
+  /**
+   * Allocate the memory for a new Particle from the EventPool.
+   */
+  static void * operator new(size_t size) {
+    return EventPool<Particle>::allocate(size);
+  }
+
+  /**
+   * Release the memory of a deleted Particle to the EventPool.
+   */
+  static void operator delete(void * p, size_t size) {
+    EventPool<Particle>::release(p, size);
+  }
   //@}
 
   /** @name Functions relating to ancestry of particles. */
@@ -258,6 +273,16 @@ public:
     return hasRep() ? rep().theNumber : 0; 
   }
 
+  /**
+   * Get the index of this particle in the current event. The index is
+   * given when the particle is first added to an Event and is then
+   * never changed. It is used by ParticleStore to find particles in
+   * constant time. Zero means that no index has been given.
+   */
+  int index() const { 
+    return hasRep() ? rep().theIndex : 0; 
+  }
+
   /**
    * Get the status code of the particle
    */
@@ -960,6 +985,11 @@ private:
    */
   void number(int n) { rep().theNumber = n; }
 
+  /**
+   * Set the index for this particle in the current event.
+   */
+  void index(int i) { rep().theIndex = i; }
+
   /**
    * Remove the given particle from the list of children.
    */
@@ -1042,13 +1072,28 @@ public:
     /**
      * Default constructor.
      */
-    ParticleRep() : theScale(-1.0*GeV2), theVetoScale(-1.0*GeV2), theNumber(0) {}
+    ParticleRep() : theScale(-1.0*GeV2), theVetoScale(-1.0*GeV2), theNumber(0),
+		    theIndex(0) {}
 
     /**
      * Copy constructor.
      */
     ParticleRep(const ParticleRep &);
 
+    /**
+     * Allocate the memory for a new ParticleRep from the EventPool.
+     */
+    static void * operator new(size_t size) {
+      return EventPool<ParticleRep>::allocate(size);
+    }
+
+    /**
+     * Release the memory of a deleted ParticleRep to the EventPool.
+     */
+    static void operator delete(void * p, size_t size) {
+      EventPool<ParticleRep>::release(p, size);
+    }
+
     /**
      * The pointers to the parents.
      */
@@ -1105,6 +1150,11 @@ public:
      */
     int theNumber;
 
+    /**
+     * The index for this particle in the current event.
+     */
+    int theIndex;
+
     /**
      * A pointer to the colour information object.
      */
@@ -1180,6 +1230,8 @@ template <>
 struct ClassTraits<Particle>: public ClassTraitsBase<Particle> {
   /** Return a platform-independent class name */
   static string className() { return "ThePEG::Particle"; }
+  /** Return the class version. Version 1 added the index. */
+  static int version() { return 1; }
   /** Create a Particle object. */
   static TPtr create() { return TPtr::Create(Particle()); }
 };
@@ -1188,6 +1240,8 @@ struct ClassTraits<Particle>: public ClassTraitsBase<Particle> {
 
 }
 
+#include "ThePEG/EventRecord/ParticleStore.h"
+
 #ifndef ThePEG_TEMPLATES_IN_CC_FILE
 #include "Particle.tcc"
 #endif
@@ -0,0 +1,88 @@
+// -*- C++ -*-
+//
+// ParticleColumns.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the ParticleColumns class.
+//
+
+#include "ParticleColumns.h"
+#include "ThePEG/EventRecord/Particle.h"
+
+using namespace ThePEG;
+
+void ParticleColumns::clear() {
+  theParticles.clear();
+  thePx.clear();
+  thePy.clear();
+  thePz.clear();
+  theE.clear();
+  theMass.clear();
+  thePt.clear();
+  theRapidity.clear();
+  thePhi.clear();
+  theId.clear();
+  theICharge.clear();
+  theStatus.clear();
+  theParent.clear();
+}
+
+void ParticleColumns::fill(const tPVector & particles) {
+  // The vectors are resized rather than cleared to reuse their
+  // storage if the columns are filled repeatedly.
+  const size_t N = particles.size();
+  theParticles = particles;
+  thePx.resize(N);
+  thePy.resize(N);
+  thePz.resize(N);
+  theE.resize(N);
+  theMass.resize(N);
+  thePt.resize(N);
+  theRapidity.resize(N);
+  thePhi.resize(N);
+  theId.resize(N);
+  theICharge.resize(N);
+  theStatus.resize(N);
+  theParent.resize(N);
+
+  // First gather everything which needs the event record.
+  for ( size_t i = 0; i < N; ++i ) {
+    const Particle & p = *particles[i];
+    const Lorentz5Momentum & mom = p.momentum();
+    thePx[i] = mom.x()/GeV;
+    thePy[i] = mom.y()/GeV;
+    thePz[i] = mom.z()/GeV;
+    theE[i] = mom.e()/GeV;
+    theMass[i] = mom.mass()/GeV;
+    theId[i] = p.id();
+    theICharge[i] = p.data().iCharge();
+    theStatus[i] = p.status();
+    theParent[i] = p.parents().empty()? 0: p.parents()[0]->number();
+  }
+
+  // Then compute the derived quantities in tight loops over the
+  // arrays, which the compiler is free to vectorize.
+  const double * px = thePx.data();
+  const double * py = thePy.data();
+  const double * pz = thePz.data();
+  const double * e = theE.data();
+  double * pt = thePt.data();
+  double * y = theRapidity.data();
+  double * phi = thePhi.data();
+  for ( size_t i = 0; i < N; ++i )
+    pt[i] = std::sqrt(px[i]*px[i] + py[i]*py[i]);
+  for ( size_t i = 0; i < N; ++i )
+    phi[i] = std::atan2(py[i], px[i]);
+  // Same definition as LorentzVector::rapidity().
+  for ( size_t i = 0; i < N; ++i ) {
+    double mt2 = max(sqr(e[i]*Constants::epsilon),
+		     (e[i] - pz[i])*(e[i] + pz[i]));
+    double rap = std::log((e[i] + std::abs(pz[i]))/std::sqrt(mt2));
+    y[i] = pz[i] > 0.0? rap: ( pz[i] < 0.0? -rap: 0.0 );
+  }
+}
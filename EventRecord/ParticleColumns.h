@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// ParticleColumns.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_ParticleColumns_H
+#define ThePEG_ParticleColumns_H
+// This is the declaration of the ParticleColumns class.
+
+#include "EventConfig.h"
+
+namespace ThePEG {
+
+/**
+ * ParticleColumns is a columnar (structure-of-arrays) snapshot of a
+ * list of particles, typically the final state of an Event. For each
+ * particle the momentum components, mass, PDG id, charge, status and
+ * parent are stored in separate contiguous arrays, together with the
+ * transverse momentum, rapidity and azimuth angle which are computed
+ * for all particles in one go when the columns are filled. Analyses
+ * which loop over many particles can then use the arrays directly
+ * instead of following the pointers of the event record.
+ *
+ * All energies and momenta are given in units of GeV. The
+ * <code>i</code>th element of each array corresponds to the
+ * <code>i</code>th particle in the particles() vector.
+ *
+ * The final state columns of an Event is obtained from
+ * Event::finalStateColumns(), which caches them between calls.
+ *
+ * @see Event
+ * @see AnalysisHandler
+ */
+class ParticleColumns {
+
+public:
+
+  /**
+   * Fill the columns from the given particles.
+   */
+  void fill(const tPVector & particles);
+
+  /**
+   * Remove all particles.
+   */
+  void clear();
+
+  /**
+   * The number of particles.
+   */
+  size_t size() const { return theParticles.size(); }
+
+  /**
+   * Return true if there are no particles.
+   */
+  bool empty() const { return theParticles.empty(); }
+
+  /**
+   * The particles from which the columns were filled.
+   */
+  const tPVector & particles() const { return theParticles; }
+
+  /** @name The momentum columns in units of GeV. */
+  //@{
+  /** The x-components of the momenta. */
+  const vector<double> & px() const { return thePx; }
+  /** The y-components of the momenta. */
+  const vector<double> & py() const { return thePy; }
+  /** The z-components of the momenta. */
+  const vector<double> & pz() const { return thePz; }
+  /** The energies. */
+  const vector<double> & e() const { return theE; }
+  /** The masses. */
+  const vector<double> & mass() const { return theMass; }
+  //@}
+
+  /** @name The derived kinematical columns. */
+  //@{
+  /** The transverse momenta (in units of GeV). */
+  const vector<double> & pt() const { return thePt; }
+  /** The rapidities. */
+  const vector<double> & rapidity() const { return theRapidity; }
+  /** The azimuth angles. */
+  const vector<double> & phi() const { return thePhi; }
+  //@}
+
+  /** @name The other columns. */
+  //@{
+  /** The PDG id numbers. */
+  const vector<long> & id() const { return theId; }
+  /** Three times the charges in units of the positron charge. */
+  const vector<int> & iCharge() const { return theICharge; }
+  /** The status codes. */
+  const vector<int> & status() const { return theStatus; }
+  /**
+   * The order-number (Particle::number()) in the event of the first
+   * parent, or zero if there was no parent.
+   */
+  const vector<int> & parent() const { return theParent; }
+  //@}
+
+private:
+
+  /**
+   * The particles.
+   */
+  tPVector theParticles;
+
+  /** @name The columns. */
+  //@{
+  /** The x-components of the momenta. */
+  vector<double> thePx;
+  /** The y-components of the momenta. */
+  vector<double> thePy;
+  /** The z-components of the momenta. */
+  vector<double> thePz;
+  /** The energies. */
+  vector<double> theE;
+  /** The masses. */
+  vector<double> theMass;
+  /** The transverse momenta. */
+  vector<double> thePt;
+  /** The rapidities. */
+  vector<double> theRapidity;
+  /** The azimuth angles. */
+  vector<double> thePhi;
+  /** The PDG id numbers. */
+  vector<long> theId;
+  /** Three times the charges. */
+  vector<int> theICharge;
+  /** The status codes. */
+  vector<int> theStatus;
+  /** The order-numbers of the first parents. */
+  vector<int> theParent;
+  //@}
+
+};
+
+}
+
+#endif /* ThePEG_ParticleColumns_H */
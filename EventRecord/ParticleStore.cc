@@ -0,0 +1,71 @@
+// -*- C++ -*-
+//
+// ParticleStore.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the ParticleStore class.
+//
+
+#include "ParticleStore.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+
+using namespace ThePEG;
+
+pair<ParticleStore::const_iterator,bool>
+ParticleStore::insert(const PPtr & p) {
+  if ( !p ) return make_pair(end(), false);
+  const_iterator it = find(p);
+  if ( it != end() ) return make_pair(it, false);
+  size_type pos = theParticles.size();
+  theParticles.push_back(p);
+  ++theSize;
+  if ( !addToTable(pos) ) ++theUnindexed;
+  return make_pair(at(pos), true);
+}
+
+ParticleStore::const_iterator ParticleStore::erase(const_iterator it) {
+  size_type pos = it.thePos;
+  int i = index(theParticles[pos]);
+  if ( i > 0 && size_type(i) < theSlots.size() && theSlots[i] == pos + 1 )
+    theSlots[i] = 0;
+  else
+    --theUnindexed;
+  theParticles[pos] = PPtr();
+  --theSize;
+  return at(pos + 1);
+}
+
+ParticleStore::size_type ParticleStore::search(tcPPtr p) const {
+  size_type pos = 0;
+  for ( size_type N = theParticles.size(); pos < N; ++pos )
+    if ( theParticles[pos].operator->() == p.operator->() ) break;
+  return pos;
+}
+
+bool ParticleStore::addToTable(size_type pos) {
+  int i = index(theParticles[pos]);
+  if ( i <= 0 ) return false;
+  if ( size_type(i) >= theSlots.size() )
+    theSlots.resize(max(size_type(i) + 1, 2*theSlots.size()), 0);
+  if ( theSlots[i] ) return false;
+  theSlots[i] = pos + 1;
+  return true;
+}
+
+PersistentOStream & ThePEG::operator<<(PersistentOStream & os,
+				       const ParticleStore & s) {
+  os.putContainer(s);
+  return os;
+}
+
+PersistentIStream & ThePEG::operator>>(PersistentIStream & is,
+				       ParticleStore & s) {
+  is.getContainer(s);
+  return is;
+}
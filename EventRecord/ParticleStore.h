@@ -0,0 +1,353 @@
+// -*- C++ -*-
+//
+// ParticleStore.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_ParticleStore_H
+#define ThePEG_ParticleStore_H
+// This is the declaration of the ParticleStore class.
+
+#include "ThePEG/EventRecord/Particle.h"
+#include <iterator>
+
+namespace ThePEG {
+
+/**
+ * ParticleStore is the container used for the sets of particles in
+ * the Step, Collision and Event classes (where it is known as
+ * ParticleSet). It has the interface of a
+ * <code>std::set<PPtr></code>, but the particles are kept in a flat
+ * vector in the order they were inserted, rather than ordered by
+ * their addresses.
+ *
+ * When a particle is added to an Event it is given an index
+ * (Particle::index()) which is unique in the event. The position of
+ * each particle in the vector is kept in a table indexed by the
+ * particle index, so that membership can be checked in constant
+ * time. Particles without an index, or with an index already used by
+ * another particle in the store, are found by a linear search. If a
+ * particle has been given an index after it was inserted, it is
+ * moved to the table the next time it is found with the non-const
+ * version of find(). The const version never modifies the store, so
+ * that it may be used concurrently from several threads.
+ *
+ * <b>Iterator invalidation.</b> Iterators refer to positions in the
+ * vector. Erasing a particle leaves a hole which is skipped when
+ * iterating, so that erasing only invalidates iterators to the erased
+ * particle, and <code>s.erase(it++)</code> works as for a
+ * <code>std::set</code>. Inserting never invalidates iterators, but
+ * unlike for a <code>std::set</code> it may invalidate references
+ * and pointers to the stored PPtr objects obtained by dereferencing
+ * an iterator. The holes are only removed by clear(), which together
+ * with swap() and assignment invalidates all iterators.
+ *
+ * @see Particle
+ * @see Step
+ */
+class ParticleStore {
+
+public:
+
+  /** The type of the particles stored. */
+  typedef PPtr value_type;
+  /** The type of the particles stored. */
+  typedef PPtr key_type;
+  /** Reference to a stored particle. */
+  typedef const PPtr & reference;
+  /** Reference to a stored particle. */
+  typedef const PPtr & const_reference;
+  /** The size type. */
+  typedef vector<PPtr>::size_type size_type;
+  /** The difference type. */
+  typedef vector<PPtr>::difference_type difference_type;
+
+  /**
+   * Iterator over the particles in a ParticleStore, skipping the
+   * holes left by erased particles. The particles cannot be changed
+   * through the iterator.
+   */
+  class const_iterator {
+
+  public:
+
+    /** @cond TRAITTYPEDEFS */
+    typedef std::forward_iterator_tag iterator_category;
+    typedef PPtr value_type;
+    typedef ParticleStore::difference_type difference_type;
+    typedef const PPtr * pointer;
+    typedef const PPtr & reference;
+    /** @endcond */
+
+    /** The default constructor. */
+    const_iterator(): theVector(0), thePos(0) {}
+
+    /** Dereference. */
+    reference operator*() const { return (*theVector)[thePos]; }
+
+    /** Member access. */
+    pointer operator->() const { return &(*theVector)[thePos]; }
+
+    /** Pre-increment. */
+    const_iterator & operator++() {
+      ++thePos;
+      skip();
+      return *this;
+    }
+
+    /** Post-increment. */
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    /** Test for equality. */
+    bool operator==(const const_iterator & i) const {
+      return thePos == i.thePos && theVector == i.theVector;
+    }
+
+    /** Test for inequality. */
+    bool operator!=(const const_iterator & i) const {
+      return !(*this == i);
+    }
+
+  private:
+
+    /** ParticleStore is a friend. */
+    friend class ParticleStore;
+
+    /** Constructor used by ParticleStore. */
+    const_iterator(const vector<PPtr> * v, size_type pos)
+      : theVector(v), thePos(pos) {
+      skip();
+    }
+
+    /** Move to the first non-empty position. */
+    void skip() {
+      while ( thePos < theVector->size() && !(*theVector)[thePos] ) ++thePos;
+    }
+
+    /** The vector of particles. */
+    const vector<PPtr> * theVector;
+
+    /** The current position. */
+    size_type thePos;
+
+  };
+
+  /** The stored particles cannot be changed through any iterator. */
+  typedef const_iterator iterator;
+
+public:
+
+  /**
+   * The default constructor.
+   */
+  ParticleStore(): theSize(0), theUnindexed(0) {}
+
+  /**
+   * Construct from a range of particles.
+   */
+  template <typename Iterator>
+  ParticleStore(Iterator first, Iterator last)
+    : theSize(0), theUnindexed(0) {
+    insert(first, last);
+  }
+
+public:
+
+  /** @name Iterators and size. */
+  //@{
+  /**
+   * Iterator to the first particle.
+   */
+  const_iterator begin() const { return at(0); }
+
+  /**
+   * Iterator past the last particle.
+   */
+  const_iterator end() const { return at(theParticles.size()); }
+
+  /**
+   * The number of particles.
+   */
+  size_type size() const { return theSize; }
+
+  /**
+   * True if there are no particles.
+   */
+  bool empty() const { return theSize == 0; }
+  //@}
+
+  /** @name Lookup. */
+  //@{
+  /**
+   * Return an iterator to the given particle, or end() if it is not
+   * in the store.
+   */
+  const_iterator find(tcPPtr p) const {
+    size_type pos = lookup(p);
+    if ( pos < theParticles.size() || !theUnindexed || !p ) return at(pos);
+    return at(search(p));
+  }
+
+  /**
+   * Return an iterator to the given particle, or end() if it is not
+   * in the store. If the particle is found by a linear search and its
+   * index is not used in the table, the table is updated.
+   */
+  const_iterator find(tcPPtr p) {
+    size_type pos = lookup(p);
+    if ( pos < theParticles.size() || !theUnindexed || !p ) return at(pos);
+    pos = search(p);
+    if ( pos < theParticles.size() && addToTable(pos) ) --theUnindexed;
+    return at(pos);
+  }
+
+  /**
+   * Return the number of times the given particle is in the store (0
+   * or 1).
+   */
+  size_type count(tcPPtr p) const { return find(p) != end()? 1: 0; }
+  //@}
+
+  /** @name Modifiers. */
+  //@{
+  /**
+   * Add the given particle at the end, unless it is already in the
+   * store. Null pointers are ignored. Returns an iterator to the
+   * particle and true if it was added.
+   */
+  pair<const_iterator,bool> insert(const PPtr & p);
+
+  /**
+   * Add the given particle. The position \a hint is ignored as the
+   * particles are always added at the end.
+   */
+  const_iterator insert(const_iterator, const PPtr & p) {
+    return insert(p).first;
+  }
+
+  /**
+   * Add a range of particles.
+   */
+  template <typename Iterator>
+  void insert(Iterator first, Iterator last) {
+    for ( ; first != last; ++first ) insert(PPtr(*first));
+  }
+
+  /**
+   * Remove the particle at the given position. Returns an iterator to
+   * the following particle.
+   */
+  const_iterator erase(const_iterator it);
+
+  /**
+   * Remove the given particle. Returns the number of removed
+   * particles (0 or 1).
+   */
+  size_type erase(tcPPtr p) {
+    const_iterator it = find(p);
+    if ( it == end() ) return 0;
+    erase(it);
+    return 1;
+  }
+
+  /**
+   * Remove all particles.
+   */
+  void clear() {
+    theParticles.clear();
+    theSlots.clear();
+    theSize = 0;
+    theUnindexed = 0;
+  }
+
+  /**
+   * Swap the contents with another store.
+   */
+  void swap(ParticleStore & s) {
+    theParticles.swap(s.theParticles);
+    theSlots.swap(s.theSlots);
+    std::swap(theSize, s.theSize);
+    std::swap(theUnindexed, s.theUnindexed);
+  }
+  //@}
+
+private:
+
+  /**
+   * Return the index of the given particle.
+   */
+  static int index(tcPPtr p) { return p? p->index(): 0; }
+
+  /**
+   * Return an iterator to the given position in the vector.
+   */
+  const_iterator at(size_type pos) const {
+    return const_iterator(&theParticles, pos);
+  }
+
+  /**
+   * Return the position of the given particle found in the table, or
+   * the size of the vector if it is not there.
+   */
+  size_type lookup(tcPPtr p) const {
+    int i = index(p);
+    if ( i > 0 && size_type(i) < theSlots.size() && theSlots[i] > 0 &&
+	 theParticles[theSlots[i] - 1].operator->() == p.operator->() )
+      return theSlots[i] - 1;
+    return theParticles.size();
+  }
+
+  /**
+   * Return the position of the given particle found by a linear
+   * search, or the size of the vector if it is not there.
+   */
+  size_type search(tcPPtr p) const;
+
+  /**
+   * Put the particle at the given position in the table if it has an
+   * index which is not already used there. Return false if it was
+   * not put in the table.
+   */
+  bool addToTable(size_type pos);
+
+private:
+
+  /**
+   * The particles in the order they were inserted. Erased particles
+   * are replaced by null pointers.
+   */
+  vector<PPtr> theParticles;
+
+  /**
+   * The position (plus one) in theParticles of each particle indexed
+   * by its index, or zero if there is no such particle.
+   */
+  vector<size_type> theSlots;
+
+  /**
+   * The number of particles.
+   */
+  size_type theSize;
+
+  /**
+   * The number of particles which are not in theSlots.
+   */
+  size_type theUnindexed;
+
+};
+
+/** Output a ParticleStore to a PersistentOStream. */
+PersistentOStream & operator<<(PersistentOStream &, const ParticleStore &);
+
+/** Input a ParticleStore from a PersistentIStream. */
+PersistentIStream & operator>>(PersistentIStream &, ParticleStore &);
+
+}
+
+#endif /* ThePEG_ParticleStore_H */
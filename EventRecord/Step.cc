@@ -65,9 +65,9 @@ void Step::rebind(const EventTranslationMap & trans) {
 
 void Step::addParticle(tPPtr p) {
   if ( !p->birthStep() ) p->rep().theBirthStep = this;
+  if ( collision() ) collision()->addParticle(p);
   theParticles.insert(p);
   allParticles.insert(p);
-  if ( collision() ) collision()->addParticle(p);
 }
 
 void Step::addSubProcess(tSubProPtr sp) {
@@ -116,14 +116,14 @@ void Step::removeSubProcess(tSubProPtr sp) {
 }
 
 void Step::addIntermediate(tPPtr p) {
-  theIntermediates.insert(p);
   ParticleSet::iterator pit = theParticles.find(p);
   if ( pit != theParticles.end() ) theParticles.erase(pit);
   else {
     if ( !p->birthStep() ) p->rep().theBirthStep = this;
-    allParticles.insert(p);
     if ( collision() ) collision()->addParticle(p);
+    allParticles.insert(p);
   }
+  theIntermediates.insert(p);
 }
 
 void Step::
@@ -62,6 +62,20 @@ public:
    */
   ~Step();
 
+  /**
+   * Allocate the memory for a new Step from the EventPool.
+   */
+  static void * operator new(size_t size) {
+    return EventPool<Step>::allocate(size);
+  }
+
+  /**
+   * Release the memory of a deleted Step to the EventPool.
+   */
+  static void operator delete(void * p, size_t size) {
+    EventPool<Step>::release(p, size);
+  }
+
   /**
    * Return a pointer to the step handler which performed the
    * generation of this step.
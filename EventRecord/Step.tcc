@@ -21,9 +21,9 @@ void Step::select(OutputIterator r, const SelectorBase & s) const {
 
 template <typename Iterator>
 void Step::addParticles(Iterator first, Iterator last) {
+  if ( collision() ) collision()->addParticles(first, last);
   theParticles.insert(first, last);
   allParticles.insert(first, last);
-  if ( collision() ) collision()->addParticles(first, last);
   for ( ; first != last; ++first )
     if ( !(**first).birthStep() )
       (**first).rep().theBirthStep = this;
@@ -31,9 +31,9 @@ void Step::addParticles(Iterator first, Iterator last) {
 
 template <typename Iterator>
 void Step::addIntermediates(Iterator first, Iterator last) {
+  if ( collision() ) collision()->addParticles(first, last);
   theIntermediates.insert(first, last);
   allParticles.insert(first, last);
-  if ( collision() ) collision()->addParticles(first, last);
   for ( ; first != last; ++first ) {
     if ( !(**first).birthStep() ) (**first).rep().theBirthStep = this;
     ParticleSet::iterator pit = theParticles.find(*first);
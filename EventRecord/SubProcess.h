@@ -60,6 +60,20 @@ public:
    */
   virtual ~SubProcess();
 
+  /**
+   * Allocate the memory for a new SubProcess from the EventPool.
+   */
+  static void * operator new(size_t size) {
+    return EventPool<SubProcess>::allocate(size);
+  }
+
+  /**
+   * Release the memory of a deleted SubProcess to the EventPool.
+   */
+  static void operator delete(void * p, size_t size) {
+    EventPool<SubProcess>::release(p, size);
+  }
+
   /**
    * A pointer to the MEBase object which generated this SubProcess.
    */
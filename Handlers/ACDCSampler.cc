@@ -18,9 +18,59 @@
 #include "ThePEG/Persistency/PersistentOStream.h"
 #include "ThePEG/Persistency/PersistentIStream.h"
 #include "ThePEG/Utilities/Throw.h"
+#include "ThePEG/Repository/CurrentGenerator.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/Handlers/StandardXComb.h"
+#include "ThePEG/MatrixElement/MEBase.h"
+#include "ThePEG/PDT/ParticleData.h"
+#include "ThePEG/StandardModel/StandardModelBase.h"
+#include <unistd.h>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <atomic>
 
 using namespace ThePEG;
 
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * The first random number substream used for building the cells of
+ * the bins in buildBinsThreaded(), well above the ones used for
+ * multi-threaded event generation.
+ */
+const unsigned long binSubstream = 0x80000000ul;
+
+/**
+ * The string written first in a grid file.
+ */
+const string gridFileHeader = "ThePEG ACDCSampler grid 1";
+
+/**
+ * Return a string identifying the given \a bin of the event handler
+ * \a eh, given by the matrix element and the partons it is used for.
+ */
+string binLabel(const StandardEventHandler & eh, int bin) {
+  const StandardXComb & xc = *eh.xCombs()[bin];
+  ostringstream os;
+  os << xc.matrixElement()->fullName();
+  for ( int i = 0, N = xc.mePartonData().size(); i < N; ++i )
+    os << " " << xc.mePartonData()[i]->id();
+  os << " " << eh.nDim(bin);
+  return os.str();
+}
+
+}
+
 ACDCSampler::~ACDCSampler() {}
 
 IBPtr ACDCSampler::clone() const {
@@ -78,7 +128,7 @@ CrossSection ACDCSampler::integratedXSecErr() const {
 }
 
 int ACDCSampler::lastBin() const {
-  return theSampler.last() - 1;
+  return theBuildBin >= 0? theBuildBin: theSampler.last() - 1;
 }
 
 double ACDCSampler::sumWeights() const {
@@ -104,6 +154,13 @@ void ACDCSampler::dofinish() {
       << "efficiency:            " << setw(14) << theSampler.efficiency() << endl
       << "Total integrated xsec: " << setw(14) << theSampler.integral() << endl
       << "        error in xsec: " << setw(14) << theSampler.integralErr() << endl;
+  if ( theGridFile.length() && eventHandler() &&
+       eventHandler()->statLevel() > 1 )
+    generator()->log()
+      << "The cells were "
+      << ( theGridRead? "read from":
+	   generator()->writesSharedFiles()? "saved to": "not saved to" )
+      << " the grid file '" << theGridFile << "'." << endl;
   if ( theSampler.compensating() )
     generator()->logWarning(
       ACDCStillCompensating()
@@ -129,23 +186,220 @@ void ACDCSampler::doinitrun() {
   theSampler.nTry(theNTry);
   theSampler.maxTry(eventHandler()->maxLoop());
   bool nozero = false;
-  for ( int i = 0, N = eventHandler()->nBins(); i < N; ++i )
-    if ( theSampler.addFunction(eventHandler()->nDim(i), eventHandler()) )
-      nozero = true;
+  int N = eventHandler()->nBins();
+  theBinTimes.assign(N, 0.0);
+  theGridRead = false;
+  string key;
+  if ( theGridFile.length() ) {
+    key = gridKey();
+    if ( readGrid(key) ) {
+      theSampler.setRnd(0);
+      theSampler.maxTry(eventHandler()->maxLoop());
+      theGridRead = true;
+      return;
+    }
+  }
+  if ( theInitThreads > 1 && N > 1 )
+    nozero = buildBinsThreaded();
+  else
+    for ( int i = 0; i < N; ++i ) {
+      Clock::time_point start = Clock::now();
+      if ( theSampler.addFunction(eventHandler()->nDim(i), eventHandler()) )
+	nozero = true;
+      theBinTimes[i] = seconds(start);
+    }
   if ( !nozero ) throw EventInitNoXSec()
     << "The event handler '" << eventHandler()->name()
     << "' cannot be initialized because the cross-section for the selected "
     << "sub-processes was zero." << Exception::maybeabort;
+  // In a multi-threaded run only one of the generators writes the
+  // grid file.
+  if ( key.length() && generator()->writesSharedFiles() &&
+       !writeGrid(key) ) Throw<GridFileError>()
+    << "The ACDCSampler '" << name() << "' could not write the grid file '"
+    << theGridFile << "'." << Exception::warning;
+}
+
+string ACDCSampler::gridKey() const {
+  ObjectSet objs;
+  BaseRepository::addReferences(eventHandler(), objs);
+  BaseRepository::addReferences(generator()->standardModel(), objs);
+  for ( ParticleMap::const_iterator it = generator()->particles().begin();
+	it != generator()->particles().end(); ++it )
+    BaseRepository::addReferences(it->second, objs);
+
+  // The grid file name and the number of threads used to build the
+  // grid do not change the grid itself.
+  set<string> ignore;
+  ignore.insert(fullName() + ":GridFile");
+  ignore.insert(fullName() + ":InitThreads");
+  vector<string> skipped;
+  string key = BaseRepository::setupKey(objs, ignore, skipped);
+  if ( !skipped.empty() ) {
+    ostringstream os;
+    for ( int i = 0, N = skipped.size(); i < N; ++i ) os << " " << skipped[i];
+    Throw<GridFileError>()
+      << "The ACDCSampler '" << name() << "' could not get the values of "
+      << "the following interfaces, which are therefore not included in "
+      << "the key of the grid file '" << theGridFile << "':" << os.str()
+      << Exception::warning;
+  }
+  return key;
+}
+
+bool ACDCSampler::readGrid(string key) {
+  try {
+    PersistentIStream is(theGridFile);
+    if ( !is ) return false;
+    string header;
+    string filekey;
+    vector<string> bins;
+    is >> header >> filekey >> bins;
+    int N = eventHandler()->nBins();
+    if ( !is || header != gridFileHeader || filekey != key ||
+	 int(bins.size()) != N ) return false;
+    for ( int i = 0; i < N; ++i )
+      if ( bins[i] != binLabel(*eventHandler(), i) ) return false;
+    theSampler.input(is, false, eventHandler());
+    if ( is && int(theSampler.size()) == N ) return true;
+  }
+  catch ( ... ) {}
+  theSampler.clear();
+  return false;
+}
+
+bool ACDCSampler::writeGrid(string key) const {
+  vector<string> bins;
+  for ( int i = 0, N = eventHandler()->nBins(); i < N; ++i )
+    bins.push_back(binLabel(*eventHandler(), i));
+  // Write to a temporary file, unique for this process and thread,
+  // and then rename it, so that others never see a partial file.
+  ostringstream tmpname;
+  tmpname << theGridFile << "." << getpid() << "."
+	  << std::hash<std::thread::id>()(std::this_thread::get_id());
+  string tmp = tmpname.str();
+  try {
+    PersistentOStream os(tmp);
+    os << gridFileHeader << key << bins;
+    theSampler.output(os, false);
+    if ( !os ) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+  catch ( ... ) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  if ( std::rename(tmp.c_str(), theGridFile.c_str()) == 0 ) return true;
+  std::remove(tmp.c_str());
+  return false;
+}
+
+bool ACDCSampler::buildBinsThreaded() {
+  int N = eventHandler()->nBins();
+  int nthreads = min(theInitThreads, N);
+
+  // Each thread gets its own copy of the generator, with its own
+  // event handler and sub-process objects, made from a snapshot of
+  // the generator as it is now. The copies are made one at the time.
+  ostringstream snapshot;
+  {
+    PersistentOStream os(snapshot, generator()->globalLibraries(),
+			 true, false);
+    os << tcEGPtr(generator());
+  }
+  vector<EGPtr> workers;
+  vector<tStdEHPtr> handlers;
+  vector<ACDCSampler *> samplers;
+  for ( int i = 0; i < nthreads; ++i ) {
+    EGPtr worker = generator()->makeInitWorker(snapshot.str());
+    tStdEHPtr eh = worker?
+      dynamic_ptr_cast<tStdEHPtr>(worker->eventHandler()): tStdEHPtr();
+    ACDCSampler * sampler = eh?
+      dynamic_cast<ACDCSampler *>(eh->sampler().operator->()): 0;
+    if ( !sampler ) throw InitException()
+      << "The ACDCSampler '" << name() << "' could not create a copy of "
+      << "the EventGenerator '" << generator()->name() << "' for building "
+      << "the cells on a separate thread." << Exception::runerror;
+    sampler->theSampler.clear();
+    workers.push_back(worker);
+    handlers.push_back(eh);
+    samplers.push_back(sampler);
+  }
+
+  // Generators without independent streams use a new seed for each
+  // bin instead.
+  bool streams = UseRandom::current().hasStreams();
+  long seed = streams? 0: long(UseRandom::rnd(1.0e8)) + 1;
+
+  // The bins are handed out to the threads in any order, and are then
+  // added to this sampler in the right order.
+  vector<SamplerType *> built(N);
+  vector<char> nonzero(N, false);
+  std::atomic<int> nextBin(0);
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  int debuglevel = Debug::level;
+
+  auto work = [&](int ithread) {
+    Debug::level = debuglevel;
+    tEGPtr worker = workers[ithread];
+    ACDCSampler & sampler = *samplers[ithread];
+    UseRandom workerRandom(worker->randomGenerator());
+    CurrentGenerator workerGenerator(worker);
+    try {
+      for ( int i = nextBin++; i < N; i = nextBin++ ) {
+	Clock::time_point start = Clock::now();
+	if ( streams ) worker->randomGenerator()->substream(binSubstream + i);
+	else worker->randomGenerator()->setSeed(seed + i);
+	SamplerType * bin = new SamplerType();
+	built[i] = bin;
+	bin->setRnd(0);
+	bin->eps(theEps);
+	bin->margin(theMargin);
+	bin->nTry(theNTry);
+	bin->maxTry(eventHandler()->maxLoop());
+	sampler.theBuildBin = i;
+	nonzero[i] = bin->addFunction(handlers[ithread]->nDim(i),
+				      handlers[ithread]);
+	sampler.theBuildBin = -1;
+	theBinTimes[i] = seconds(start);
+      }
+    }
+    catch ( ... ) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if ( !error ) error = std::current_exception();
+      nextBin = N;
+    }
+  };
+
+  vector<std::thread> threads;
+  for ( int i = 0; i < nthreads; ++i ) threads.push_back(std::thread(work, i));
+  for ( int i = 0; i < nthreads; ++i ) threads[i].join();
+
+  bool nozero = false;
+  for ( int i = 0; i < N; ++i ) {
+    if ( built[i] && !error &&
+	 theSampler.addFunction(eventHandler()->nDim(i), eventHandler(),
+				*built[i]) )
+      nozero = nozero || nonzero[i];
+    delete built[i];
+  }
+  if ( error ) std::rethrow_exception(error);
+  return nozero;
 }
 
 void ACDCSampler::persistentOutput(PersistentOStream & os) const {
   os << theEps << theMargin << theNTry;
   theSampler.output(os);
+  os << theInitThreads << theGridFile;
 }
 
 void ACDCSampler::persistentInput(PersistentIStream & is, int) {
   is >> theEps >> theMargin >> theNTry;
   theSampler.input(is);
+  is >> theInitThreads >> theGridFile;
   if ( generator() ) theSampler.setRnd(0);
 }
 
@@ -178,6 +432,34 @@ void ACDCSampler::Init() {
      "The number of phase space points tried in the initialization.",
      &ACDCSampler::theNTry, 1000, 2, 1000000, true, false, true);
 
+  static Parameter<ACDCSampler,int> interfaceInitThreads
+    ("InitThreads",
+     "The number of threads used to build the cells for the different "
+     "bins (sub-processes) when initializing for a run. If larger than "
+     "one, each thread uses its own copy of the EventGenerator, and each "
+     "bin is built using its own random number substream, so that the "
+     "result is the same for any number of threads larger than one, "
+     "but differs from the one obtained with a single thread.",
+     &ACDCSampler::theInitThreads, 1, 1, 0,
+     true, false, Interface::lowerlim);
+
+  static Parameter<ACDCSampler,string> interfaceGridFile
+    ("GridFile",
+     "Name of a file where the cells are saved after they have been "
+     "built when initializing for a run. If the file exists and was "
+     "written for the same setup, the cells are read from the file "
+     "instead of being built again. The setup is identified by a hash "
+     "of the values of all interfaces of the event handler, the "
+     "standard model parameters and the particles, and of the objects "
+     "they refer to, except for random number generators. Note that "
+     "the parameters are compared as they are written by the "
+     "<code>get</code> command, so very small changes may not be "
+     "detected. If empty, no such file is used. In a multi-threaded run, "
+     "the file is only written by the first thread.",
+     &ACDCSampler::theGridFile, "",
+     true, false);
+  interfaceGridFile.fileType();
+
   interfaceNTry.rank(10);
   interfaceEps.rank(9);
 
@@ -43,7 +43,9 @@ public:
   /**
    * The default constructor.
    */
-  ACDCSampler() : theEps(100*Constants::epsilon), theMargin(1.1), theNTry(1000) {}
+  ACDCSampler()
+    : theEps(100*Constants::epsilon), theMargin(1.1), theNTry(1000),
+      theInitThreads(1), theBuildBin(-1), theGridRead(false) {}
 
   /**
    * The copy constructor. We don't copy theSampler.
@@ -51,7 +53,8 @@ public:
   ACDCSampler(const ACDCSampler & x)
     : SamplerBase(x), theSampler(),
       theEps(x.theEps), theMargin(x.theMargin),
-      theNTry(x.theNTry) {}
+      theNTry(x.theNTry), theInitThreads(x.theInitThreads),
+      theBuildBin(-1), theGridFile(x.theGridFile), theGridRead(false) {}
 
   /**
    * The destructor.
@@ -112,6 +115,25 @@ public:
   virtual double sumWeights2() const;
   //@}
 
+  /**
+   * Return the time (in seconds) spent building the cells for each
+   * bin when this sampler was last initialized for a run.
+   */
+  const vector<double> & binTimes() const { return theBinTimes; }
+
+  /**
+   * The name of the file where the cells are saved after they have
+   * been built, to be reused in later runs with the same setup. If
+   * empty, no such file is used.
+   */
+  string gridFile() const { return theGridFile; }
+
+  /**
+   * Return true if the cells were read from gridFile() rather than
+   * built when this sampler was last initialized for a run.
+   */
+  bool gridRead() const { return theGridRead; }
+
 public:
 
   /** @name Functions used by the persistent I/O system. */
@@ -175,6 +197,37 @@ protected:
 
 private:
 
+  /**
+   * Build the cells for all bins concurrently, using theInitThreads
+   * copies of the EventGenerator, each on its own thread. The bins
+   * are built with their own random number substreams (or seeds), so
+   * that the result does not depend on which thread builds which
+   * bin. Return true if any of the bins had a non-zero cross section.
+   */
+  bool buildBinsThreaded();
+
+  /**
+   * Return a key identifying the setup for which the cells are built.
+   * The key is a hash of the values of all interfaces of the event
+   * handler, the standard model parameters and the particles, and of
+   * the objects they refer to, except for random number generators.
+   */
+  string gridKey() const;
+
+  /**
+   * Read the cells from gridFile() if it was written with the given
+   * \a key and for the same bins as the current event handler. Return
+   * false if the cells could not be read.
+   */
+  bool readGrid(string key);
+
+  /**
+   * Write the cells to gridFile() together with the given \a key and
+   * a description of the bins. Return false if the file could not be
+   * written.
+   */
+  bool writeGrid(string key) const;
+
   /**
    * The actual sampler object.
    */
@@ -195,6 +248,35 @@ private:
    */
   int theNTry;
 
+  /**
+   * The number of threads used to build the cells for the different
+   * bins when initializing for a run.
+   */
+  int theInitThreads;
+
+  /**
+   * If non-negative, the bin for which cells are currently being
+   * built in a copy of this sampler, to be returned by lastBin().
+   */
+  int theBuildBin;
+
+  /**
+   * The time (in seconds) spent building the cells for each bin.
+   */
+  vector<double> theBinTimes;
+
+  /**
+   * The name of the file where the cells are saved after they have
+   * been built, to be reused in later runs with the same setup.
+   */
+  string theGridFile;
+
+  /**
+   * True if the cells were read from theGridFile when this sampler
+   * was last initialized for a run.
+   */
+  bool theGridRead;
+
 protected:
 
   /** @cond EXCEPTIONCLASSES */
@@ -210,6 +292,10 @@ protected:
       phase space point within the maximum allowed number of
       attempts. */
   struct EventLoopException: public Exception {};
+
+  /** Exception class used by ACDCSampler if the cells could not be
+      saved to the grid file. */
+  struct GridFileError: public Exception {};
   /** @endcond */
 
 private:
@@ -296,6 +382,19 @@ struct ACDCFncTraits<ThePEG::tStdEHPtr>: public ACDCTraitsType {
     return 0.0;
   }
 
+  /**
+   * Call a function to be sampled by ACDCGen for a block of \a n
+   * points, using StandardEventHandler::dSigDRBatch(), which gives
+   * zero for points which could not be evaluated.
+   */
+  static inline void values(const tStdEHPtr & eh, int n, DimType,
+			    const double * x, double * res) {
+    using namespace ThePEG::Units;
+    std::vector<ThePEG::CrossSection> xsec(n);
+    eh->dSigDRBatch(n, x, &xsec[0]);
+    for ( int i = 0; i < n; ++i ) res[i] = xsec[i]/nanobarn;
+  }
+
 };
 
 /** Specialized Traits class to inform ACDCGen how to use the
@@ -66,6 +66,19 @@ void AnalysisHandler::analyze(tEventPtr event, long, int loop, int state) {
   analyze(particles, event->weight());
   for ( int i = 0, N = theSlaves.size(); i < N; ++i )
     theSlaves[i]->analyze(particles, event->weight());
+  bool columns = usesColumns();
+  for ( int i = 0, N = theSlaves.size(); i < N; ++i )
+    columns = columns || theSlaves[i]->usesColumns();
+  if ( columns ) {
+    ParticleColumns transformed;
+    const ParticleColumns * cols = &transformed;
+    if ( r.isIdentity() ) cols = &event->finalStateColumns();
+    else transformed.fill(particles);
+    if ( usesColumns() ) analyze(*cols, event->weight());
+    for ( int i = 0, N = theSlaves.size(); i < N; ++i )
+      if ( theSlaves[i]->usesColumns() )
+	theSlaves[i]->analyze(*cols, event->weight());
+  }
   r.invert();
   Utilities::transform(particles, r);
 }
@@ -92,6 +105,8 @@ void AnalysisHandler::analyze(tPPtr) {}
 
 void AnalysisHandler::analyze(tPPtr, double) {}
 
+void AnalysisHandler::analyze(const ParticleColumns &, double) {}
+
 void AnalysisHandler::persistentOutput(PersistentOStream & os) const {
   os << theSlaves;
 }
@@ -134,6 +134,27 @@ public:
    */
   virtual void analyze(tPPtr particle, double weight);
 
+  /**
+   * Analyze the given columnar snapshot of the final state. This is
+   * only called by analyze(tEventPtr, long, int, int) if
+   * usesColumns() returns true, in which case it is called after
+   * analyze(const tPVector &, double). If the transform(tcEventPtr)
+   * function returns the identity, the snapshot is the one cached in
+   * the Event and shared with other analysis handlers. The default
+   * version does nothing.
+   * @param columns the final state particles to be analyzed.
+   * @param weight the weight of the current event.
+   */
+  virtual void analyze(const ParticleColumns & columns, double weight);
+
+  /**
+   * Return true if this analysis handler wants the final state as a
+   * ParticleColumns snapshot. Analysis handlers overriding
+   * analyze(const ParticleColumns &, double) must also override this
+   * function to return true. The default version returns false.
+   */
+  virtual bool usesColumns() const { return false; }
+
   //@}
 
   /** @name Functions to access histograms. */
@@ -22,7 +22,7 @@ using namespace ThePEG;
 
 CascadeHandler::~CascadeHandler() {}
 
-bool CascadeHandler::theDidRunCascade=false;
+thread_local bool CascadeHandler::theDidRunCascade=false;
 
 void CascadeHandler::
 handle(EventHandler & eh, const tPVector & tagged,
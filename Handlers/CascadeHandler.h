@@ -182,9 +182,9 @@ private:
   
   /**
    * If there are multiple cascade calls, this flag tells
-   * if cascade was called before.
+   * if cascade was called before. There is one flag per thread.
    */
-  static bool theDidRunCascade;
+  static thread_local bool theDidRunCascade;
   
 
 private:
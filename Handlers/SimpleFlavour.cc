@@ -245,7 +245,7 @@ double SimpleFlavour::vectorMesonProbability(long iq1, long iq2) const {
 double SimpleFlavour::weightSU6QDiQSpin(long iq, long idq, int spin) {
   typedef Triplet<long,long,int> QDiQS;
   typedef map<QDiQS,double> QDiQSpinMap;
-  static QDiQSpinMap qDiQSpin;
+  static thread_local QDiQSpinMap qDiQSpin;
 
   QDiQS i(iq, idq, spin);
   QDiQSpinMap::iterator it = qDiQSpin.find(i);
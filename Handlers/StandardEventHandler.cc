@@ -414,6 +414,24 @@ CrossSection StandardEventHandler::dSigDR(const vector<double> & r) {
   return x;
 }
 
+void StandardEventHandler::
+dSigDRBatch(int n, const double * r, CrossSection * xsec) {
+  int dim = nDim(sampler()->lastBin());
+  vector<double> ri(dim);
+  for ( int i = 0; i < n; ++i ) {
+    for ( int d = 0; d < dim; ++d ) ri[d] = r[d*n + i];
+    // A point which cannot be evaluated gets zero cross section, just
+    // as when the samplers evaluate the points one by one.
+    try {
+      xsec[i] = dSigDR(ri);
+    }
+    catch ( ... ) {
+      breakThePEG();
+      xsec[i] = ZERO;
+    }
+  }
+}
+
 EventPtr StandardEventHandler::generateEvent() {
 
   LoopGuard<EventLoopException,StandardEventHandler>
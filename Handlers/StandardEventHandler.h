@@ -144,6 +144,21 @@ public:
    */
   virtual CrossSection dSigDR(const vector<double> & r);
 
+  /**
+   * Return the cross section for a block of \a n phase space points
+   * in the bin given by SamplerBase::lastBin(). The random numbers
+   * are given in \a r, with all the first random numbers first,
+   * followed by all the second ones etc., so that random number \a d
+   * of point \a i is <code>r[d*n + i]</code>, for \a d from zero to
+   * nDim(bin). The resulting cross sections are returned in \a
+   * xsec. The default version calls dSigDR(const vector<double> &)
+   * for each point, but sub-classes may override it to evaluate the
+   * points together. If an exception is thrown when evaluating a
+   * point, its cross section is set to zero and the other points are
+   * evaluated as usual.
+   */
+  virtual void dSigDRBatch(int n, const double * r, CrossSection * xsec);
+
   /**
    * Generate an event.
    */
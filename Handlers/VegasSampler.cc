@@ -0,0 +1,428 @@
+// -*- C++ -*-
+//
+// VegasSampler.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the VegasSampler class.
+//
+
+#include "VegasSampler.h"
+#include "ThePEG/Interface/ClassDocumentation.h"
+#include "ThePEG/Interface/Parameter.h"
+#include "ThePEG/Interface/Switch.h"
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/UseRandom.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DescribeClass.h"
+#include "ThePEG/Utilities/Throw.h"
+#include <cmath>
+
+using namespace ThePEG;
+
+namespace {
+
+/**
+ * Return the cross section (in nanobarn) of the event handler \a eh
+ * in the point \a x, or zero if it could not be calculated.
+ */
+double value(tStdEHPtr eh, const vector<double> & x) {
+  try {
+    double w = eh->dSigDR(x)/nanobarn;
+    return w > 0.0 && w < Constants::MaxDouble? w: 0.0;
+  }
+  catch ( ... ) {}
+  return 0.0;
+}
+
+}
+
+VegasSampler::VegasSampler()
+  : theIterations(5), thePoints(10000), theIntervals(50), theAlpha(1.5),
+    theStratified(true), theLastBin(0), theLastWeight(0.0), theAttempts(0),
+    theAccepted(0), theOverweights(0), theSumRatio(0.0), theSumRatio2(0.0),
+    theSumWeights(0.0), theSumWeights2(0.0) {}
+
+VegasSampler::~VegasSampler() {}
+
+IBPtr VegasSampler::clone() const {
+  return new_ptr(*this);
+}
+
+IBPtr VegasSampler::fullclone() const {
+  return new_ptr(*this);
+}
+
+void VegasSampler::initialize() {
+  int N = eventHandler()->nBins();
+  if ( N == 0 ) Throw<EventInitNoXSec>()
+    << "The event handler '" << eventHandler()->name()
+    << "' cannot be initialized because there are no selected subprocesses"
+    << Exception::maybeabort;
+  bool nozero = false;
+  vector<double> x;
+  for ( int i = 0; i < N && !nozero; ++i ) {
+    theLastBin = i;
+    x.resize(eventHandler()->nDim(i));
+    for ( int itry = 0; itry < 100 && !nozero; ++itry ) {
+      for ( int d = 0, D = x.size(); d < D; ++d ) x[d] = UseRandom::rnd();
+      nozero = value(eventHandler(), x) > 0.0;
+    }
+  }
+  theLastBin = 0;
+  if ( !nozero ) Throw<EventInitNoXSec>()
+    << "The event handler '" << eventHandler()->name()
+    << "' cannot be initialized because the cross-section for the selected "
+    << "sub-processes was zero." << Exception::maybeabort;
+}
+
+double VegasSampler::map(int bin, const double * y, double * x) const {
+  const vector<double> & grid = theGrids[bin];
+  int D = grid.size()/(theIntervals + 1);
+  double jac = 1.0;
+  for ( int d = 0; d < D; ++d ) {
+    const double * edges = &grid[d*(theIntervals + 1)];
+    int j = interval(y[d]);
+    double width = edges[j + 1] - edges[j];
+    x[d] = edges[j] + (y[d]*theIntervals - j)*width;
+    jac *= width*theIntervals;
+  }
+  return jac;
+}
+
+void VegasSampler::sample(int bin, int n, bool stratify,
+			  vector<double> & y, vector<double> & w) {
+  int D = eventHandler()->nDim(bin);
+  y.resize(n*D);
+  w.resize(n);
+  if ( n <= 0 ) return;
+
+  // Draw the points in the unit hypercube. If stratified, each of the
+  // n equal slices of each dimension gets exactly one point, in
+  // random order.
+  vector<long> order(n);
+  for ( int d = 0; d < D; ++d ) {
+    double * yd = &y[d*n];
+    if ( stratify ) {
+      for ( int i = 0; i < n; ++i ) order[i] = i;
+      for ( int i = n - 1; i > 0; --i )
+	swap(order[i], order[min(UseRandom::irnd(i + 1), long(i))]);
+      for ( int i = 0; i < n; ++i ) yd[i] = (order[i] + UseRandom::rnd())/n;
+    } else
+      for ( int i = 0; i < n; ++i ) yd[i] = UseRandom::rnd();
+  }
+
+  // Map the points using the grid and evaluate them together.
+  vector<double> x(n*D);
+  vector<double> yi(D);
+  vector<double> xi(D);
+  vector<double> jac(n);
+  for ( int i = 0; i < n; ++i ) {
+    for ( int d = 0; d < D; ++d ) yi[d] = y[d*n + i];
+    jac[i] = D > 0? map(bin, &yi[0], &xi[0]): 1.0;
+    for ( int d = 0; d < D; ++d ) x[d*n + i] = xi[d];
+  }
+  theLastBin = bin;
+  vector<CrossSection> xsec(n);
+  eventHandler()->dSigDRBatch(n, D > 0? &x[0]: 0, &xsec[0]);
+  for ( int i = 0; i < n; ++i ) {
+    double f = xsec[i]/nanobarn;
+    if ( !( f > 0.0 && f < Constants::MaxDouble ) ) f = 0.0;
+    w[i] = f*jac[i];
+  }
+}
+
+void VegasSampler::adapt(int bin, int n, const vector<double> & y,
+			 const vector<double> & w) {
+  vector<double> & grid = theGrids[bin];
+  int N = theIntervals;
+  int D = grid.size()/(N + 1);
+  vector<double> sum(N);
+  vector<double> smooth(N);
+  vector<double> r(N);
+  vector<double> edges(N + 1);
+  for ( int d = 0; d < D; ++d ) {
+
+    // Sum the squared weights in each interval and smooth them out
+    // over neighbouring intervals.
+    sum.assign(N, 0.0);
+    for ( int i = 0; i < n; ++i ) sum[interval(y[d*n + i])] += sqr(w[i]);
+    double tot = 0.0;
+    for ( int j = 0; j < N; ++j ) {
+      int jl = max(j - 1, 0);
+      int ju = min(j + 1, N - 1);
+      smooth[j] = (sum[jl] + sum[j] + sum[ju])/(ju - jl + 1);
+      tot += smooth[j];
+    }
+    if ( !( tot > 0.0 ) ) continue;
+
+    // Calculate the damped importance of each interval.
+    double rtot = 0.0;
+    for ( int j = 0; j < N; ++j ) {
+      if ( smooth[j] <= 0.0 ) r[j] = 0.0;
+      else if ( smooth[j] >= tot ) r[j] = 1.0;
+      else r[j] = pow((1.0 - smooth[j]/tot)/log(tot/smooth[j]), theAlpha);
+      rtot += r[j];
+    }
+    if ( !( rtot > 0.0 ) ) continue;
+
+    // Move the edges so that each interval gets the same importance.
+    double * old = &grid[d*(N + 1)];
+    double per = rtot/N;
+    double acc = 0.0;
+    int j = -1;
+    edges[0] = 0.0;
+    edges[N] = 1.0;
+    for ( int k = 1; k < N; ++k ) {
+      while ( acc < per && j < N - 1 ) acc += r[++j];
+      acc -= per;
+      edges[k] = old[j + 1] - (old[j + 1] - old[j])*acc/r[j];
+    }
+    for ( int k = 1; k < N; ++k ) old[k] = edges[k];
+  }
+}
+
+void VegasSampler::doinitrun() {
+  SamplerBase::doinitrun();
+  eventHandler()->initrun();
+  int N = eventHandler()->nBins();
+  theGrids.resize(N);
+  for ( int i = 0; i < N; ++i ) {
+    int D = eventHandler()->nDim(i);
+    theGrids[i].resize(D*(theIntervals + 1));
+    for ( int d = 0; d < D; ++d )
+      for ( int j = 0; j <= theIntervals; ++j )
+	theGrids[i][d*(theIntervals + 1) + j] = double(j)/theIntervals;
+  }
+
+  // In each iteration, share the points between the bins according
+  // to their estimated cross sections, but let each bin have at least
+  // a tenth of its share if the points were shared equally.
+  vector<double> xsec(N, 1.0);
+  vector<double> maxw(N, 0.0);
+  vector<double> y;
+  vector<double> w;
+  for ( int it = 0; it < theIterations; ++it ) {
+    bool last = it == theIterations - 1;
+    double tot = 0.0;
+    for ( int i = 0; i < N; ++i ) tot += xsec[i];
+    for ( int i = 0; i < N; ++i ) {
+      double frac = tot > 0.0? 0.1/N + 0.9*xsec[i]/tot: 1.0/N;
+      int n = max(long(thePoints*frac), 2L*theIntervals);
+      sample(i, n, theStratified, y, w);
+      double sum = 0.0;
+      for ( int k = 0; k < n; ++k ) {
+	sum += w[k];
+	if ( last ) maxw[i] = max(maxw[i], w[k]);
+      }
+      xsec[i] = sum/n;
+      if ( !last ) adapt(i, n, y, w);
+    }
+  }
+
+  // A bin where no point had a positive weight in the last iteration
+  // would never be sampled. Try again with more points before the
+  // grid is frozen, and warn if it is still empty.
+  for ( int i = 0; i < N; ++i ) {
+    int n = max(long(thePoints/N), 2L*theIntervals);
+    for ( int itry = 0; itry < 3 && !( maxw[i] > 0.0 ); ++itry, n *= 4 ) {
+      sample(i, n, theStratified, y, w);
+      for ( int k = 0; k < n; ++k ) maxw[i] = max(maxw[i], w[k]);
+    }
+    if ( !( maxw[i] > 0.0 ) ) Throw<EventInitNoXSec>()
+      << "No phase space point with a non-zero cross section was found in "
+      << "bin " << i << " of the event handler '" << eventHandler()->name()
+      << "' in VegasSampler '" << name() << "'. No events will be generated "
+      << "for this bin." << Exception::warning;
+  }
+
+  theSumMaxWeights.resize(N);
+  for ( int i = 0; i < N; ++i )
+    theSumMaxWeights[i] = maxw[i] + ( i > 0? theSumMaxWeights[i - 1]: 0.0 );
+  theLastBin = 0;
+  theLastWeight = 0.0;
+  theAttempts = theAccepted = theOverweights = 0;
+  theSumRatio = theSumRatio2 = theSumWeights = theSumWeights2 = 0.0;
+  if ( !( sumMaxWeights() > 0.0 ) ) throw EventInitNoXSec()
+    << "The event handler '" << eventHandler()->name()
+    << "' cannot be initialized because the cross-section for the selected "
+    << "sub-processes was zero." << Exception::maybeabort;
+}
+
+double VegasSampler::generate() {
+  int N = theSumMaxWeights.size();
+  vector<double> y;
+  vector<double> & x = lastPoint();
+  for ( long itry = 0, maxloop = eventHandler()->maxLoop();
+	itry < maxloop; ++itry ) {
+    theLastBin = min(int(upper_bound(theSumMaxWeights.begin(),
+				     theSumMaxWeights.end(),
+				     UseRandom::rnd()*sumMaxWeights())
+			 - theSumMaxWeights.begin()), N - 1);
+    int D = eventHandler()->nDim(theLastBin);
+    y.resize(D);
+    x.resize(D);
+    for ( int d = 0; d < D; ++d ) y[d] = UseRandom::rnd();
+    double jac = D > 0? map(theLastBin, &y[0], &x[0]): 1.0;
+    double maxw = theSumMaxWeights[theLastBin] -
+      ( theLastBin > 0? theSumMaxWeights[theLastBin - 1]: 0.0 );
+    double ratio = value(eventHandler(), x)*jac/maxw;
+    ++theAttempts;
+    theSumRatio += ratio;
+    theSumRatio2 += sqr(ratio);
+    if ( ratio <= 0.0 || ratio < UseRandom::rnd() ) continue;
+    ++theAccepted;
+    if ( ratio > 1.0 ) ++theOverweights;
+    theLastWeight = max(ratio, 1.0);
+    theSumWeights += theLastWeight;
+    theSumWeights2 += sqr(theLastWeight);
+    return theLastWeight;
+  }
+  throw EventLoopException()
+    << "The maximum number of attempts (" << eventHandler()->maxLoop()
+    << ") to generate the kinematics in the VegasSampler was exceeded. For "
+    << "the event handler '" << eventHandler()->name() << "'."
+    << Exception::eventerror;
+}
+
+int VegasSampler::lastBin() const {
+  return theLastBin;
+}
+
+void VegasSampler::rejectLast() {
+  --theAccepted;
+  theSumRatio -= theLastWeight;
+  theSumRatio2 -= sqr(theLastWeight);
+  theSumWeights -= theLastWeight;
+  theSumWeights2 -= sqr(theLastWeight);
+}
+
+CrossSection VegasSampler::integratedXSec() const {
+  if ( theAttempts <= 0 ) return ZERO;
+  return sumMaxWeights()*theSumRatio/theAttempts*nanobarn;
+}
+
+CrossSection VegasSampler::integratedXSecErr() const {
+  if ( theAttempts <= 0 ) return ZERO;
+  double mean = theSumRatio/theAttempts;
+  double var = max(theSumRatio2/theAttempts - sqr(mean), 0.0);
+  return sumMaxWeights()*sqrt(var/theAttempts)*nanobarn;
+}
+
+CrossSection VegasSampler::maxXSec() const {
+  return sumMaxWeights()*nanobarn;
+}
+
+double VegasSampler::attempts() const {
+  return theAttempts;
+}
+
+double VegasSampler::sumWeights() const {
+  return theSumWeights;
+}
+
+double VegasSampler::sumWeights2() const {
+  return theSumWeights2;
+}
+
+void VegasSampler::dofinish() {
+  if ( theAttempts <= 0 &&
+       eventHandler() && eventHandler()->statLevel() > 1 ) {
+    generator()->log()
+      << "No events generated by the VEGAS sampler '" << name() << "'"
+      << endl;
+  }
+  else if ( eventHandler() && eventHandler()->statLevel() > 1 )
+    generator()->log()
+      << "Statistics for the VEGAS sampler '" << name() << "':" << endl
+      << "Number of bins:        " << setw(14) << theGrids.size() << endl
+      << "Intervals per dim:     " << setw(14) << theIntervals << endl
+      << "efficiency:            " << setw(14) << efficiency() << endl
+      << "Overweight points:     " << setw(14) << theOverweights << endl
+      << "Total integrated xsec: " << setw(14)
+      << integratedXSec()/nanobarn << endl
+      << "        error in xsec: " << setw(14)
+      << integratedXSecErr()/nanobarn << endl;
+  SamplerBase::dofinish();
+}
+
+void VegasSampler::persistentOutput(PersistentOStream & os) const {
+  os << theIterations << thePoints << theIntervals << theAlpha
+     << theStratified << theGrids << theSumMaxWeights << theLastBin
+     << theLastWeight << theAttempts << theAccepted << theOverweights
+     << theSumRatio << theSumRatio2 << theSumWeights << theSumWeights2;
+}
+
+void VegasSampler::persistentInput(PersistentIStream & is, int) {
+  is >> theIterations >> thePoints >> theIntervals >> theAlpha
+     >> theStratified >> theGrids >> theSumMaxWeights >> theLastBin
+     >> theLastWeight >> theAttempts >> theAccepted >> theOverweights
+     >> theSumRatio >> theSumRatio2 >> theSumWeights >> theSumWeights2;
+}
+
+// The following static variable is needed for the type
+// description system in ThePEG.
+DescribeClass<VegasSampler,SamplerBase>
+describeThePEGVegasSampler("ThePEG::VegasSampler", "VegasSampler.so");
+
+void VegasSampler::Init() {
+
+  static ClassDocumentation<VegasSampler> documentation
+    ("This class inherits from ThePEG::SamplerBase and samples the phase "
+     "space of each sub-process using an adaptive separable grid in the "
+     "style of VEGAS.");
+
+  static Parameter<VegasSampler,int> interfaceIterations
+    ("Iterations",
+     "The number of iterations used to adapt the grids before the run. "
+     "The grids are kept fixed in the last iteration, which is used to "
+     "find the maximum weight for each sub-process.",
+     &VegasSampler::theIterations, 5, 1, 0,
+     true, false, Interface::lowerlim);
+
+  static Parameter<VegasSampler,long> interfacePoints
+    ("Points",
+     "The number of phase space points sampled in each iteration, "
+     "shared between the sub-processes according to their estimated "
+     "cross sections.",
+     &VegasSampler::thePoints, 10000, 1, 0,
+     true, false, Interface::lowerlim);
+
+  static Parameter<VegasSampler,int> interfaceIntervals
+    ("Intervals",
+     "The number of grid intervals in each dimension.",
+     &VegasSampler::theIntervals, 50, 1, 1000,
+     true, false, Interface::limited);
+
+  static Parameter<VegasSampler,double> interfaceAlpha
+    ("Alpha",
+     "The damping of the grid adaption. Larger values give a faster "
+     "but less stable adaption, and zero means no adaption.",
+     &VegasSampler::theAlpha, 1.5, 0.0, 2.0,
+     true, false, Interface::limited);
+
+  static Switch<VegasSampler,bool> interfaceStratified
+    ("Stratified",
+     "Stratify the points sampled when adapting the grids, so that each "
+     "of the equal slices of each dimension gets one point.",
+     &VegasSampler::theStratified, true, true, false);
+  static SwitchOption interfaceStratifiedYes
+    (interfaceStratified,
+     "Yes",
+     "Stratify the points.",
+     true);
+  static SwitchOption interfaceStratifiedNo
+    (interfaceStratified,
+     "No",
+     "Sample the points independently.",
+     false);
+
+  interfacePoints.rank(10);
+  interfaceIterations.rank(9);
+
+}
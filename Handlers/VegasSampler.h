@@ -0,0 +1,346 @@
+// -*- C++ -*-
+//
+// VegasSampler.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_VegasSampler_H
+#define ThePEG_VegasSampler_H
+//
+// This is the declaration of the VegasSampler class.
+//
+
+#include "ThePEG/Handlers/SamplerBase.h"
+#include "ThePEG/Handlers/StandardEventHandler.h"
+
+namespace ThePEG {
+
+/**
+ * VegasSampler inherits from SamplerBase and samples the phase space
+ * of each bin (StandardXComb) of the StandardEventHandler using an
+ * adaptive separable grid in the style of VEGAS. Unlike the cells of
+ * ACDCSampler, the number of grid intervals only grows linearly with
+ * the number of dimensions, which makes it suitable for
+ * high-multiplicity processes.
+ *
+ * When initialized for a run, the grids are adapted in a number of
+ * iterations. In each iteration every bin is sampled with a number of
+ * points proportional to its estimated cross section (the channel
+ * weights), optionally stratified so that each grid interval in each
+ * dimension gets its share of points. The points for a bin are
+ * evaluated together using StandardEventHandler::dSigDRBatch(). In
+ * the last iteration the grids are kept fixed and the maximum weight
+ * in each bin is determined.
+ *
+ * When generating, a bin is chosen according to its maximum weight
+ * and a point is accepted with a probability given by the ratio of
+ * its weight to the maximum. Points with weights above the maximum
+ * are always accepted and returned with a weight above one. The
+ * adapted grids and the statistics are persistent, so that a run can
+ * be resumed.
+ *
+ * @see \ref VegasSamplerInterfaces "The interfaces"
+ * defined for VegasSampler.
+ * @see ACDCSampler
+ */
+class VegasSampler: public SamplerBase {
+
+public:
+
+  /** @name Standard constructors and destructors. */
+  //@{
+  /**
+   * The default constructor.
+   */
+  VegasSampler();
+
+  /**
+   * The destructor.
+   */
+  virtual ~VegasSampler();
+  //@}
+
+public:
+
+  /** @name Virtual functions needed for SamplerBase */
+  //@{
+  /**
+   * Check that the cross section is non-zero for some bin.
+   */
+  virtual void initialize();
+
+  /**
+   * Generate a new phase space point and return a weight associated
+   * with it. The weight is one unless the weight of the point was
+   * larger than the maximum found when initializing.
+   */
+  virtual double generate();
+
+  /**
+   * Return the bin of the last generated phase space point.
+   */
+  virtual int lastBin() const;
+
+  /**
+   * Reject the last chosen phase space point.
+   */
+  virtual void rejectLast();
+
+  /**
+   * Return the total integrated cross section determined from the
+   * Monte Carlo sampling so far.
+   */
+  virtual CrossSection integratedXSec() const;
+
+  /**
+   * Return the error on the total integrated cross section determined
+   * from the Monte Carlo sampling so far.
+   */
+  virtual CrossSection integratedXSecErr() const;
+
+  /**
+   * Return the sum of the maximum weights of all bins.
+   */
+  virtual CrossSection maxXSec() const;
+
+  /**
+   * Return the number of attempted points.
+   */
+  virtual double attempts() const;
+
+  /**
+   * Return the sum of the weights returned by generate() so far (of
+   * the events that were not rejeted).
+   */
+  virtual double sumWeights() const;
+
+  /**
+   * Return the sum of the weights squared returned by generate() so
+   * far (of the events that were not rejeted).
+   */
+  virtual double sumWeights2() const;
+  //@}
+
+  /**
+   * Return the fraction of attempted points which were accepted.
+   */
+  double efficiency() const {
+    return theAttempts > 0? double(theAccepted)/double(theAttempts): 0.0;
+  }
+
+public:
+
+  /** @name Functions used by the persistent I/O system. */
+  //@{
+  /**
+   * Function used to write out object persistently.
+   * @param os the persistent output stream written to.
+   */
+  void persistentOutput(PersistentOStream & os) const;
+
+  /**
+   * Function used to read in object persistently.
+   * @param is the persistent input stream read from.
+   * @param version the version number of the object when written.
+   */
+  void persistentInput(PersistentIStream & is, int version);
+  //@}
+
+  /**
+   * The standard Init function used to initialize the interfaces.
+   * Called exactly once for each class by the class description system
+   * before the main function starts or
+   * when this class is dynamically loaded.
+   */
+  static void Init();
+
+protected:
+
+  /** @name Clone Methods. */
+  //@{
+  /**
+   * Make a simple clone of this object.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr clone() const;
+
+  /** Make a clone of this object, possibly modifying the cloned object
+   * to make it sane.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr fullclone() const;
+  //@}
+
+protected:
+
+  /** @name Standard Interfaced functions. */
+  //@{
+  /**
+   * Initialize this object. Called in the run phase just before
+   * a run begins. Adapts the grids.
+   */
+  virtual void doinitrun();
+
+  /**
+   * Finalize this object. Called in the run phase just after a
+   * run has ended. Used eg. to write out statistics.
+   */
+  virtual void dofinish();
+  //@}
+
+private:
+
+  /**
+   * Map the point \a y in the unit hypercube to the point \a x using
+   * the grid of the given \a bin, and return the Jacobian.
+   */
+  double map(int bin, const double * y, double * x) const;
+
+  /**
+   * Return the grid interval of the coordinate \a y in the unit
+   * hypercube.
+   */
+  int interval(double y) const {
+    return min(int(y*theIntervals), theIntervals - 1);
+  }
+
+  /**
+   * Sample \a n points in the given \a bin, and return the weights
+   * (the cross section in nanobarn times the Jacobian) in \a w. The
+   * points in the unit hypercube are returned in \a y, with all the
+   * first coordinates first etc. If \a stratify is true, the points
+   * are stratified in each dimension.
+   */
+  void sample(int bin, int n, bool stratify, vector<double> & y,
+	      vector<double> & w);
+
+  /**
+   * Adapt the grid of the given \a bin to the weights \a w of the \a
+   * n points \a y.
+   */
+  void adapt(int bin, int n, const vector<double> & y,
+	     const vector<double> & w);
+
+  /**
+   * Return the sum of the maximum weights.
+   */
+  double sumMaxWeights() const {
+    return theSumMaxWeights.empty()? 0.0: theSumMaxWeights.back();
+  }
+
+private:
+
+  /**
+   * The number of iterations used to adapt the grids.
+   */
+  int theIterations;
+
+  /**
+   * The number of points per iteration, shared between the bins.
+   */
+  long thePoints;
+
+  /**
+   * The number of grid intervals in each dimension.
+   */
+  int theIntervals;
+
+  /**
+   * The damping of the grid adaption.
+   */
+  double theAlpha;
+
+  /**
+   * If true, the points sampled when adapting are stratified in each
+   * dimension.
+   */
+  bool theStratified;
+
+  /**
+   * The grid interval edges for each bin, with theIntervals + 1
+   * values for each dimension.
+   */
+  vector< vector<double> > theGrids;
+
+  /**
+   * The accumulated sum of the maximum weights (in nanobarn) of the
+   * bins.
+   */
+  vector<double> theSumMaxWeights;
+
+  /**
+   * The bin of the last generated point, or the bin being sampled when
+   * adapting.
+   */
+  int theLastBin;
+
+  /**
+   * The weight returned for the last generated point.
+   */
+  double theLastWeight;
+
+  /**
+   * The number of attempted points.
+   */
+  long theAttempts;
+
+  /**
+   * The number of accepted points.
+   */
+  long theAccepted;
+
+  /**
+   * The number of accepted points with a weight above the maximum.
+   */
+  long theOverweights;
+
+  /**
+   * The sum of the ratios of the weights to the maximum weights for
+   * all attempted points.
+   */
+  double theSumRatio;
+
+  /**
+   * The sum of the squared ratios of the weights to the maximum
+   * weights for all attempted points.
+   */
+  double theSumRatio2;
+
+  /**
+   * The sum of the weights returned by generate().
+   */
+  double theSumWeights;
+
+  /**
+   * The sum of the squared weights returned by generate().
+   */
+  double theSumWeights2;
+
+protected:
+
+  /** @cond EXCEPTIONCLASSES */
+  /** Exception class used by VegasSampler if a StandardEventHandler
+      was not able to produce a non-zero cross section. */
+  struct EventInitNoXSec: public InitException {};
+
+  /** Exception class used if VegasSampler was not able to produce a
+      phase space point within the maximum allowed number of
+      attempts. */
+  struct EventLoopException: public Exception {};
+  /** @endcond */
+
+private:
+
+  /**
+   * The assignment operator is private and must never be called.
+   * In fact, it should not even be implemented.
+   */
+  VegasSampler & operator=(const VegasSampler &) = delete;
+
+};
+
+}
+
+#endif /* ThePEG_VegasSampler_H */
@@ -44,6 +44,10 @@ map<string,string> & InterfaceBase::objectDefaults(InterfacedBase & ib) const {
   return ib.objectDefaults;
 }
 
+string InterfaceBase::exactValue(InterfacedBase & ib) const {
+  return exec(ib, "get", "");
+}
+
 string InterfaceBase::fullDescription(const InterfacedBase &) const {
   return type() + '\n' + name() + '\n' + description() +
     ( readOnly()? "\n-*-readonly-*-\n": "\n-*-mutable-*-\n" );
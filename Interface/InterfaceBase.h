@@ -105,6 +105,14 @@ public:
   exec(InterfacedBase & ib, string action, string arguments) const
     = 0;
 
+  /**
+   * Return the current value of this interface for the object \a ib
+   * with enough digits that it can be read back exactly. Used when
+   * building keys identifying the setup of objects. The default
+   * version returns the result of the "get" action.
+   */
+  virtual string exactValue(InterfacedBase & ib) const;
+
   /**
    * Return a code for the type of this interface.
    */
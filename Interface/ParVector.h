@@ -407,6 +407,12 @@ public:
   virtual StringVector get(const InterfacedBase & ib) const
    ;
 
+  /**
+   * Return the values of a container of member variables of \a ib
+   * converted with full precision and separated by commas.
+   */
+  virtual string exactValue(InterfacedBase & ib) const;
+
   /**
    * Return the values of a container of member variables of \a ib in a
    * vector of Type.
@@ -150,6 +150,20 @@ get(const InterfacedBase & i) const {
   return res;
 }
 
+template <typename Type>
+string ParVectorTBase<Type>::
+exactValue(InterfacedBase & i) const {
+  TypeVector tres = tget(i);
+  ostringstream os;
+  os.precision(std::numeric_limits<double>::max_digits10);
+  for ( typename TypeVector::iterator it = tres.begin();
+	it != tres.end(); ++it ) {
+    if ( it != tres.begin() ) os << ", ";
+    putUnit(os, *it);
+  }
+  return os.str();
+}
+
 template <typename Type>
 string ParVectorTBase<Type>::
 minimum(const InterfacedBase & i, int place) const {
@@ -328,6 +328,12 @@ public:
   virtual string get(const InterfacedBase & ib) const
    ;
 
+  /**
+   * Return the value of the member variable of \a ib converted with
+   * full precision.
+   */
+  virtual string exactValue(InterfacedBase & ib) const;
+
   /**
    * Return the value of the member variable of \a ib.
    */
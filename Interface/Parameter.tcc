@@ -117,6 +117,15 @@ get(const InterfacedBase & i) const {
   return os.str();
 }
 
+template <typename Type>
+string ParameterTBase<Type>::
+exactValue(InterfacedBase & i) const {
+  ostringstream os;
+  os.precision(std::numeric_limits<double>::max_digits10);
+  putUnit(os, tget(i));
+  return os.str();
+}
+
 template <typename Type>
 string ParameterTBase<Type>::
 minimum(const InterfacedBase & i) const {
@@ -0,0 +1,314 @@
+// -*- C++ -*-
+//
+// LesHouchesCache.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the LesHouchesCache class.
+//
+
+#include "LesHouchesCache.h"
+#include "config.h"
+#include <cstring>
+#include <algorithm>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+using namespace ThePEG;
+
+namespace {
+
+/**
+ * The first line of a cache file.
+ */
+const char header[] = "ThePEG LesHouches cache version 1\n";
+
+/**
+ * The last eight bytes of a complete cache file.
+ */
+const char trailer[] = "LHCINDEX";
+
+/**
+ * The ways a block may be stored.
+ */
+enum Codec { raw = 0, zlib = 1 };
+
+/**
+ * Write \a n objects of type T to \a f.
+ */
+template <typename T>
+bool put(std::FILE * f, const T & t, size_t n = 1) {
+  return std::fwrite(&t, sizeof(T), n, f) == n;
+}
+
+/**
+ * Read \a n objects of type T from \a f.
+ */
+template <typename T>
+bool get(std::FILE * f, T & t, size_t n = 1) {
+  return std::fread(&t, sizeof(T), n, f) == n;
+}
+
+/**
+ * Write \a x to \a f using a variable number of bytes.
+ */
+bool putVarint(std::FILE * f, uint64_t x) {
+  unsigned char buf[10];
+  int n = 0;
+  while ( x >= 0x80 ) {
+    buf[n++] = (unsigned char)(x | 0x80);
+    x >>= 7;
+  }
+  buf[n++] = (unsigned char)x;
+  return std::fwrite(buf, 1, n, f) == size_t(n);
+}
+
+/**
+ * Read an integer written by putVarint() from \a f.
+ */
+bool getVarint(std::FILE * f, uint64_t & x) {
+  x = 0;
+  for ( int shift = 0; shift < 64; shift += 7 ) {
+    int c = std::getc(f);
+    if ( c == EOF ) return false;
+    x |= uint64_t(c & 0x7f) << shift;
+    if ( !( c & 0x80 ) ) return true;
+  }
+  return false;
+}
+
+}
+
+LesHouchesCache::LesHouchesCache()
+  : file(0), isWriting(false), theBlockSize(defaultBlockSize), nEvents(0),
+    nInBlock(0), currentBlock(-1), pos(0), nextEvent(0) {}
+
+LesHouchesCache::~LesHouchesCache() {
+  close();
+}
+
+bool LesHouchesCache::openWrite(string filename, int blocksize) {
+  close();
+  file = std::fopen(filename.c_str(), "wb");
+  if ( !file ) return false;
+  isWriting = true;
+  theBlockSize = max(blocksize, 1);
+  if ( std::fwrite(header, 1, sizeof(header) - 1, file)
+       != sizeof(header) - 1 ) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool LesHouchesCache::openRead(string filename) {
+  close();
+  file = std::fopen(filename.c_str(), "rb");
+  if ( !file ) return false;
+  isWriting = false;
+  if ( !readIndex() ) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void LesHouchesCache::close() {
+  if ( file && isWriting ) {
+    flushBlock();
+    // Write the index: the position and first event number of each
+    // block, followed by the event numbers for each process number,
+    // stored as differences.
+    uint64_t indexpos = ftello(file);
+    putVarint(file, blocks.size());
+    for ( size_t i = 0; i < blocks.size(); ++i ) {
+      putVarint(file, blocks[i].first);
+      putVarint(file, blocks[i].second);
+    }
+    putVarint(file, theProcesses.size());
+    for ( ProcessIndex::const_iterator it = theProcesses.begin();
+	  it != theProcesses.end(); ++it ) {
+      put(file, it->first);
+      putVarint(file, it->second.size());
+      long last = 0;
+      for ( size_t i = 0; i < it->second.size(); ++i ) {
+	putVarint(file, it->second[i] - last);
+	last = it->second[i];
+      }
+    }
+    putVarint(file, theInfo.size());
+    std::fwrite(theInfo.data(), 1, theInfo.size(), file);
+    put(file, indexpos);
+    put(file, uint64_t(nEvents));
+    std::fwrite(trailer, 1, sizeof(trailer) - 1, file);
+  }
+  if ( file ) std::fclose(file);
+  file = 0;
+  isWriting = false;
+  nEvents = 0;
+  blocks.clear();
+  theProcesses.clear();
+  theInfo.clear();
+  block.clear();
+  nInBlock = 0;
+  currentBlock = -1;
+  pos = 0;
+  nextEvent = 0;
+}
+
+void LesHouchesCache::write(const char * data, size_t size, int idprup) {
+  if ( !writing() ) return;
+  uint32_t len = size;
+  size_t start = block.size();
+  block.resize(start + sizeof(len) + size);
+  std::memcpy(&block[start], &len, sizeof(len));
+  std::memcpy(&block[start + sizeof(len)], data, size);
+  theProcesses[idprup].push_back(nEvents++);
+  if ( ++nInBlock >= theBlockSize ) flushBlock();
+}
+
+void LesHouchesCache::flushBlock() {
+  if ( !nInBlock ) return;
+  blocks.push_back(make_pair(uint64_t(ftello(file)), nEvents - nInBlock));
+  uint32_t nraw = block.size();
+  uint32_t npacked = nraw;
+  unsigned char codec = raw;
+  const char * data = &block[0];
+#ifdef HAVE_LIBZ
+  uLongf destlen = compressBound(nraw);
+  packed.resize(destlen);
+  if ( compress2((Bytef*)&packed[0], &destlen, (const Bytef*)&block[0], nraw,
+		 Z_BEST_SPEED) == Z_OK && destlen < nraw ) {
+    npacked = destlen;
+    codec = zlib;
+    data = &packed[0];
+  }
+#endif
+  put(file, codec);
+  put(file, uint32_t(nInBlock));
+  put(file, nraw);
+  put(file, npacked);
+  std::fwrite(data, 1, npacked, file);
+  block.clear();
+  nInBlock = 0;
+}
+
+bool LesHouchesCache::readIndex() {
+  char buf[sizeof(header)];
+  if ( std::fread(buf, 1, sizeof(header) - 1, file) != sizeof(header) - 1 ||
+       std::memcmp(buf, header, sizeof(header) - 1) != 0 ) return false;
+  uint64_t indexpos = 0;
+  uint64_t nevents = 0;
+  char tail[sizeof(trailer)];
+  if ( fseeko(file, -off_t(2*sizeof(uint64_t) + sizeof(trailer) - 1),
+	      SEEK_END) != 0 ||
+       !get(file, indexpos) || !get(file, nevents) ||
+       std::fread(tail, 1, sizeof(trailer) - 1, file) != sizeof(trailer) - 1 ||
+       std::memcmp(tail, trailer, sizeof(trailer) - 1) != 0 ||
+       fseeko(file, indexpos, SEEK_SET) != 0 ) return false;
+  nEvents = nevents;
+  uint64_t n = 0;
+  if ( !getVarint(file, n) ) return false;
+  blocks.resize(n);
+  for ( size_t i = 0; i < n; ++i ) {
+    uint64_t first = 0;
+    if ( !getVarint(file, blocks[i].first) || !getVarint(file, first) )
+      return false;
+    blocks[i].second = first;
+  }
+  if ( !getVarint(file, n) ) return false;
+  for ( size_t ip = 0; ip < n; ++ip ) {
+    int idprup = 0;
+    uint64_t nev = 0;
+    if ( !get(file, idprup) || !getVarint(file, nev) ) return false;
+    vector<long> & events = theProcesses[idprup];
+    events.resize(nev);
+    long last = 0;
+    for ( size_t i = 0; i < nev; ++i ) {
+      uint64_t diff = 0;
+      if ( !getVarint(file, diff) ) return false;
+      events[i] = last += diff;
+    }
+  }
+  if ( !getVarint(file, n) ) return false;
+  theInfo.resize(n);
+  if ( n && std::fread(&theInfo[0], 1, n, file) != n ) return false;
+  currentBlock = -1;
+  nextEvent = 0;
+  return true;
+}
+
+bool LesHouchesCache::loadBlock(size_t iblock) {
+  if ( iblock >= blocks.size() ) return false;
+  if ( fseeko(file, blocks[iblock].first, SEEK_SET) != 0 ) return false;
+  unsigned char codec = raw;
+  uint32_t nev = 0, nraw = 0, npacked = 0;
+  if ( !get(file, codec) || !get(file, nev) ||
+       !get(file, nraw) || !get(file, npacked) ) return false;
+  block.resize(nraw);
+  if ( codec == raw ) {
+    if ( npacked != nraw ||
+	 std::fread(&block[0], 1, nraw, file) != nraw ) return false;
+  }
+#ifdef HAVE_LIBZ
+  else if ( codec == zlib ) {
+    packed.resize(npacked);
+    if ( std::fread(&packed[0], 1, npacked, file) != npacked ) return false;
+    uLongf destlen = nraw;
+    if ( uncompress((Bytef*)&block[0], &destlen,
+		    (const Bytef*)&packed[0], npacked) != Z_OK ||
+	 destlen != nraw ) return false;
+  }
+#endif
+  else return false;
+  currentBlock = iblock;
+  pos = 0;
+  nextEvent = blocks[iblock].second;
+  return true;
+}
+
+const char * LesHouchesCache::read(size_t & size) {
+  if ( !file || isWriting || nextEvent >= nEvents ) return 0;
+  if ( currentBlock < 0 || pos >= block.size() ) {
+    if ( !loadBlock(currentBlock + 1) ) return 0;
+  }
+  uint32_t len = 0;
+  std::memcpy(&len, &block[pos], sizeof(len));
+  const char * data = &block[pos + sizeof(len)];
+  pos += sizeof(len) + len;
+  ++nextEvent;
+  size = len;
+  return data;
+}
+
+bool LesHouchesCache::seek(long ievent) {
+  if ( !file || isWriting || ievent < 0 || ievent > nEvents ) return false;
+  if ( ievent == nEvents ) {
+    // Positioned at the end of the file, read() will return null.
+    nextEvent = nEvents;
+    return true;
+  }
+  // Find the last block starting at or before the requested event.
+  size_t lo = 0, hi = blocks.size();
+  while ( hi - lo > 1 ) {
+    size_t mid = ( lo + hi )/2;
+    if ( blocks[mid].second <= ievent ) lo = mid;
+    else hi = mid;
+  }
+  if ( currentBlock != long(lo) || nextEvent > ievent ) {
+    if ( !loadBlock(lo) ) return false;
+  }
+  while ( nextEvent < ievent ) {
+    uint32_t len = 0;
+    std::memcpy(&len, &block[pos], sizeof(len));
+    pos += sizeof(len) + len;
+    ++nextEvent;
+  }
+  return true;
+}
@@ -0,0 +1,269 @@
+// -*- C++ -*-
+//
+// LesHouchesCache.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef THEPEG_LesHouchesCache_H
+#define THEPEG_LesHouchesCache_H
+// This is the declaration of the LesHouchesCache class.
+
+#include "ThePEG/Config/ThePEG.h"
+#include <cstdio>
+#include <cstdint>
+
+namespace ThePEG {
+
+/**
+ * LesHouchesCache is the cache file used by LesHouchesReader to store
+ * events in a fast-readable form. Each event is stored as an opaque
+ * record, given by the LesHouchesReader, together with its process
+ * number (IDPRUP).
+ *
+ * The records are collected in blocks of blockSize() events, which
+ * are compressed with zlib (if available) before being written. When
+ * the file is closed, an index is written at the end, giving the
+ * position of each block in the file, and the numbers of the events
+ * for each process number. Using the index, any event can be found
+ * with seek() by decompressing only the block containing it, and a
+ * file can be split into disjoint ranges of events to be read by
+ * several independent jobs. Files which were not properly closed
+ * have no index and cannot be read. The user of the file may also
+ * store some additional information in the index with info().
+ *
+ * The file is written in the native byte order and is only meant to
+ * be read on the same kind of machine as it was written on.
+ *
+ * @see LesHouchesReader
+ */
+class LesHouchesCache {
+
+public:
+
+  /**
+   * Map of event numbers indexed by process number.
+   */
+  typedef map<int, vector<long> > ProcessIndex;
+
+public:
+
+  /** @name Standard constructors and destructors. */
+  //@{
+  /**
+   * The default constructor.
+   */
+  LesHouchesCache();
+
+  /**
+   * The destructor closes the file.
+   */
+  ~LesHouchesCache();
+  //@}
+
+  /** @name Opening and closing files. */
+  //@{
+  /**
+   * Open the file called \a filename for writing, collecting \a
+   * blocksize events in each compressed block.
+   * @return false if the file could not be opened.
+   */
+  bool openWrite(string filename, int blocksize = defaultBlockSize);
+
+  /**
+   * Open the file called \a filename for reading and read its
+   * index.
+   * @return false if the file could not be opened or was not a
+   * complete cache file.
+   */
+  bool openRead(string filename);
+
+  /**
+   * Close the file. If the file was opened for writing, the last
+   * block and the index are written first.
+   */
+  void close();
+
+  /**
+   * Return non-null if the file is open.
+   */
+  operator void * () const { return file; }
+
+  /**
+   * Return true if the file is not open.
+   */
+  bool operator!() const { return !file; }
+
+  /**
+   * Return true if the file is open for writing.
+   */
+  bool writing() const { return file && isWriting; }
+  //@}
+
+  /** @name Writing and reading events. */
+  //@{
+  /**
+   * Add an event record of \a size bytes starting at \a data, with
+   * the process number \a idprup.
+   */
+  void write(const char * data, size_t size, int idprup);
+
+  /**
+   * Read the next event record. The returned pointer is valid until
+   * the next call to read() or seek(), and the size of the record is
+   * returned in \a size.
+   * @return null if there are no more events in the file.
+   */
+  const char * read(size_t & size);
+
+  /**
+   * Position the file so that the next event read will be number \a
+   * ievent (counted from zero). Only the block containing the event
+   * is read and decompressed.
+   * @return false if there is no such event.
+   */
+  bool seek(long ievent);
+
+  /**
+   * Return the number of the event which will be read next.
+   */
+  long tell() const { return nextEvent; }
+
+  /**
+   * Return the number of events in the file.
+   */
+  long size() const { return nEvents; }
+
+  /**
+   * Return the numbers of the events in the file for each process
+   * number.
+   */
+  const ProcessIndex & processes() const { return theProcesses; }
+
+  /**
+   * Return the number of events collected in each block.
+   */
+  int blockSize() const { return theBlockSize; }
+
+  /**
+   * Set additional information to be stored in the index when the
+   * file is closed.
+   */
+  void info(const string & x) { theInfo = x; }
+
+  /**
+   * Return the additional information stored in the index.
+   */
+  const string & info() const { return theInfo; }
+  //@}
+
+  /**
+   * The default number of events collected in each block.
+   */
+  static const int defaultBlockSize = 4096;
+
+private:
+
+  /**
+   * Compress and write the current block, if not empty.
+   */
+  void flushBlock();
+
+  /**
+   * Read and decompress block number \a iblock.
+   */
+  bool loadBlock(size_t iblock);
+
+  /**
+   * Read and check the index at the end of the file.
+   */
+  bool readIndex();
+
+private:
+
+  /**
+   * The underlying file.
+   */
+  std::FILE * file;
+
+  /**
+   * True if the file was opened for writing.
+   */
+  bool isWriting;
+
+  /**
+   * The number of events in each block.
+   */
+  int theBlockSize;
+
+  /**
+   * The number of events in the file.
+   */
+  long nEvents;
+
+  /**
+   * The position in the file of each block, and the number of the
+   * first event in it.
+   */
+  vector< pair<uint64_t,long> > blocks;
+
+  /**
+   * The event numbers for each process number.
+   */
+  ProcessIndex theProcesses;
+
+  /**
+   * Additional information stored in the index.
+   */
+  string theInfo;
+
+  /**
+   * The uncompressed records of the current block.
+   */
+  vector<char> block;
+
+  /**
+   * Buffer for the compressed block.
+   */
+  vector<char> packed;
+
+  /**
+   * The number of events in the current block when writing.
+   */
+  int nInBlock;
+
+  /**
+   * The index of the block currently loaded when reading, or -1 if
+   * none.
+   */
+  long currentBlock;
+
+  /**
+   * The position of the next record in the current block when
+   * reading.
+   */
+  size_t pos;
+
+  /**
+   * The number of the next event to be read.
+   */
+  long nextEvent;
+
+private:
+
+  /**
+   * The copy constructor is private and not implemented.
+   */
+  LesHouchesCache(const LesHouchesCache &) = delete;
+
+  /**
+   * The assignment operator is private and not implemented.
+   */
+  LesHouchesCache & operator=(const LesHouchesCache &) = delete;
+
+};
+
+}
+
+#endif /* THEPEG_LesHouchesCache_H */
@@ -176,6 +176,10 @@ void LesHouchesEventHandler::doinitrun() {
 
   weightnames.clear(); 
   
+  if ( theReaderThreads > 0 )
+    LesHouchesReader::prefetchThreads(theReaderThreads);
+  thePendingReaders.clear();
+
   for ( int i = 0, N = readers().size(); i < N; ++i ) { 
 
     readers()[i]->initrun();
@@ -207,7 +211,7 @@ EventPtr LesHouchesEventHandler::generateEvent() {
   while ( true ) {
     loopGuard();
 
-    currentReader(readers()[selector().select(UseRandom::current())]);
+    currentReader(readers()[selectReader()]);
 
     skipEvents();
     currentReader()->reset();
@@ -280,6 +284,22 @@ EventPtr LesHouchesEventHandler::generateEvent() {
   }
 }
 
+int LesHouchesEventHandler::selectReader() {
+  if ( theSelectionWindow <= 0 )
+    return selector().select(UseRandom::current());
+  while ( int(thePendingReaders.size()) < theSelectionWindow )
+    thePendingReaders.push_back(selector().select(UseRandom::current()));
+  // Use the first reader with an event ready. If there is none, wait
+  // for the one which was selected first.
+  vector<int>::iterator it = thePendingReaders.begin();
+  while ( it != thePendingReaders.end() && !readers()[*it]->eventReady() )
+    ++it;
+  if ( it == thePendingReaders.end() ) it = thePendingReaders.begin();
+  int i = *it;
+  thePendingReaders.erase(it);
+  return i;
+}
+
 void LesHouchesEventHandler::skipEvents() {
  
   if ( weightOption() == 2 || weightOption() == -2 ) return; //does it make sense to skip events if we are using varying weights?
@@ -294,7 +314,8 @@ void LesHouchesEventHandler::skipEvents() {
     frac *= double(stats.attempts())/double(stats.accepted());
   else
     frac *= double(stats.attempts() + 1);
-  double xscan = generator()->N()*frac/currentReader()->NEvents();
+  double xscan = double(generator()->N())/generator()->eventStride()*
+    frac/currentReader()->NEvents();
 
   // Estimate the number of times we need to go through the events for
   // the currentReader(), and how many events on average we need to
@@ -367,6 +388,13 @@ EventPtr LesHouchesEventHandler::continueEvent() {
 
 void LesHouchesEventHandler::dofinish() {
   EventHandler::dofinish();
+  if ( theReaderThreads > 0 ) {
+    // The readers must stop using the common pool before its threads
+    // are joined.
+    for ( int i = 0, N = readers().size(); i < N; ++i )
+      readers()[i]->stopPrefetching();
+    LesHouchesReader::releasePrefetchThreads();
+  }
   if ( selector().compensating() ) 
     generator()->log()
       << "Warning: The run was ended while the LesHouchesEventHandler '"
@@ -494,7 +522,7 @@ void LesHouchesEventHandler::reject(double w) {
 }
 
 const map<string,CrossSection> & LesHouchesEventHandler::optintegratedXSecMap() const {
-  static map<string,CrossSection> result;
+  static thread_local map<string,CrossSection> result;
   result.clear();
   for ( map<string,OptWeight>::const_iterator it= opt.begin(); it!=opt.end(); ++it ) {
     result[it->first] = ( it->second.stats.sumWeights() / it->second.stats.attempts() ) * picobarn;
@@ -521,13 +549,13 @@ int LesHouchesEventHandler::ntriesinternal() const {
 void LesHouchesEventHandler::persistentOutput(PersistentOStream & os) const {
   os << stats << histStats << theReaders << theSelector
      << oenum(theWeightOption) << theUnitTolerance << theCurrentReader << warnPNum
-     << theNormWeight << UseLHEEvent;
+     << theNormWeight << UseLHEEvent << theReaderThreads << theSelectionWindow;
 }
 
 void LesHouchesEventHandler::persistentInput(PersistentIStream & is, int) {
   is >> stats >> histStats >> theReaders >> theSelector
      >> ienum(theWeightOption) >> theUnitTolerance >> theCurrentReader >> warnPNum
-     >> theNormWeight >> UseLHEEvent;
+     >> theNormWeight >> UseLHEEvent >> theReaderThreads >> theSelectionWindow;
 }
 
 ClassDescription<LesHouchesEventHandler>
@@ -638,6 +666,31 @@ void LesHouchesEventHandler::Init() {
      "Corresponding to the LHE event number",
      1);
 
+  static Parameter<LesHouchesEventHandler,int> interfaceReaderThreads
+    ("ReaderThreads",
+     "If larger than zero, the number of threads in a common pool used to "
+     "read ahead events for all readers which prefetch events (see the "
+     "PrefetchEvents interface of LesHouchesReader). If zero, each such "
+     "reader reads events on its own thread.",
+     &LesHouchesEventHandler::theReaderThreads, 0, 0, 0,
+     true, false, Interface::lowerlim);
+
+  static Parameter<LesHouchesEventHandler,int> interfaceSelectionWindow
+    ("SelectionWindow",
+     "If larger than zero, the number of readers which are selected in "
+     "advance according to their cross sections. For each event the first "
+     "of these which has an event ready is used, so that a reader which is "
+     "slow in reading its events does not stall the others. Since all "
+     "selections are eventually used, each reader still contributes "
+     "according to its cross section, except for the selections still "
+     "pending at the end of the run. Only useful when the readers prefetch "
+     "events. <b>Note</b> that which reader is used for a given event then "
+     "depends on the timing of the prefetching threads, so the events "
+     "generated cannot be reproduced, even with the same random seed. "
+     "Set this to zero for reproducible runs.",
+     &LesHouchesEventHandler::theSelectionWindow, 0, 0, 0,
+     true, false, Interface::lowerlim);
+
 
   interfaceLesHouchesReaders.rank(10);
   interfaceWeightOption.rank(9);
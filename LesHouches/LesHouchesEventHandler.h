@@ -71,7 +71,8 @@ public:
    */
   LesHouchesEventHandler()
     : theWeightOption(unitweight), theUnitTolerance(1.0e-6), warnPNum(true),
-      theNormWeight(0), UseLHEEvent(0)
+      theNormWeight(0), UseLHEEvent(0), theReaderThreads(0),
+      theSelectionWindow(0)
   {
     selector().tolerance(unitTolerance());
   }
@@ -410,6 +411,41 @@ private:
    */
   unsigned int UseLHEEvent;
 
+  /**
+   * If larger than zero, the number of threads in a common pool used
+   * to read ahead events for all readers which prefetch events.
+   */
+  int theReaderThreads;
+
+  /**
+   * If larger than zero, the number of readers selected in advance,
+   * among which the first one with an event ready is used. The
+   * events generated then depend on the timing of the prefetching
+   * threads and cannot be reproduced.
+   */
+  int theSelectionWindow;
+
+  /**
+   * The indices of the readers selected in advance but not yet used.
+   */
+  vector<int> thePendingReaders;
+
+private:
+
+  /**
+   * Select the reader to be used for the next event and return its
+   * index. Normally the reader is selected according to its
+   * overestimated cross section, but if theSelectionWindow is larger
+   * than zero, the selections are made in advance, and the first
+   * selected reader which has an event ready is used. Since every
+   * selection is eventually used, the readers are still used
+   * according to their cross sections, but a reader which is slow in
+   * reading its events does not stall the others. The choice then
+   * depends on the timing of the prefetching threads, so the sequence
+   * of events is not reproducible.
+   */
+  int selectReader();
+
 public:
 
   /** @cond EXCEPTIONCLASSES */
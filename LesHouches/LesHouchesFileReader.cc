@@ -22,9 +22,41 @@
 #include "ThePEG/Persistency/PersistentIStream.h"
 #include <sstream>
 #include <iostream>
+#include <cctype>
+#include <sys/stat.h>
 
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * Find the start of at most \a maxtok white-space delimited tokens
+ * in \a line without copying anything. The tokens are not
+ * terminated, but any function parsing a number from the start of a
+ * token will stop at the end of it.
+ * @return the number of tokens found.
+ */
+int tokenize(const char * line, const char ** tok, int maxtok) {
+  int ntok = 0;
+  while ( ntok < maxtok ) {
+    while ( *line && std::isspace(*line) ) ++line;
+    if ( !*line ) break;
+    tok[ntok++] = line;
+    while ( *line && !std::isspace(*line) ) ++line;
+  }
+  return ntok;
+}
+
+/**
+ * Return the end of the token starting at \a tok.
+ */
+const char * tokenEnd(const char * tok) {
+  while ( *tok && !std::isspace(*tok) ) ++tok;
+  return tok;
+}
+
+}
+
 LesHouchesFileReader::
 LesHouchesFileReader(const LesHouchesFileReader & x)
   : LesHouchesReader(x), neve(x.neve), ieve(0),
@@ -646,6 +678,18 @@ void LesHouchesFileReader::open() {
   string central = "central";
   if (theIncludeCentral) optionalWeightsNames.push_back(central);
 
+  // index the weight information by the weight id stripped of
+  // quotes, as used when reading the weights of each event
+  scaleInfo.clear();
+  for (map<string,string>::const_iterator it=scalemap.begin(); it!=scalemap.end(); ++it){
+    string id = it->first;
+    erase_substr(id, "'");
+    erase_substr(id, "\"");
+    string info = it->second;
+    erase_substr(info, "\n");
+    scaleInfo.insert(make_pair(id, info));
+  }
+
   //  cout << "reading init finished" << endl;
   if ( !cfile ) {
     heprup.NPRUP = -42;
@@ -675,27 +719,25 @@ bool LesHouchesFileReader::doReadEvent() {
   eventAttributes = StringUtils::xmlAttributes("event", cfile.getline());
 
   /* information necessary for FxFx merging:
-   * the npLO and npNLO tags
+   * the npLO and npNLO tags, given as the third and sixth token on
+   * the event line. If the line ends just before one of them, it
+   * is taken to be zero.
    */
-  istringstream ievat(cfile.getline());
-  int we(0), npLO(-99), npNLO(-99);
-  do {
-    string sub; ievat >> sub;
-    if(we==2) { npLO = atoi(sub.c_str()); }
-    if(we==5) { npNLO = atoi(sub.c_str()); }
-    ++we;
-  } while (ievat);
+  const char * tok[6];
+  int ntok = tokenize(cfile.line(), tok, 6);
+  int npLO = ntok > 2? atoi(tok[2]): ( ntok == 2? 0: -99 );
+  int npNLO = ntok > 5? atoi(tok[5]): ( ntok == 5? 0: -99 );
   optionalnpLO = npLO;
   optionalnpNLO = npNLO;
-  std::stringstream npstringstream;
-  npstringstream << "np " << npLO << " " << npNLO;
-  std::string npstrings = npstringstream.str();
   /* the FxFx merging information 
    * becomes part of the optionalWeights, labelled -999 
    * for future reference
    */
-
-  if(theIncludeFxFxTags) optionalWeights[npstrings.c_str()] = -999;
+  if(theIncludeFxFxTags) {
+    std::stringstream npstringstream;
+    npstringstream << "np " << npLO << " " << npNLO;
+    optionalWeights[npstringstream.str()] = -999;
+  }
 
   if ( !cfile.readline()  ) return false;
 
@@ -747,17 +789,14 @@ bool LesHouchesFileReader::doReadEvent() {
      */
     if(readingWeights) { 
       if(!cfile.find("<wgt")) { continue; }
-      istringstream iss(cfile.getline());
-      int wi = 0;
-      double weightValue(0);
+      // the name is the second token, with any '>' removed, and the
+      // value is the third token
+      ntok = tokenize(cfile.line(), tok, 3);
       string weightName = "";
-      // we need to put the actual weight value into a double
-      do {
-	string sub; iss >> sub;
-	if(wi==1) { string str_arrow = ">" ; erase_substr(sub, str_arrow); weightName = sub; }
-	if(wi==2) weightValue = atof(sub.c_str());
-	++wi;
-      } while (iss);
+      if ( ntok > 1 )
+	for ( const char * c = tok[1], * e = tokenEnd(c); c != e; ++c )
+	  if ( *c != '>' ) weightName += *c;
+      double weightValue = ntok > 2? atof(tok[2]): 0.0;
       // store the optional weights found in the temporary map
       optionalWeightsTemp[weightName] = weightValue; 
     }
@@ -836,19 +875,11 @@ bool LesHouchesFileReader::doReadEvent() {
     string id_1 = it->first;
     erase_substr(id_1, str_quote);
     erase_substr(id_1, str_doublequote);
-    for (map<string,string>::const_iterator it2=scalemap.begin(); it2!=scalemap.end(); ++it2){
-      //find the scale id in the scale information and add this information
-      string id_2 = it2->first;
-      erase_substr(id_2, str_quote);
-      erase_substr(id_2, str_doublequote);
-      if(id_1==id_2) {
-        string info = it2->second;
-	string str_newline = "\n";
-	erase_substr(info, str_newline);
-	//set the optional weights
-	optionalWeights[info] = it->second;
-      }
-    }
+    //find the scale id in the scale information and add this information
+    typedef multimap<string,string>::const_iterator InfoIt;
+    pair<InfoIt,InfoIt> range = scaleInfo.equal_range(id_1);
+    for ( InfoIt it2 = range.first; it2 != range.second; ++it2 )
+      optionalWeights[it2->second] = it->second;
   }
   /* additionally, we set the "central" scale
    * this is actually the default event weight 
@@ -865,6 +896,14 @@ void LesHouchesFileReader::close() {
   cfile.close();
 }
 
+string LesHouchesFileReader::sourceKey() const {
+  struct stat st;
+  if ( ::stat(filename().c_str(), &st) != 0 ) return "";
+  ostringstream os;
+  os << filename() << ' ' << st.st_size << ' ' << st.st_mtime;
+  return os.str();
+}
+
 void LesHouchesFileReader::persistentOutput(PersistentOStream & os) const {
   os << neve << LHFVersion << outsideBlock << headerBlock << initComments
      << initAttributes << eventComments << eventAttributes << theFileName
@@ -894,8 +933,10 @@ void LesHouchesFileReader::Init() {
     ("FileName",
      "The name of a file containing events conforming to the Les Houches "
      "protocol to be read into ThePEG. A file name ending in "
-     "<code>.gz</code> will be read from a pipe which uses "
-     "<code>zcat</code>. If a file name ends in <code>|</code> the "
+     "<code>.gz</code>, <code>.bz2</code>, <code>.xz</code> or "
+     "<code>.zst</code> will be decompressed while reading, either "
+     "directly or through a pipe using the corresponding command line "
+     "tool. If a file name ends in <code>|</code> the "
      "preceeding string is interpreted as a command, the output of which "
      "will be read through a pipe.",
      &LesHouchesFileReader::theFileName, "", false, false);
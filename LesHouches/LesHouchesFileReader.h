@@ -168,6 +168,11 @@ protected:
   virtual bool preInitialize() const;
   //@
 
+  /**
+   * Return the name, size and modification time of the event file.
+   */
+  virtual string sourceKey() const;
+
 protected:
 
   /**
@@ -259,6 +264,12 @@ private:
    */
   map<string,string> scalemap;
 
+  /**
+   * The information in scalemap indexed by the weight id stripped of
+   * quotes, as needed when reading the weights of each event.
+   */
+  multimap<string,string> scaleInfo;
+
   /**
    * Temporary holder for optional weights
    */
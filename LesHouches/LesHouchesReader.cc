@@ -29,20 +29,550 @@
 #include "ThePEG/Handlers/XComb.h"
 #include "ThePEG/Handlers/CascadeHandler.h"
 #include "LesHouchesEventHandler.h"
+#include "ThePEG/Repository/BaseRepository.h"
 #include "ThePEG/Utilities/Throw.h"
 #include "ThePEG/Utilities/HoldFlag.h"
 #include "ThePEG/Utilities/Debug.h"
 #include "ThePEG/Helicity/WaveFunction/SpinorWaveFunction.h"
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
 
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * The results of LesHouchesReader::scan(), which may be saved to
+ * avoid scanning the same events again.
+ */
+struct ScanSummary {
+
+  /** The default constructor. */
+  ScanSummary(): neve(0), cuteve(0), oldsum(0.0), negw(false) {}
+
+  /** Return the index of process \a id, adding it if not found. */
+  int index(int id) {
+    vector<int>::iterator idit = find(lprup.begin(), lprup.end(), id);
+    if ( idit != lprup.end() ) return idit - lprup.begin();
+    lprup.push_back(id);
+    newmax.push_back(0.0);
+    neweve.push_back(0);
+    oldeve.push_back(0);
+    sumlprup.push_back(0.);
+    sumsqlprup.push_back(0.);
+    return lprup.size() - 1;
+  }
+
+  /** Write the results to a single line of text. */
+  string str() const {
+    ostringstream os;
+    os.precision(17);
+    os << neve << ' ' << cuteve << ' ' << oldsum << ' ' << negw
+       << ' ' << lprup.size();
+    for ( int id = 0, N = lprup.size(); id < N; ++id )
+      os << ' ' << lprup[id] << ' ' << oldeve[id] << ' ' << neweve[id]
+         << ' ' << sumlprup[id] << ' ' << sumsqlprup[id]
+         << ' ' << newmax[id];
+    return os.str();
+  }
+
+  /** Read results written with str(). Return false if it failed. */
+  bool read(string line) {
+    istringstream is(line);
+    size_t nproc = 0;
+    is >> neve >> cuteve >> oldsum >> negw >> nproc;
+    for ( size_t i = 0; is && i < nproc; ++i ) {
+      int id = 0;
+      is >> id;
+      id = index(id);
+      is >> oldeve[id] >> neweve[id] >> sumlprup[id] >> sumsqlprup[id]
+         >> newmax[id];
+    }
+    return bool(is);
+  }
+
+  /** The number of events scanned. */
+  long neve;
+  /** The number of events scanned which got zero weight. */
+  long cuteve;
+  /** The sum of the original weights of the events scanned. */
+  double oldsum;
+  /** True if any event got negative weight. */
+  bool negw;
+  /** The process numbers found. */
+  vector<int> lprup;
+  /** The maximum weight of the events for each process. */
+  vector<double> newmax;
+  /** The number of events scanned for each process. */
+  vector<long> oldeve;
+  /** The number of events with non-zero weight for each process. */
+  vector<long> neweve;
+  /** The sum of the original weights for each process. */
+  vector<double> sumlprup;
+  /** The sum of the squared original weights for each process. */
+  vector<double> sumsqlprup;
+};
+
+/**
+ * The first line of a scan summary file.
+ */
+const string scanSummaryHeader = "ThePEG LesHouchesReader scan summary 1";
+
+/**
+ * Read the scan summary file \a filename into \a summary, provided
+ * it was written with the given \a key.
+ */
+bool readScanSummary(string filename, string key, ScanSummary & summary) {
+  ifstream is(filename.c_str());
+  string line;
+  if ( !getline(is, line) || line != scanSummaryHeader ||
+       !getline(is, line) || line != key ||
+       !getline(is, line) ) return false;
+  return summary.read(line);
+}
+
+/**
+ * Write \a summary to the scan summary file \a filename together with
+ * the given \a key. The file is first written under a temporary name
+ * and then renamed, so that jobs running at the same time never see
+ * a partially written file.
+ */
+bool writeScanSummary(string filename, string key,
+                      const ScanSummary & summary) {
+  ostringstream tmpname;
+  tmpname << filename << "." << getpid() << "."
+          << std::hash<std::thread::id>()(std::this_thread::get_id());
+  string tmp = tmpname.str();
+  {
+    ofstream os(tmp.c_str());
+    os << scanSummaryHeader << '\n' << key << '\n' << summary.str() << '\n';
+    if ( !os ) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+  if ( std::rename(tmp.c_str(), filename.c_str()) == 0 ) return true;
+  std::remove(tmp.c_str());
+  return false;
+}
+
+}
+
+/**
+ * A pool of threads reading events ahead for several Prefetcher
+ * objects. Each thread picks a Prefetcher with a buffer which is at
+ * least half empty and fills it, so that a slow source only occupies
+ * one of the threads.
+ */
+struct LesHouchesReader::PrefetchPool {
+
+  /**
+   * Return the pool used by all readers. The pool is never deleted,
+   * since Prefetcher objects may be destroyed after static objects
+   * at the end of the program.
+   */
+  static PrefetchPool & instance() {
+    static PrefetchPool * pool = new PrefetchPool;
+    return *pool;
+  }
+
+  /** The constructor does not start any threads. */
+  PrefetchPool(): users(0), stopping(false), next(0) {}
+
+  /**
+   * Register a new user of the pool and make sure there are at least
+   * \a n threads.
+   */
+  void resize(int n) {
+    std::lock_guard<std::mutex> control(controlMutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++users;
+    while ( int(threads.size()) < n )
+      threads.push_back(std::thread(&PrefetchPool::run, this));
+  }
+
+  /**
+   * Unregister a user of the pool. When there are no users left the
+   * threads are stopped and joined, after having finished filling
+   * the buffers they are currently working on.
+   */
+  void release();
+
+  /**
+   * Return true if there are any threads in the pool.
+   */
+  bool active() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !threads.empty() && !stopping;
+  }
+
+  /**
+   * Start filling the buffer of the Prefetcher \a p.
+   */
+  void add(Prefetcher * p) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      prefetchers.push_back(p);
+    }
+    work.notify_one();
+  }
+
+  /**
+   * Stop filling the buffer of the Prefetcher \a p, waiting for any
+   * thread currently reading for it to finish.
+   */
+  void remove(Prefetcher * p);
+
+  /**
+   * Tell the threads that a buffer may need to be filled.
+   */
+  void notify() {
+    // Taking the lock ensures that a thread which has just found
+    // nothing to do is waiting before it is notified.
+    { std::lock_guard<std::mutex> lock(mutex); }
+    work.notify_one();
+  }
+
+  /**
+   * Return a Prefetcher which needs to be filled, or null if there
+   * is none. Must be called with the lock held.
+   */
+  Prefetcher * select();
+
+  /**
+   * The function run by each thread.
+   */
+  void run();
+
+  /** The Prefetcher objects served by this pool. */
+  vector<Prefetcher*> prefetchers;
+
+  /** The threads in the pool. */
+  vector<std::thread> threads;
+
+  /** The number of users which have called resize() but not release(). */
+  int users;
+
+  /** Set to true to stop the threads. */
+  bool stopping;
+
+  /** Where to start looking for a Prefetcher to fill. */
+  std::size_t next;
+
+  /** Protects all members and the busy flags of the Prefetchers. */
+  std::mutex mutex;
+
+  /** Serializes resize() and release(). */
+  std::mutex controlMutex;
+
+  /** Signalled when there may be a buffer to fill. */
+  std::condition_variable work;
+
+  /** Signalled when a thread has finished filling a buffer. */
+  std::condition_variable done;
+
+};
+
+/**
+ * Reads events ahead on a separate thread using a copy of a
+ * LesHouchesReader, keeping them in a ring buffer until they are
+ * requested. The thread is either owned by the Prefetcher or taken
+ * from the PrefetchPool.
+ */
+struct LesHouchesReader::Prefetcher {
+
+  /**
+   * The information read for one event.
+   */
+  struct Record {
+    /** Default constructor. */
+    Record(): ok(false), npLO(0), npNLO(0), eventnum(0) {}
+    /** False if no event could be read. */
+    bool ok;
+    /** The exception thrown when reading, if any. */
+    std::exception_ptr error;
+    /** The HEPEUP block. */
+    HEPEUP hepeup;
+    /** The optional weights. */
+    map<string,double> optionalWeights;
+    /** The FxFx multiplicities. */
+    int npLO, npNLO;
+    /** The event number given in the file. */
+    long eventnum;
+  };
+
+  /**
+   * Create a copy of the given reader, open it and start reading up
+   * to \a size events ahead.
+   */
+  Prefetcher(const LesHouchesReader & r, int size)
+    : ring(size), first(0), nready(0), stopped(false), finished(false),
+      pool(0), busy(false) {
+    reader = dynamic_ptr_cast<Ptr<LesHouchesReader>::pointer>(r.clone());
+    reader->open();
+    if ( PrefetchPool::instance().active() ) {
+      pool = &PrefetchPool::instance();
+      pool->add(this);
+    } else
+      thread = std::thread(&Prefetcher::run, this);
+  }
+
+  /**
+   * Stop the thread and close the copied reader.
+   */
+  ~Prefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopped = true;
+    }
+    if ( pool ) pool->remove(this);
+    else {
+      notFull.notify_all();
+      thread.join();
+    }
+    reader->close();
+  }
+
+  /**
+   * Read the next event into \a rec. Return false if the end of the
+   * source was reached.
+   */
+  bool read(Record & rec) {
+    rec.error = std::exception_ptr();
+    try {
+      rec.ok = reader->doReadEvent();
+    }
+    catch ( ... ) {
+      rec.ok = false;
+      rec.error = std::current_exception();
+    }
+    if ( rec.ok ) {
+      std::swap(rec.hepeup, reader->hepeup);
+      rec.optionalWeights.swap(reader->optionalWeights);
+      rec.npLO = reader->optionalnpLO;
+      rec.npNLO = reader->optionalnpNLO;
+      rec.eventnum = reader->LHEeventnum;
+    }
+    return rec.ok || rec.error;
+  }
+
+  /**
+   * Read events into the ring buffer until the end of the source is
+   * reached or the prefetcher is stopped.
+   */
+  void run() {
+    while ( true ) {
+      std::size_t ifill;
+      {
+	std::unique_lock<std::mutex> lock(mutex);
+	notFull.wait(lock, [this]{ return stopped || nready < ring.size(); });
+	if ( stopped ) return;
+	ifill = ( first + nready )%ring.size();
+      }
+      // This slot is not visible to the consumer until nready is
+      // increased, so it can be filled without holding the lock.
+      if ( !push(ifill) ) return;
+    }
+  }
+
+  /**
+   * Read events into the ring buffer until it is full, the end of the
+   * source is reached or the prefetcher is stopped. Used by the
+   * threads in the PrefetchPool.
+   */
+  void fill() {
+    while ( true ) {
+      std::size_t ifill;
+      {
+	std::lock_guard<std::mutex> lock(mutex);
+	if ( stopped || finished || nready == ring.size() ) return;
+	ifill = ( first + nready )%ring.size();
+      }
+      if ( !push(ifill) ) return;
+    }
+  }
+
+  /**
+   * Read an event into slot \a ifill of the ring buffer and make it
+   * visible to the consumer. Return false if the end of the source
+   * was reached.
+   */
+  bool push(std::size_t ifill) {
+    bool last = !read(ring[ifill]);
+    bool wake = last;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // If the consumer is waiting, reading is the bottleneck and we
+      // wake it up only when the buffer is half full.
+      if ( ++nready == ( ring.size() + 1 )/2 ) wake = true;
+      if ( last ) finished = true;
+    }
+    if ( wake ) notEmpty.notify_one();
+    return !last;
+  }
+
+  /**
+   * Return true if there is an event (or the end of the source) in
+   * the buffer.
+   */
+  bool ready() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nready > 0;
+  }
+
+  /**
+   * Return true if the buffer is at least half empty and should be
+   * filled by a thread in the PrefetchPool.
+   */
+  bool needsFilling() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !stopped && !finished && nready <= ring.size()/2;
+  }
+
+  /**
+   * Transfer the next event to \a r. Returns false if the end of the
+   * source was reached. Exceptions thrown when reading the event are
+   * rethrown here.
+   */
+  bool pop(LesHouchesReader & r) {
+    std::size_t iread;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      notEmpty.wait(lock, [this]{ return nready > 0; });
+      iread = first;
+    }
+    Record & rec = ring[iread];
+    // The end of the source stays in the buffer so that subsequent
+    // calls also return false.
+    if ( !rec.ok && !rec.error ) return false;
+    std::exception_ptr error = rec.error;
+    if ( rec.ok ) {
+      std::swap(r.hepeup, rec.hepeup);
+      r.optionalWeights.swap(rec.optionalWeights);
+      r.optionalnpLO = rec.npLO;
+      r.optionalnpNLO = rec.npNLO;
+      r.LHEeventnum = rec.eventnum;
+    }
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      first = ( first + 1 )%ring.size();
+      // Only wake up the reading thread when the buffer is half
+      // empty, to avoid switching threads for every event.
+      wake = ( --nready == ring.size()/2 );
+    }
+    if ( wake ) {
+      if ( pool ) pool->notify();
+      else notFull.notify_one();
+    }
+    if ( error ) std::rethrow_exception(error);
+    return true;
+  }
+
+  /** The copy of the reader used on the separate thread. */
+  Ptr<LesHouchesReader>::pointer reader;
+
+  /** The ring buffer of events. */
+  vector<Record> ring;
+
+  /** The index of the next event to be returned. */
+  std::size_t first;
+
+  /** The number of events ready in the ring buffer. */
+  std::size_t nready;
+
+  /** Set to true to stop the thread. */
+  bool stopped;
+
+  /** Set to true when the end of the source has been read. */
+  bool finished;
+
+  /** Protects first, nready, stopped and finished. */
+  std::mutex mutex;
+
+  /** Signalled when the buffer has become half empty. */
+  std::condition_variable notFull;
+
+  /** Signalled when the buffer has become half full. */
+  std::condition_variable notEmpty;
+
+  /** The thread reading events, unless a PrefetchPool is used. */
+  std::thread thread;
+
+  /** The PrefetchPool used, if any. */
+  PrefetchPool * pool;
+
+  /** True while a thread in the pool is filling the buffer. */
+  bool busy;
+
+};
+
+void LesHouchesReader::PrefetchPool::remove(Prefetcher * p) {
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [p]{ return !p->busy; });
+  prefetchers.erase(std::find(prefetchers.begin(), prefetchers.end(), p));
+}
+
+LesHouchesReader::Prefetcher * LesHouchesReader::PrefetchPool::select() {
+  // Go round the Prefetchers, starting after the one last selected,
+  // so that all sources get their turn.
+  for ( std::size_t i = 0, N = prefetchers.size(); i < N; ++i ) {
+    Prefetcher * p = prefetchers[( next + i )%N];
+    if ( !p->busy && p->needsFilling() ) {
+      next = ( next + i + 1 )%N;
+      return p;
+    }
+  }
+  return 0;
+}
+
+void LesHouchesReader::PrefetchPool::release() {
+  // Make sure no new threads are started until these are joined.
+  std::lock_guard<std::mutex> control(controlMutex);
+  vector<std::thread> stopped;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if ( users > 0 && --users > 0 ) return;
+    stopping = true;
+    stopped.swap(threads);
+  }
+  work.notify_all();
+  for ( int i = 0, N = stopped.size(); i < N; ++i ) stopped[i].join();
+  std::lock_guard<std::mutex> lock(mutex);
+  stopping = false;
+}
+
+void LesHouchesReader::PrefetchPool::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while ( true ) {
+    Prefetcher * p = 0;
+    work.wait(lock, [this, &p]{ return stopping || ( p = select() ) != 0; });
+    if ( !p ) return;
+    p->busy = true;
+    lock.unlock();
+    p->fill();
+    lock.lock();
+    p->busy = false;
+    done.notify_all();
+  }
+}
+
 LesHouchesReader::LesHouchesReader(bool active)
   : theNEvents(0), position(0), reopened(0), theMaxScan(-1), scanning(false),
     isActive(active), theCacheFileName(""), doCutEarly(true),
+    theCacheSlices(1), theCacheSlice(0), doReuseCacheFile(false),
+    theScanSummaryFileName(""),
     preweight(1.0), reweightPDF(false), doInitPDFs(false),
     theMaxMultCKKW(0), theMinMultCKKW(0), lastweight(1.0), maxFactor(1.0), optionalnpLO(0), optionalnpNLO(0),
     weightScale(1.0*picobarn), skipping(false), theMomentumTreatment(0),
-    useWeightWarnings(true),theReOpenAllowed(true), theIncludeSpin(true) {}
+    useWeightWarnings(true),theReOpenAllowed(true), theIncludeSpin(true),
+    thePrefetchEvents(0), thePrefetcher(0) {}
 
 LesHouchesReader::LesHouchesReader(const LesHouchesReader & x)
   : HandlerBase(x), LastXCombInfo<>(x), heprup(x.heprup), hepeup(x.hepeup),
@@ -55,6 +585,9 @@ LesHouchesReader::LesHouchesReader(const LesHouchesReader & x)
     theCacheFileName(x.theCacheFileName), doCutEarly(x.doCutEarly),
     stats(x.stats), statmap(x.statmap),
     thePartonBinInstances(x.thePartonBinInstances),
+    theCacheSlices(x.theCacheSlices), theCacheSlice(x.theCacheSlice),
+    doReuseCacheFile(x.doReuseCacheFile),
+    theScanSummaryFileName(x.theScanSummaryFileName),
     reweights(x.reweights), preweights(x.preweights),
     preweight(x.preweight), reweightPDF(x.reweightPDF),
     doInitPDFs(x.doInitPDFs),
@@ -65,17 +598,20 @@ LesHouchesReader::LesHouchesReader(const LesHouchesReader & x)
     theMomentumTreatment(x.theMomentumTreatment),
     useWeightWarnings(x.useWeightWarnings),
     theReOpenAllowed(x.theReOpenAllowed),
-    theIncludeSpin(x.theIncludeSpin) {}
+    theIncludeSpin(x.theIncludeSpin),
+    thePrefetchEvents(x.thePrefetchEvents), thePrefetcher(0) {}
 
-LesHouchesReader::~LesHouchesReader() {}
+LesHouchesReader::~LesHouchesReader() {
+  stopPrefetching();
+}
 
 void LesHouchesReader::doinitrun() {
   HandlerBase::doinitrun();
   stats.reset();
   for ( StatMap::iterator i = statmap.begin(); i != statmap.end(); ++i )
     i->second.reset();
+  stopPrefetching();
   open();
-  if ( cacheFileName().length() ) openReadCacheFile();
   position = 0;
   reopened = 0;
 }
@@ -88,6 +624,7 @@ bool LesHouchesReader::preInitialize() const {
 
 void LesHouchesReader::doinit() {
   HandlerBase::doinit();
+  stopPrefetching();
   open();
   close();
   if ( !heprup.IDBMUP.first || !heprup.IDBMUP.second )
@@ -210,6 +747,7 @@ void LesHouchesReader::initialize(LesHouchesEventHandler & eh) {
       << "LesHouchesEventHandler '" << eh.name() << "'.\nAt least one of them "
       << "needs to have a PartonExtractor object." << Exception::runerror;
   }
+  stopPrefetching();
   open();
 
   Energy emax = 2.0*sqrt(heprup.EBMUP.first*heprup.EBMUP.second)*GeV;
@@ -276,17 +814,78 @@ void LesHouchesReader::initialize(LesHouchesEventHandler & eh) {
 
 long LesHouchesReader::scan() {
 
+  stopPrefetching();
   open();
 
-  // Shall we write the events to a cache file for fast reading? If so
-  // we write to a temporary file if the caches events should be
-  // randomized.
-  if ( cacheFileName().length() ) openWriteCacheFile();
+  // The results of a previous scan of the same events may have been
+  // saved in a cache file or in a separate file, together with a key
+  // identifying the source of events and the setup used in the scan.
+  string key;
+  string source;
+  if ( cacheFileName().length() || scanSummaryFileName().length() ) {
+    source = sourceKey();
+    if ( source.empty() && scanSummaryFileName().length() )
+      Throw<LesHouchesInitError>()
+        << "LesHouchesReader '" << name() << "' cannot identify its source "
+        << "of events and will not use the scan summary file '"
+        << scanSummaryFileName() << "'." << Exception::warning;
+    // The weights and cuts of the scanned events depend on the setup
+    // of the cuts and reweight objects, so their interface values are
+    // hashed into the key.
+    ObjectSet objs;
+    BaseRepository::addReferences(theCuts, objs);
+    for ( int i = 0, N = reweights.size(); i < N; ++i )
+      BaseRepository::addReferences(reweights[i], objs);
+    for ( int i = 0, N = preweights.size(); i < N; ++i )
+      BaseRepository::addReferences(preweights[i], objs);
+    vector<string> skipped;
+    string setup = BaseRepository::setupKey(objs, set<string>(), skipped);
+    if ( !skipped.empty() ) {
+      ostringstream ss;
+      for ( int i = 0, N = skipped.size(); i < N; ++i )
+        ss << " " << skipped[i];
+      Throw<LesHouchesInitError>()
+        << "LesHouchesReader '" << name() << "' could not get the values "
+        << "of the following interfaces, which are therefore not "
+        << "included in the key of the scan summary:" << ss.str()
+        << Exception::warning;
+    }
+    ostringstream os;
+    os << source << " MaxScan=" << maxScan() << " CutEarly=" << cutEarly()
+       << " Cuts=" << ( theCuts? theCuts->fullName(): string() )
+       << " Reweights=" << reweights.size()
+       << " Preweights=" << preweights.size()
+       << " Setup=" << setup;
+    key = os.str();
+  }
+
+  // Shall we write the events to a cache file for fast reading? If
+  // an existing cache file should be reused, the results of the scan
+  // are instead taken from its index, provided it was written with
+  // the same key.
+  string cacheSummary;
+  if ( cacheFileName().length() && reuseCacheFile() &&
+       cacheFile().openRead(cacheFileName()) ) {
+    const string & info = cacheFile().info();
+    string::size_type nl = info.find('\n');
+    if ( nl != string::npos && info.substr(0, nl) == key )
+      cacheSummary = info.substr(nl + 1);
+    else {
+      Throw<LesHouchesInitError>()
+        << "The cache file '" << cacheFileName() << "' cannot be reused by "
+        << "LesHouchesReader '" << name() << "' since it was written for a "
+        << "different source of events or setup. It will be written again."
+        << Exception::warning;
+      closeCacheFile();
+    }
+  }
+  if ( cacheFileName().length() && !cacheFile() ) openWriteCacheFile();
 
   // Keep track of the number of events scanned.
-  long neve = 0;
-  long cuteve = 0;
-  bool negw = false;
+  ScanSummary summary;
+  long & neve = summary.neve;
+  long & cuteve = summary.cuteve;
+  bool & negw = summary.negw;
 
   // If the open() has not already gotten information about subprocesses
   // and cross sections we have to scan through the events.
@@ -294,50 +893,64 @@ long LesHouchesReader::scan() {
 
     HoldFlag<> isScanning(scanning);
 
-    double oldsum = 0.0;
-    vector<int> lprup;
-    vector<double> newmax;
-    vector<long> oldeve;
-    vector<long> neweve;
-    vector<double> sumlprup;
-    vector<double> sumsqlprup;
-    vector<long> nscanned;
-    for ( int i = 0; ( maxScan() < 0 || i < maxScan() ) && readEvent(); ++i ) {
-      if ( !checkPartonBin() ) Throw<LesHouchesInitError>()
-        << "Found event in LesHouchesReader '" << name()
-        << "' which cannot be handeled by the assigned PartonExtractor '"
-        << partonExtractor()->name() << "'." << Exception::runerror;
-      vector<int>::iterator idit =
-        find(lprup.begin(), lprup.end(), hepeup.IDPRUP);
-      int id = lprup.size();
-      if ( idit == lprup.end() ) {
-        lprup.push_back(hepeup.IDPRUP);
-        newmax.push_back(0.0);
-        neweve.push_back(0);
-        oldeve.push_back(0);
-        sumlprup.push_back(0.);
-        sumsqlprup.push_back(0.);
-        nscanned.push_back(0);
-      } else {
-        id = idit - lprup.begin();
-      }
-      ++neve;
-      ++oldeve[id];
-      oldsum += hepeup.XWGTUP;
-      sumlprup[id] += hepeup.XWGTUP;
-      sumsqlprup[id] += sqr(hepeup.XWGTUP);
-      ++nscanned[id];
-      if ( cacheFile() ) {
-        if ( eventWeight() == 0.0 ) {
-          ++cuteve;
-          continue;
+    double & oldsum = summary.oldsum;
+    vector<int> & lprup = summary.lprup;
+    vector<double> & newmax = summary.newmax;
+    vector<long> & oldeve = summary.oldeve;
+    vector<long> & neweve = summary.neweve;
+    vector<double> & sumlprup = summary.sumlprup;
+    vector<double> & sumsqlprup = summary.sumsqlprup;
+
+    bool restored = false;
+    if ( cacheFile() && !cacheFile().writing() ) {
+      if ( !summary.read(cacheSummary) ) throw LesHouchesInitError()
+        << "The cache file '" << cacheFileName() << "' reused by "
+        << "LesHouchesReader '" << name() << "' does not contain the "
+        << "results of a previous scan." << Exception::runerror;
+      restored = true;
+    }
+    else if ( !cacheFile() && source.length() &&
+              scanSummaryFileName().length() )
+      restored = readScanSummary(scanSummaryFileName(), key, summary);
+
+    if ( !restored ) {
+      for ( int i = 0; ( maxScan() < 0 || i < maxScan() ) && readEvent();
+            ++i ) {
+        if ( !checkPartonBin() ) Throw<LesHouchesInitError>()
+          << "Found event in LesHouchesReader '" << name()
+          << "' which cannot be handeled by the assigned PartonExtractor '"
+          << partonExtractor()->name() << "'." << Exception::runerror;
+        int id = summary.index(hepeup.IDPRUP);
+        ++neve;
+        ++oldeve[id];
+        oldsum += hepeup.XWGTUP;
+        sumlprup[id] += hepeup.XWGTUP;
+        sumsqlprup[id] += sqr(hepeup.XWGTUP);
+        if ( cacheFile() ) {
+          if ( eventWeight() == 0.0 ) {
+            ++cuteve;
+            continue;
+          }
+          cacheEvent();
         }
-        cacheEvent();
-      }
-      ++neweve[id];
-      newmax[id] = max(newmax[id], abs(eventWeight()));
-      if ( eventWeight() < 0.0 ) negw = true;
-    } //end of scanning events
+        ++neweve[id];
+        newmax[id] = max(newmax[id], abs(eventWeight()));
+        if ( eventWeight() < 0.0 ) negw = true;
+      } //end of scanning events
+    }
+
+    // Save the results of the scan so that the events need not be
+    // scanned again.
+    if ( cacheFile().writing() )
+      cacheFile().info(key + '\n' + summary.str());
+    if ( !restored && source.length() && scanSummaryFileName().length() &&
+         generator()->writesSharedFiles() &&
+         !writeScanSummary(scanSummaryFileName(), key, summary) )
+      Throw<LesHouchesInitError>()
+        << "LesHouchesReader '" << name() << "' could not write the scan "
+        << "summary file '" << scanSummaryFileName() << "'."
+        << Exception::warning;
+
     xSecWeights.resize(oldeve.size(), 1.0);
     for ( int i = 0, N = oldeve.size(); i < N; ++i )
       if ( oldeve[i] ) xSecWeights[i] = double(neweve[i])/double(oldeve[i]);
@@ -347,7 +960,7 @@ long LesHouchesReader::scan() {
     if ( lprup.size() == heprup.LPRUP.size() ) {
       for ( int id = 0, N = lprup.size(); id < N; ++id ) {
         vector<int>::iterator idit =
-          find(heprup.LPRUP.begin(), heprup.LPRUP.end(), hepeup.IDPRUP);
+          find(heprup.LPRUP.begin(), heprup.LPRUP.end(), lprup[id]);
         if ( idit == heprup.LPRUP.end() ) {
           Throw<LesHouchesInitError>()
             << "When scanning events, the LesHouschesReader '" << name()
@@ -378,10 +991,10 @@ long LesHouchesReader::scan() {
       else {
 	for ( int id = 0; id < heprup.NPRUP; ++id )  {
 	  //set the cross section directly from the event weights read
-	  heprup.XSECUP[id] = sumlprup[id]/nscanned[id];
-	  heprup.XERRUP[id] = (sumsqlprup[id]/nscanned[id] - sqr(sumlprup[id]/nscanned[id])) / nscanned[id];
+	  heprup.XSECUP[id] = sumlprup[id]/oldeve[id];
+	  heprup.XERRUP[id] = (sumsqlprup[id]/oldeve[id] - sqr(sumlprup[id]/oldeve[id])) / oldeve[id];
 	  if(heprup.XERRUP[id] < 0.) {
-	    if( heprup.XERRUP[id]/(sumsqlprup[id]/nscanned[id])>-1e-10)
+	    if( heprup.XERRUP[id]/(sumsqlprup[id]/oldeve[id])>-1e-10)
 	      heprup.XERRUP[id] = 0.;
 	    else {
 	      Throw<LesHouchesInitError>()
@@ -403,6 +1016,11 @@ long LesHouchesReader::scan() {
 
   if ( negw ) heprup.IDWTUP = min(-abs(heprup.IDWTUP), -1);
 
+  // When initializing for a run, the events are then read from the
+  // cache file.
+  if ( cacheFileName().length() && state() == InterfacedBase::runready )
+    openReadCacheFile();
+
   return neve;
 
 }
@@ -483,7 +1101,8 @@ void LesHouchesReader::reopen() {
   double frac = double(stats.attempts())/double(NEvents());
   if ( frac*double(reopened + 1)/double(reopened) > 1.0 &&
     NEvents() - stats.attempts() <
-       generator()->N() - generator()->currentEventNumber() ) {
+       ( generator()->N() - generator()->currentEventNumber() )/
+       generator()->eventStride() ) {
     if(theReOpenAllowed)
       generator()->logWarning(LesHouchesReopenWarning()
                               << "Reopening LesHouchesReader '" << name()
@@ -496,12 +1115,13 @@ void LesHouchesReader::reopen() {
         << name() << Exception::runerror;
   }
   if ( cacheFile() ) {
-    closeCacheFile();
-    openReadCacheFile();
+    cacheFile().seek(cacheRange(cacheFile().size()).first);
+    position = 0;
     if ( !uncacheEvent() ) Throw<LesHouchesReopenError>()
       << "Could not reopen LesHouchesReader '" << name()
       << "'." << Exception::runerror;
   } else {
+    stopPrefetching();
     close();
     open();
     if ( !readEvent() ) Throw<LesHouchesReopenError>()
@@ -521,7 +1141,8 @@ bool LesHouchesReader::readEvent() {
 
   reset();
 
-  if ( !doReadEvent() ) return false;
+  if ( !( thePrefetchEvents > 0? readPrefetched(): doReadEvent() ) )
+    return false;
 
   // If we are just skipping event we do not need to reweight or do
   // anything fancy.
@@ -581,6 +1202,31 @@ bool LesHouchesReader::readEvent() {
   return true;
 }
 
+bool LesHouchesReader::readPrefetched() {
+  if ( !thePrefetcher ) thePrefetcher = new Prefetcher(*this, thePrefetchEvents);
+  return thePrefetcher->pop(*this);
+}
+
+void LesHouchesReader::stopPrefetching() {
+  delete thePrefetcher;
+  thePrefetcher = 0;
+}
+
+bool LesHouchesReader::eventReady() {
+  if ( thePrefetchEvents <= 0 || ( cacheFile() && !cacheFile().writing() ) )
+    return true;
+  if ( !thePrefetcher ) thePrefetcher = new Prefetcher(*this, thePrefetchEvents);
+  return thePrefetcher->ready();
+}
+
+void LesHouchesReader::prefetchThreads(int n) {
+  PrefetchPool::instance().resize(n);
+}
+
+void LesHouchesReader::releasePrefetchThreads() {
+  PrefetchPool::instance().release();
+}
+
 double LesHouchesReader::getEvent() {
   if ( cacheFile() ) {
     if ( !uncacheEvent() ) reopen();
@@ -600,6 +1246,22 @@ double LesHouchesReader::getEvent() {
 
 void LesHouchesReader::skip(long n) {
   HoldFlag<> skipflag(skipping);
+  if ( cacheFile() && !cacheFile().writing() ) {
+    // Find the event to skip to directly, going through the slice of
+    // the cache file once for each time getEvent() would have needed
+    // to reopen it.
+    pair<long,long> range = cacheRange(cacheFile().size());
+    long len = range.second - range.first;
+    if ( len > 0 && n > 0 ) {
+      long next = cacheFile().tell() - range.first + n;
+      long nreopen = (next - 1)/len;
+      for ( long i = 0; i < nreopen; ++i ) reopen();
+      next -= nreopen*len;
+      cacheFile().seek(range.first + next);
+      position = nreopen? next: position + n;
+      return;
+    }
+  }
   while ( n-- ) getEvent();
 }
 
@@ -1147,26 +1809,52 @@ void LesHouchesReader::connectMothers() {
   }
 }
 
+string LesHouchesReader::cacheFileName() const {
+  if ( theCacheFileName.empty() || !generator() ||
+       generator()->writesSharedFiles() ) return theCacheFileName;
+  ostringstream os;
+  os << theCacheFileName << "-thread" << generator()->workerIndex();
+  return os.str();
+}
+
 void LesHouchesReader::openReadCacheFile() {
   if ( cacheFile() ) closeCacheFile();
-  cacheFile().open(cacheFileName(), "r");
+  if ( !cacheFile().openRead(cacheFileName()) ) throw LesHouchesInitError()
+    << "LesHouchesReader '" << name() << "' could not read the cache file '"
+    << cacheFileName() << "'." << Exception::runerror;
+  pair<long,long> range = cacheRange(cacheFile().size());
+  cacheFile().seek(range.first);
+  NEvents(range.second - range.first);
   position = 0;
 }
 
 void LesHouchesReader::openWriteCacheFile() {
   if ( cacheFile() ) closeCacheFile();
-  cacheFile().open(cacheFileName(), "w");
+  if ( !cacheFile().openWrite(cacheFileName()) ) throw LesHouchesInitError()
+    << "LesHouchesReader '" << name() << "' could not open the cache file '"
+    << cacheFileName() << "' for writing." << Exception::runerror;
 }
 
 void LesHouchesReader::closeCacheFile() {
   cacheFile().close();
 }
 
+pair<long,long> LesHouchesReader::cacheRange(long n) const {
+  long slices = max(theCacheSlices, 1);
+  long slice = min(long(theCacheSlice), slices - 1);
+  return make_pair(n*slice/slices, n*(slice + 1)/slices);
+}
+
 void LesHouchesReader::cacheEvent() const {
-  static vector<char> buff;
-  cacheFile().write(&hepeup.NUP, sizeof(hepeup.NUP));
-  buff.resize(eventSize(hepeup.NUP));
+  static thread_local vector<char> buff;
+  size_t size = sizeof(hepeup.NUP) + eventSize(hepeup.NUP) +
+    sizeof(LHEeventnum) + 2*sizeof(int) + sizeof(size_t);
+  for ( map<string,double>::const_iterator it = optionalWeights.begin();
+        it != optionalWeights.end(); ++it )
+    size += sizeof(size_t) + it->first.size() + sizeof(double);
+  buff.resize(size);
   char * pos = &buff[0];
+  pos = mwrite(pos, hepeup.NUP);
   pos = mwrite(pos, hepeup.IDPRUP);
   pos = mwrite(pos, hepeup.XWGTUP);
   pos = mwrite(pos, hepeup.XPDWUP);
@@ -1182,25 +1870,31 @@ void LesHouchesReader::cacheEvent() const {
   pos = mwrite(pos, hepeup.VTIMUP[0], hepeup.NUP);
   pos = mwrite(pos, hepeup.SPINUP[0], hepeup.NUP);
   pos = mwrite(pos, lastweight);
-  pos = mwrite(pos, optionalWeights);
+  pos = mwrite(pos, preweight);
   pos = mwrite(pos, LHEeventnum);
-  for(size_t ff = 0; ff < optionalWeightsNames.size(); ff++) {
-    pos = mwrite(pos, optionalWeightsNames[ff]);
-  }
   pos = mwrite(pos, optionalnpLO);
   pos = mwrite(pos, optionalnpNLO);
-  pos = mwrite(pos, preweight);
-  cacheFile().write(&buff[0], buff.size(), 1);
+  // The optional weights are stored as the length of the name, the
+  // name and the value.
+  pos = mwrite(pos, optionalWeights.size());
+  for ( map<string,double>::const_iterator it = optionalWeights.begin();
+        it != optionalWeights.end(); ++it ) {
+    pos = mwrite(pos, it->first.size());
+    std::memcpy(pos, it->first.data(), it->first.size());
+    pos += it->first.size();
+    pos = mwrite(pos, it->second);
+  }
+  cacheFile().write(&buff[0], buff.size(), hepeup.IDPRUP);
 }
 
 bool LesHouchesReader::uncacheEvent() {
   reset();
-  static vector<char> buff;
-  if ( cacheFile().read(&hepeup.NUP, sizeof(hepeup.NUP)) != 1 )
+  if ( cacheFile().tell() >= cacheRange(cacheFile().size()).second )
     return false;
-  buff.resize(eventSize(hepeup.NUP));
-  if ( cacheFile().read(&buff[0], buff.size()) != 1 ) return false;
-  const char * pos = &buff[0];
+  size_t size = 0;
+  const char * pos = cacheFile().read(size);
+  if ( !pos ) return false;
+  pos = mread(pos, hepeup.NUP);
   pos = mread(pos, hepeup.IDPRUP);
   pos = mread(pos, hepeup.XWGTUP);
   pos = mread(pos, hepeup.XPDWUP);
@@ -1223,14 +1917,19 @@ bool LesHouchesReader::uncacheEvent() {
   hepeup.SPINUP.resize(hepeup.NUP);
   pos = mread(pos, hepeup.SPINUP[0], hepeup.NUP);
   pos = mread(pos, lastweight);
-  pos = mread(pos, optionalWeights);
-  for(size_t ff = 0; ff < optionalWeightsNames.size(); ff++) {
-    pos = mread(pos, optionalWeightsNames[ff]);
-  }
-  pos = mread(pos, optionalnpLO);
-  pos = mread(pos, optionalnpNLO);
   pos = mread(pos, preweight);
   pos = mread(pos, LHEeventnum);
+  pos = mread(pos, optionalnpLO);
+  pos = mread(pos, optionalnpNLO);
+  size_t nopt = 0;
+  pos = mread(pos, nopt);
+  optionalWeights.clear();
+  for ( size_t i = 0; i < nopt; ++i ) {
+    size_t len = 0;
+    pos = mread(pos, len);
+    double & w = optionalWeights[string(pos, len)];
+    pos = mread(pos + len, w);
+  }
   // If we are skipping, we do not have to do anything else.
   if ( skipping ) return true;
 
@@ -1262,11 +1961,13 @@ void LesHouchesReader::persistentOutput(PersistentOStream & os) const {
      << theLastXComb << theMaxMultCKKW << theMinMultCKKW << lastweight << optionalWeights << optionalnpLO << optionalnpNLO << LHEeventnum
      << maxFactor << ounit(weightScale, picobarn) << xSecWeights << maxWeights
      << theMomentumTreatment << useWeightWarnings << theReOpenAllowed
-     << theIncludeSpin;
+     << theIncludeSpin << thePrefetchEvents << theCacheSlices << theCacheSlice
+     << doReuseCacheFile << theScanSummaryFileName;
 }
 
 void LesHouchesReader::persistentInput(PersistentIStream & is, int) {
   if ( cacheFile() ) closeCacheFile();
+  stopPrefetching();
   is >> heprup.IDBMUP >> heprup.EBMUP >> heprup.PDFGUP >> heprup.PDFSUP
      >> heprup.IDWTUP >> heprup.NPRUP >> heprup.XSECUP >> heprup.XERRUP
      >> heprup.XMAXUP >> heprup.LPRUP >> hepeup.NUP >> hepeup.IDPRUP
@@ -1283,7 +1984,8 @@ void LesHouchesReader::persistentInput(PersistentIStream & is, int) {
      >> theLastXComb >> theMaxMultCKKW >> theMinMultCKKW >> lastweight >> optionalWeights >> optionalnpLO >> optionalnpNLO >> LHEeventnum
      >> maxFactor >> iunit(weightScale, picobarn) >> xSecWeights >> maxWeights
      >> theMomentumTreatment >> useWeightWarnings >> theReOpenAllowed
-     >> theIncludeSpin;
+     >> theIncludeSpin >> thePrefetchEvents >> theCacheSlices >> theCacheSlice
+     >> doReuseCacheFile >> theScanSummaryFileName;
 }
 
 AbstractClassDescription<LesHouchesReader>
@@ -1374,11 +2076,64 @@ void LesHouchesReader::Init() {
   static Parameter<LesHouchesReader,string> interfaceCacheFileName
     ("CacheFileName",
      "Name of file used to cache the events from the reader in a fast-readable "
-     "form. If empty, no cache file will be generated.",
+     "form. If empty, no cache file will be generated. In a multi-threaded "
+     "run, each thread but the first uses its own cache file, named with "
+     "<code>-thread</code> and the number of the thread appended.",
      &LesHouchesReader::theCacheFileName, "",
      true, false);
   interfaceCacheFileName.fileType();
 
+  static Parameter<LesHouchesReader,int> interfaceCacheSlices
+    ("CacheSlices",
+     "The number of equally large slices into which the events in the "
+     "cache file are divided. Independent runs may then read the same "
+     "cache file, each using a different slice as given by "
+     "<interface>CacheSlice</interface>.",
+     &LesHouchesReader::theCacheSlices, 1, 1, 0,
+     true, false, Interface::lowerlim);
+
+  static Parameter<LesHouchesReader,int> interfaceCacheSlice
+    ("CacheSlice",
+     "The slice of the cache file to be read by this reader, counting "
+     "from zero. See <interface>CacheSlices</interface>.",
+     &LesHouchesReader::theCacheSlice, 0, 0, 0,
+     true, false, Interface::lowerlim);
+
+  static Switch<LesHouchesReader,bool> interfaceReuseCacheFile
+    ("ReuseCacheFile",
+     "Determines whether an existing cache file should be reused, "
+     "rather than scanning the events again and writing a new cache "
+     "file in the initialization. The existing file is only reused if "
+     "it was written for the same source of events and with the same "
+     "settings of the cuts and reweight objects, otherwise it is "
+     "written again.",
+     &LesHouchesReader::doReuseCacheFile, false, true, false);
+  static SwitchOption interfaceReuseCacheFileYes
+    (interfaceReuseCacheFile,
+     "Yes",
+     "Reuse the cache file if it exists.",
+     true);
+  static SwitchOption interfaceReuseCacheFileNo
+    (interfaceReuseCacheFile,
+     "No",
+     "Always write a new cache file.",
+     false);
+
+  static Parameter<LesHouchesReader,string> interfaceScanSummaryFileName
+    ("ScanSummaryFileName",
+     "Name of a file where the cross sections and maximum weights found "
+     "when scanning the events in the initialization are saved. If the "
+     "file exists and was written for the same event file (with the same "
+     "size and modification time) and the same settings, the saved "
+     "results are used instead of scanning the events again. If empty, "
+     "no such file is used. Note that changes in the parameters of the "
+     "<interface>Cuts</interface> or of the reweighting objects are not "
+     "detected, so the file must then be removed by hand. In a "
+     "multi-threaded run, the file is only written by the first thread.",
+     &LesHouchesReader::theScanSummaryFileName, "",
+     true, false);
+  interfaceScanSummaryFileName.fileType();
+
   static Switch<LesHouchesReader,bool> interfaceCutEarly
     ("CutEarly",
      "Determines whether to apply cuts to events before converting to "
@@ -1544,6 +2299,19 @@ void LesHouchesReader::Init() {
      "Don't use the spin information",
      false);
 
+  static Parameter<LesHouchesReader,int> interfacePrefetchEvents
+    ("PrefetchEvents",
+     "If larger than zero, the number of events to read ahead on a "
+     "separate thread, so that reading and decompressing events is done "
+     "in parallel with the processing of the previous events. The "
+     "reader is then copied and the event source is opened a second time, "
+     "which means that this should only be used when reading from files. "
+     "Information specific to a sub-class, such as the XML attributes of "
+     "the event tag in a Les Houches event file, is not available when "
+     "prefetching.",
+     &LesHouchesReader::thePrefetchEvents, 0, 0, 0,
+     true, false, Interface::lowerlim);
+
 
 
   interfaceCuts.rank(8);
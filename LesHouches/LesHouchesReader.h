@@ -20,7 +20,7 @@
 #include "ThePEG/MatrixElement/ReweightBase.h"
 #include "LesHouchesEventHandler.fh"
 #include "LesHouchesReader.fh"
-#include "ThePEG/Utilities/CFile.h"
+#include "LesHouchesCache.h"
 #include <cstdio>
 #include <cstring>
 
@@ -69,6 +69,17 @@ namespace ThePEG {
  * multiply the weight according to its return value (typically done
  * in the readEvent() function).
  *
+ * Optionally events may be read ahead on a separate thread (see the
+ * PrefetchEvents interface). A copy of the reader is then created
+ * with clone(), opened, and its doReadEvent() is called on the
+ * separate thread. The HEPEUP block, the optional weights and event
+ * numbers are transferred to this object through a ring buffer. Any
+ * additional information a sub-class reads for each event is not
+ * transferred. Since the source is opened twice, prefetching should
+ * only be used when reading from files. When many readers prefetch
+ * events, they may instead share a common pool of threads (see
+ * prefetchThreads()).
+ *
  * @see \ref LesHouchesReaderInterfaces "The interfaces"
  * defined for LesHouchesReader.
  * @see Event
@@ -184,16 +195,43 @@ public:
   virtual double getEvent();
 
   /**
-   * Calls doReadEvent() and performs pre-defined reweightings. A
-   * sub-class overrides this function it must make sure that the
-   * corresponding reweightings are done.
+   * Return true if getEvent() can return an event without waiting
+   * for it to be read. Is always true unless events are prefetched
+   * (see the PrefetchEvents interface), in which case prefetching is
+   * started if it was not already.
+   */
+  bool eventReady();
+
+  /**
+   * Use a common pool of at least \a n threads to read ahead events
+   * for all readers which subsequently start prefetching events,
+   * instead of one separate thread for each reader. Each call must
+   * be matched by a call to releasePrefetchThreads().
+   */
+  static void prefetchThreads(int n);
+
+  /**
+   * Release the pool of threads requested by prefetchThreads(). When
+   * the last user has released the pool, the threads are stopped and
+   * joined. Readers still using the pool must have stopped
+   * prefetching before that.
+   */
+  static void releasePrefetchThreads();
+
+  /**
+   * Calls doReadEvent() (or gets the next prefetched event) and
+   * performs pre-defined reweightings. A sub-class overrides this
+   * function it must make sure that the corresponding reweightings
+   * are done.
    */
   virtual bool readEvent();
 
   /**
    * Skip \a n events. Used by LesHouchesEventHandler to make sure
    * that a file is scanned an even number of times in case the events
-   * are not ramdomly distributed in the file.
+   * are not ramdomly distributed in the file. If events are read from
+   * a cache file, the skip is done directly using the index of the
+   * cache.
    */
   virtual void skip(long n);
 
@@ -445,8 +483,11 @@ protected:
   /**
    * Name of file used to cache the events form the reader in a
    * fast-readable form. If empty, no cache file will be generated.
+   * In a multi-threaded run, only the first worker uses the given
+   * file, the others use their own files named with "-thread"
+   * followed by the index of the worker appended.
    */
-  string cacheFileName() const { return theCacheFileName; }
+  string cacheFileName() const;
 
   /**
    * Determines whether to apply cuts to events converting them to
@@ -455,9 +496,30 @@ protected:
   bool cutEarly() const { return doCutEarly; }
 
   /**
-   * File stream for the cache.
+   * If true, an existing cache file is read in the initialization
+   * instead of scanning the original event file.
    */
-  CFile cacheFile() const { return theCacheFile;}
+  bool reuseCacheFile() const { return doReuseCacheFile; }
+
+  /**
+   * The first and one-past-last event in the cache file to be used
+   * by this reader, if the cache file is divided into cacheSlices()
+   * slices and this reader uses slice number cacheSlice(), given that
+   * the cache file contains \a n events.
+   */
+  pair<long,long> cacheRange(long n) const;
+
+  /**
+   * The cache file.
+   */
+  LesHouchesCache & cacheFile() const { return theCacheFile;}
+
+  /**
+   * Name of file where the results of scan() are saved, to be reused
+   * the next time the same events are scanned. If empty, no such file
+   * is used.
+   */
+  string scanSummaryFileName() const { return theScanSummaryFileName; }
 
   /**
    * Open the cache file for reading.
@@ -480,7 +542,9 @@ protected:
   void cacheEvent() const;
 
   /**
-   * Read an event from the cache file. Return false if something went wrong.
+   * Read an event from the cache file. Return false if something went
+   * wrong or if the end of the slice of the cache file used by this
+   * reader was reached.
    */
   bool uncacheEvent();
 
@@ -545,6 +609,15 @@ protected:
    * Go through the mother indices and connect up the Particles.
    */
   virtual void connectMothers();
+
+  /**
+   * Return a string identifying the source of events in its current
+   * state, such as the name, size and modification time of an event
+   * file. Used to check that a scan summary file corresponds to the
+   * events to be read. If empty, as in this base class, no scan
+   * summary file is used.
+   */
+  virtual string sourceKey() const { return ""; }
   //@}
 
 public:
@@ -607,6 +680,7 @@ protected:
    * run has ended. Used eg. to write out statistics.
    */
   virtual void dofinish() {
+    stopPrefetching();
     close();
     HandlerBase::dofinish();
   }
@@ -778,9 +852,33 @@ protected:
   PVector theIntermediates;
 
   /**
-   * File stream for the cache.
+   * The cache file.
+   */
+  mutable LesHouchesCache theCacheFile;
+
+  /**
+   * The number of slices into which the cache file is divided, to be
+   * used by independent runs.
+   */
+  int theCacheSlices;
+
+  /**
+   * The slice of the cache file used by this reader.
+   */
+  int theCacheSlice;
+
+  /**
+   * If true, an existing cache file is read in the initialization
+   * instead of scanning the original event file.
+   */
+  bool doReuseCacheFile;
+
+  /**
+   * Name of file where the results of scan() are saved, to be reused
+   * the next time the same events are scanned. If empty, no such file
+   * is used.
    */
-  CFile theCacheFile;
+  string theScanSummaryFileName;
 
   /**
    * The reweight objects modifying the weights of this reader.
@@ -902,6 +1000,43 @@ protected:
    */
   bool theIncludeSpin;
 
+  /**
+   * The number of events to read ahead on a separate thread. If zero
+   * events are read on demand.
+   */
+  int thePrefetchEvents;
+
+private:
+
+  /**
+   * Helper class reading events on a separate thread.
+   */
+  struct Prefetcher;
+
+  /**
+   * Helper class with a pool of threads reading events for several
+   * Prefetcher objects.
+   */
+  struct PrefetchPool;
+
+  /**
+   * Return the next event from the prefetching thread, starting the
+   * thread if needed. Used by readEvent() instead of doReadEvent()
+   * if thePrefetchEvents is larger than zero.
+   */
+  bool readPrefetched();
+
+  /**
+   * Stop the prefetching thread, if any, discarding all events read
+   * ahead. Must be called whenever the event source is reopened.
+   */
+  void stopPrefetching();
+
+  /**
+   * The object reading events on a separate thread, if any.
+   */
+  Prefetcher * thePrefetcher;
+
 private:
 
   /** Access function for the interface. */
@@ -16,27 +16,162 @@
 #include "PersistentIStream.xh"
 #include "ThePEG/Utilities/DynamicLoader.h"
 #include "ThePEG/Utilities/Debug.h"
+#include "ThePEG/Utilities/HoldFlag.h"
+#include "config.h"
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace ThePEG {
 
+#ifdef HAVE_SYS_MMAN_H
+namespace {
+
+/**
+ * A read-only stream buffer giving direct access to a memory-mapped
+ * file, which allows objects in an indexed file to be read in any
+ * order without copying the file.
+ */
+class MappedFileBuf: public std::streambuf {
+
+public:
+
+  /**
+   * Map the given file. If this fails ok() will return false.
+   */
+  MappedFileBuf(string file): data(0), size(0) {
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if ( fd < 0 ) return;
+    struct stat st;
+    if ( ::fstat(fd, &st) == 0 && st.st_size > 0 ) {
+      void * p = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if ( p != MAP_FAILED ) {
+	data = static_cast<char *>(p);
+	size = st.st_size;
+	setg(data, data, data + size);
+      }
+    }
+    ::close(fd);
+  }
+
+  /**
+   * Unmap the file.
+   */
+  ~MappedFileBuf() {
+    if ( data ) ::munmap(data, size);
+  }
+
+  /**
+   * Return true if the file was successfully mapped.
+   */
+  bool ok() const { return data != 0; }
+
+protected:
+
+  /**
+   * Set the position relative to the beginning, the current position
+   * or the end of the file.
+   */
+  virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+			   std::ios_base::openmode) {
+    char * p = dir == std::ios_base::beg? eback():
+      dir == std::ios_base::cur? gptr(): egptr();
+    if ( off < eback() - p || off > egptr() - p ) return pos_type(off_type(-1));
+    setg(eback(), p + off, egptr());
+    return pos_type(gptr() - eback());
+  }
+
+  /**
+   * Set the position relative to the beginning of the file.
+   */
+  virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+private:
+
+  /** The mapped file. */
+  char * data;
+
+  /** The size of the mapped file. */
+  size_t size;
+
+};
+
+/**
+ * An input stream reading from a MappedFileBuf.
+ */
+class MappedFileStream: public std::istream {
+
+public:
+
+  /**
+   * Map the given file. If this fails the stream is put in a failed
+   * state.
+   */
+  MappedFileStream(string file): std::istream(0), buf(file) {
+    rdbuf(&buf);
+    if ( !buf.ok() ) setstate(std::ios::failbit);
+  }
+
+private:
+
+  /** The underlying buffer. */
+  MappedFileBuf buf;
+
+};
+
+}
+#endif
+
 PersistentIStream::PersistentIStream(string file) 
-  : theIStream(0), isPedantic(true), allocStream(true), badState(false) {
+  : theIStream(0), isPedantic(true), allocStream(true), badState(false),
+    isBinary(false), isIndexed(false), theObjectStart(0) {
 //    if ( file[0] == '|' )
 //      theIStream = new ipfstream(file.substr(1).c_str());
 //    else if ( file.substr(file.length()-3, file.length()) == ".gz" )
 //      theIStream = new ipfstream(string("gzip -d -c " + file).c_str());
 //    else
+#ifdef HAVE_SYS_MMAN_H
+  // Map the file directly in memory if possible, otherwise fall back
+  // to an ordinary ifstream.
+  theIStream = new MappedFileStream(file);
+  if ( !*theIStream ) {
+    delete theIStream;
+    theIStream = new ifstream(file.c_str());
+  }
+#else
     theIStream = new ifstream(file.c_str());
+#endif
   if ( theIStream ) {
     init();
   } else
     setBadState();
 }
 
+PersistentIStream::
+PersistentIStream(istream * is, const PersistentIStream & header)
+  : theIStream(is), isPedantic(header.isPedantic), allocStream(true),
+    badState(false), isBinary(header.isBinary), version(header.version),
+    subVersion(header.subVersion),
+    theGlobalLibraries(header.theGlobalLibraries), isIndexed(true),
+    theObjectStart(0) {}
+
 void PersistentIStream::init() {
   string tag;
   operator>>(tag);
-  if ( tag != "ThePEG version 1 Database" ) setBadState();
+  // The header tag is always written as text, and selects the format
+  // for the rest of the stream.
+  if ( tag.substr(0, 25) == "ThePEG version 1 Indexed " ) {
+    isIndexed = true;
+    tag = "ThePEG version 1 " + tag.substr(25);
+  }
+  if ( tag == "ThePEG version 1 Binary Database" ) isBinary = true;
+  else if ( tag != "ThePEG version 1 Database" ) setBadState();
   operator>>(version);
   operator>>(subVersion);
   if ( version > 0 || subVersion > 0 ) {
@@ -62,6 +197,62 @@ void PersistentIStream::init() {
     if ( !loaderror.empty() )
       loaderror = "\nerror message from dynamic loader:\n" + loaderror;
   }
+  if ( isIndexed && good() ) {
+    // The objects are read by a separate stream which owns the
+    // istream, so that it can be kept by the objects read. If the
+    // istream was given by the caller the rest of it is copied.
+    if ( !allocStream ) {
+      ostringstream rest;
+      rest << is().rdbuf();
+      theIStream = new istringstream(rest.str());
+    }
+    allocStream = false;
+    theObjectReader.reset(new PersistentIStream(theIStream, *this));
+    theObjectReader->theSelf = theObjectReader;
+    theObjectReader->readIndex();
+  }
+}
+
+void PersistentIStream::readIndex() {
+  // The trailer at the end gives the position of the tables relative
+  // to the first object, and the size of the objects and the tables.
+  std::streampos pos = is().tellg();
+  const std::streamoff trailer = 2*sizeof(unsigned long long);
+  is().seekg(-trailer, ios::end);
+  unsigned long long tables = getRaw<unsigned long long>();
+  unsigned long long size = getRaw<unsigned long long>();
+  is().seekg(-trailer - std::streamoff(size), ios::end);
+  theObjectStart = is().tellg();
+  is().seekg(theObjectStart + std::streamoff(tables));
+  if ( !is() || theObjectStart < 0 ) {
+    setBadState();
+    return;
+  }
+  long nClasses = 0;
+  *this >> nClasses;
+  vector< vector<int> > bases(nClasses);
+  vector<InputDescription *> classes;
+  for ( long cid = 0; cid < nClasses && good(); ++cid ) {
+    string className;
+    int classVersion;
+    string libraries;
+    long nBase;
+    *this >> className >> classVersion >> libraries >> nBase;
+    bases[cid].resize(nBase);
+    for ( long i = 0; i < nBase; ++i ) *this >> bases[cid][i];
+    InputDescription * id = new InputDescription(className, classVersion);
+    classes.push_back(id);
+    readClasses.push_back(id);
+    findDescription(id, libraries);
+  }
+  for ( long cid = 0, N = classes.size(); cid < N; ++cid )
+    for ( int i = 0, M = bases[cid].size(); i < M; ++i ) {
+      if ( bases[cid][i] < 0 || bases[cid][i] >= N ) setBadState();
+      else classes[cid]->addBaseClass(classes[bases[cid][i]]);
+    }
+  *this >> theObjectOffsets;
+  readObjects.resize(theObjectOffsets.size());
+  is().seekg(pos);
 }
 
 PersistentIStream::~PersistentIStream() {
@@ -139,6 +330,7 @@ void PersistentIStream::endBase(string classname) {
 }
 
 PersistentIStream::BPtr PersistentIStream::getObject() {
+  if ( theObjectReader ) return theObjectReader->getObject();
   BPtr obj;
   if ( !good() ) return obj;
   ObjectVector::size_type oid;
@@ -147,6 +339,7 @@ PersistentIStream::BPtr PersistentIStream::getObject() {
     if ( !beginObject() ) {
       *this >> oid;
       if ( !oid ) return obj;
+      if ( isIndexed ) return getObject(oid);
       if ( oid <= readObjects.size() ) return readObjects[oid-1];
       throw MissingObject()
 	<< "PersistentIStream could not find object number " << oid
@@ -154,18 +347,28 @@ PersistentIStream::BPtr PersistentIStream::getObject() {
     }
     get();
     *this >> oid;
-    if ( oid > readObjects.size() + 1 ) throw MissingObject()
+    if ( isIndexed? ( oid == 0 || oid > readObjects.size() ||
+		      readObjects[oid-1] ): oid > readObjects.size() + 1 )
+      throw MissingObject()
       << "PersistentIStream could not read in object because its number ("
       << oid << ") was inconsistent." << Exception::runerror;
     pid = getClass();
-    unsigned long uid = ReferenceCounted::objectCounter + 1;
+    // Give the object the same unique ID as when it was written. The
+    // requested ID only affects the next object created in this
+    // thread, which is the one created here.
+    unsigned long uid = 0;
     if ( version > 0 || subVersion >= 3 ) *this >> uid;
-    unsigned long saveid = ReferenceCounted::objectCounter;
-    ReferenceCounted::objectCounter = uid - 1;
-    obj = pid->create();
-    ReferenceCounted::objectCounter = max(saveid, uid);
-    readObjects.erase(readObjects.begin() + (oid - 1), readObjects.end());
-    readObjects.push_back(obj);
+    {
+      HoldFlag<unsigned long> id(ReferenceCounted::requestedId, uid, 0);
+      obj = pid->create();
+    }
+    if ( isIndexed ) {
+      readObjects[oid-1] = obj;
+      theReadOrder.push_back(oid);
+    } else {
+      readObjects.erase(readObjects.begin() + (oid - 1), readObjects.end());
+      readObjects.push_back(obj);
+    }
     getObjectPart(obj, pid);
     endObject();
     if ( badState && Debug::level ) throw ReadFailure()
@@ -192,6 +395,67 @@ PersistentIStream::BPtr PersistentIStream::getObject() {
   }
 }
   
+PersistentIStream::BPtr
+PersistentIStream::getObject(ObjectVector::size_type oid) {
+  if ( theObjectReader ) return theObjectReader->getObject(oid);
+  if ( !isIndexed || oid == 0 || oid > readObjects.size() )
+    throw MissingObject()
+      << "PersistentIStream could not find object number " << oid
+      << " in the index." << Exception::runerror;
+  if ( readObjects[oid-1] ) return readObjects[oid-1];
+  map<ObjectVector::size_type,tBPtr>::const_iterator rit =
+    theReleasedObjects.find(oid);
+  if ( rit != theReleasedObjects.end() ) return rit->second;
+  if ( !good() ) return BPtr();
+  // Read the object from its position given in the index and then
+  // continue where we were.
+  std::streampos pos = is().tellg();
+  is().seekg(theObjectStart + std::streamoff(theObjectOffsets[oid-1]));
+  BPtr obj = getObject();
+  is().seekg(pos);
+  return obj;
+}
+
+std::shared_ptr<PersistentIStream> PersistentIStream::objectReader() {
+  if ( theObjectReader ) return theObjectReader;
+  return theSelf.lock();
+}
+
+void PersistentIStream::releaseObject(tcBPtr obj) {
+  if ( theObjectReader ) {
+    theObjectReader->releaseObject(obj);
+    return;
+  }
+  for ( ObjectVector::size_type i = 0; i < readObjects.size(); ++i )
+    if ( readObjects[i] == obj ) {
+      theReleasedObjects[i+1] = readObjects[i];
+      readObjects[i] = BPtr();
+    }
+}
+
+PersistentIStream::ObjectVector::size_type
+PersistentIStream::objectsRead() const {
+  if ( theObjectReader ) return theObjectReader->objectsRead();
+  return isIndexed? theReadOrder.size(): readObjects.size();
+}
+
+PersistentIStream::ObjectVector::size_type
+PersistentIStream::objectsIndexed() const {
+  if ( theObjectReader ) return theObjectReader->objectsIndexed();
+  return theObjectOffsets.size();
+}
+
+PersistentIStream::tBPtr
+PersistentIStream::objectRead(ObjectVector::size_type i) const {
+  if ( theObjectReader ) return theObjectReader->objectRead(i);
+  if ( i >= theReadOrder.size() ) return tBPtr();
+  ObjectVector::size_type oid = theReadOrder[i];
+  if ( readObjects[oid-1] ) return readObjects[oid-1];
+  map<ObjectVector::size_type,tBPtr>::const_iterator rit =
+    theReleasedObjects.find(oid);
+  return rit == theReleasedObjects.end()? tBPtr(): rit->second;
+}
+
 void PersistentIStream::
 getObjectPart(tBPtr obj, const InputDescription * pid) {
   DescriptionVector::const_iterator bit = pid->descriptions().begin();
@@ -206,6 +470,9 @@ const InputDescription * PersistentIStream::getClass() {
   unsigned int cid;
   operator>>(cid);
   if ( cid < readClasses.size() ) return readClasses[cid];
+  if ( isIndexed ) throw MissingClass()
+    << "PersistentIStream could not find class number " << cid
+    << " in the index." << Exception::runerror;
   string className;
   operator>>(className);
   if ( cid != readClasses.size() ) throw MissingClass()
@@ -221,6 +488,13 @@ const InputDescription * PersistentIStream::getClass() {
   int nBase;
   operator>>(nBase);
   while ( nBase-- ) id->addBaseClass(getClass());
+  findDescription(id, libraries);
+  return id;
+}
+
+void PersistentIStream::
+findDescription(InputDescription * id, string libraries) {
+  string className = id->name();
   const ClassDescriptionBase * db = DescriptionList::find(className);
   string loaderror;
   if ( !db && libraries.length() ) {
@@ -238,12 +512,23 @@ const InputDescription * PersistentIStream::getClass() {
     << "PersistentIStream could not find the class '" << className << "'."
     << loaderror << Exception::runerror;
   id->setDescription(db);
-  return id;
 }
 
 
 PersistentIStream & PersistentIStream::operator>>(string & s) {
   s.erase();
+  if ( isBinary ) {
+    char tag = get();
+    if ( tag == bString ) {
+      string::size_type len = getVarint();
+      s.resize(len);
+      if ( len ) is().read(&s[0], len);
+      if ( !is() ) setBadState();
+    }
+    else if ( tag == bChar ) s += get();
+    else setBadState();
+    return *this;
+  }
   char c = 0;
   while ( good() && (c = get()) != tSep ) {
     if ( c == tNull ) s += escaped();
@@ -253,6 +538,11 @@ PersistentIStream & PersistentIStream::operator>>(string & s) {
 }
 
 PersistentIStream & PersistentIStream::operator>>(char & c) {
+  if ( isBinary ) {
+    if ( get() != bChar ) setBadState();
+    c = get();
+    return *this;
+  }
   if ( (c = get()) == tNull ) c = escaped();
   getSep();
   return *this;
@@ -273,6 +563,12 @@ PersistentIStream & PersistentIStream::operator>>(signed char & c) {
 }
 
 PersistentIStream & PersistentIStream::operator>>(bool & t) {
+  if ( isBinary ) {
+    char c = get();
+    t = ( c == bYes );
+    if ( !t && c != bNo ) setBadState();
+    return *this;
+  }
   char c = get();
   t = ( c == tYes );
   if ( !t && c != tNo ) setBadState();
@@ -280,6 +576,60 @@ PersistentIStream & PersistentIStream::operator>>(bool & t) {
   return *this;
 }
 
+long long PersistentIStream::convertInteger(char tag) {
+  switch ( tag ) {
+  case bDouble: return static_cast<long long>(getRaw<double>());
+  case bFloat: return static_cast<long long>(getRaw<float>());
+  case bYes: return 1;
+  case bNo: return 0;
+  default:
+    setBadState();
+    return 0;
+  }
+}
+
+double PersistentIStream::convertFloat(char tag) {
+  switch ( tag ) {
+  case bFloat: return getRaw<float>();
+  case bSigned: {
+    unsigned long long u = getVarint();
+    return double(static_cast<long long>(u >> 1) ^
+		  -static_cast<long long>(u & 1));
+  }
+  case bUnsigned: return double(getVarint());
+  default:
+    setBadState();
+    return 0.0;
+  }
+}
+
+void PersistentIStream::skipBinaryField() {
+  switch ( get() ) {
+  case bSigned:
+  case bUnsigned:
+    getVarint();
+    break;
+  case bDouble:
+    is().ignore(sizeof(double));
+    break;
+  case bFloat:
+    is().ignore(sizeof(float));
+    break;
+  case bString:
+    is().ignore(getVarint());
+    break;
+  case bChar:
+    get();
+    break;
+  case bYes:
+  case bNo:
+    break;
+  default:
+    setBadState();
+  }
+  if ( !is() ) setBadState();
+}
+
 PersistentIStream & PersistentIStream::operator>>(Complex & z) {
   double re = 0.0;
   double im = 0.0;
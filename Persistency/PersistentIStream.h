@@ -16,6 +16,8 @@
 #include "ThePEG/Utilities/Exception.h"
 #include <climits>
 #include <valarray>
+#include <cstring>
+#include <memory>
 
 namespace ThePEG {
 
@@ -42,6 +44,18 @@ namespace ThePEG {
  * structures, the virtual base classes will be written out several
  * times for the same object.
  *
+ * Streams written in both the text and the binary format of
+ * PersistentOStream can be read, the format being selected from the
+ * header of the stream.
+ *
+ * If the stream is indexed, objects are read in one at the time when
+ * a pointer to them is read, using the table of their positions at
+ * the end of the stream. This is done by a separate PersistentIStream
+ * given by objectReader(), which owns the underlying istream and may
+ * be kept by the objects read to read in other objects when they are
+ * first needed. An istream given to the constructor is then copied
+ * in memory.
+ *
  * @see PersistentOStream
  * @see ClassTraits
  */
@@ -65,7 +79,8 @@ public:
    */
   PersistentIStream(istream & is) 
     : theIStream(&is), isPedantic(true), 
-      allocStream(false), badState(false)
+      allocStream(false), badState(false), isBinary(false),
+      isIndexed(false), theObjectStart(0)
   {
     init();
   }
@@ -145,6 +160,17 @@ public:
    */
   PersistentIStream & operator>>(string &);
 
+  /**
+   * Return true if the stream being read was written in the binary
+   * format.
+   */
+  bool binary() const { return isBinary; }
+
+  /**
+   * Return true if the stream being read is indexed.
+   */
+  bool indexed() const { return isIndexed; }
+
   /**
    * Read a character.
    */
@@ -164,8 +190,11 @@ public:
    * Read an integer.
    */
   PersistentIStream & operator>>(int & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -173,8 +202,11 @@ public:
    * Read an unsigned integer.
    */
   PersistentIStream & operator>>(unsigned int & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -182,8 +214,11 @@ public:
    * Read a long integer.
    */
   PersistentIStream & operator>>(long & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -191,8 +226,11 @@ public:
    * Read an unsigned long integer.
    */
   PersistentIStream & operator>>(unsigned long & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -200,8 +238,11 @@ public:
    * Read a short integer.
    */
   PersistentIStream & operator>>(short & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -209,8 +250,11 @@ public:
    * Read an unsigned short integer.
    */
   PersistentIStream & operator>>(unsigned short & i) {
-    is() >> i;
-    getSep();
+    if ( isBinary ) i = getInteger();
+    else {
+      is() >> i;
+      getSep();
+    }
     return *this;
   }
 
@@ -218,8 +262,11 @@ public:
    * Read a double.
    */
   PersistentIStream & operator>>(double & d) {
-    is() >> d;
-    getSep();
+    if ( isBinary ) d = getFloat();
+    else {
+      is() >> d;
+      getSep();
+    }
     return *this;
   }
 
@@ -227,8 +274,11 @@ public:
    * Read a float.
    */
   PersistentIStream & operator>>(float & f) {
-    is() >> f;
-    getSep();
+    if ( isBinary ) f = getFloat();
+    else {
+      is() >> f;
+      getSep();
+    }
     return *this;
   }
 
@@ -265,6 +315,44 @@ public:
    */
   BPtr getObject();
 
+  /**
+   * In an indexed stream, return the object with the given number,
+   * reading it in if this has not been done before.
+   */
+  BPtr getObject(ObjectVector::size_type oid);
+
+  /**
+   * For an indexed stream, return the stream reading the objects. It
+   * may be kept by an object read from this stream, to read in other
+   * objects with getObject(ObjectVector::size_type) when they are
+   * first needed. For other streams, null is returned.
+   */
+  std::shared_ptr<PersistentIStream> objectReader();
+
+  /**
+   * In an indexed stream, keep only a transient pointer to the given
+   * object, which must already have been read. Used by an object
+   * keeping the objectReader() to avoid a circular reference to
+   * itself.
+   */
+  void releaseObject(tcBPtr);
+
+  /**
+   * Return the number of objects read so far.
+   */
+  ObjectVector::size_type objectsRead() const;
+
+  /**
+   * Return the total number of objects in an indexed stream, or zero
+   * for other streams.
+   */
+  ObjectVector::size_type objectsIndexed() const;
+
+  /**
+   * In an indexed stream, return the \a i'th object read in.
+   */
+  tBPtr objectRead(ObjectVector::size_type i) const;
+
   /**
    * For a given object, read the member variables corresponding to a
    * given InputDescription object.
@@ -290,6 +378,7 @@ public:
    */
   PersistentIStream & setPedantic() {
     isPedantic = true;
+    if ( theObjectReader ) theObjectReader->setPedantic();
     return *this;
   }
 
@@ -303,6 +392,7 @@ public:
    */
   PersistentIStream & setTolerant() {
     isPedantic = false;
+    if ( theObjectReader ) theObjectReader->setTolerant();
     return *this;
   }
 
@@ -350,11 +440,31 @@ private:
   struct ReadFailure: public Exception {};
   /** @endcond */
 
+  /**
+   * Constructor used for the stream reading the objects of an
+   * indexed stream, taking over the istream \a is and taking the
+   * information read from the beginning of the stream from \a
+   * header.
+   */
+  PersistentIStream(istream * is, const PersistentIStream & header);
+
   /**
    * Internal initialization.
    */
   void init();
 
+  /**
+   * Read the tables of classes and object positions at the end of an
+   * indexed stream.
+   */
+  void readIndex();
+
+  /**
+   * Find the class description for the given InputDescription,
+   * loading the given \a libraries if needed.
+   */
+  void findDescription(InputDescription * id, string libraries);
+
   /**
    * Get the next character from the associated istream.
    */
@@ -378,21 +488,101 @@ private:
   }
 
   /**
-   * Read a field separator from the stream.
+   * Read a field separator from the stream. In the binary format
+   * there are no separators.
    */
   void getSep() {
+    if ( isBinary ) return;
     if ( !pedantic() ) skipField();
     else if ( get() != tSep ) setBadState();
   }
 
   /**
-   * Scan the stream for the next field separator.
+   * Scan the stream for the next field separator. In the binary
+   * format skip the next field.
    */
   void skipField() {
+    if ( isBinary ) {
+      skipBinaryField();
+      return;
+    }
     is().ignore(INT_MAX, tSep);
     if ( !is() ) setBadState();
   }
 
+  /** @name Functions for reading the binary format. */
+  //@{
+  /**
+   * Read a varint.
+   */
+  unsigned long long getVarint() {
+    unsigned long long u = 0;
+    int shift = 0;
+    char c;
+    do {
+      c = get();
+      u |= static_cast<unsigned long long>(c & 0x7f) << shift;
+      shift += 7;
+    } while ( ( c & 0x80 ) && shift < 64 && is() );
+    return u;
+  }
+
+  /**
+   * Read the little-endian bytes of a floating point number.
+   */
+  template <typename T>
+  T getRaw() {
+    char buff[sizeof(T)];
+    is().read(buff, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::reverse(buff, buff + sizeof(T));
+#endif
+    T x;
+    std::memcpy(&x, buff, sizeof(T));
+    return x;
+  }
+
+  /**
+   * Read an integer field. Signed and unsigned integers are returned
+   * as the corresponding 64-bit pattern.
+   */
+  long long getInteger() {
+    char tag = get();
+    if ( tag == bSigned ) {
+      unsigned long long u = getVarint();
+      return static_cast<long long>(u >> 1) ^ -static_cast<long long>(u & 1);
+    }
+    if ( tag == bUnsigned ) return getVarint();
+    return convertInteger(tag);
+  }
+
+  /**
+   * Read a floating point field.
+   */
+  double getFloat() {
+    char tag = get();
+    if ( tag == bDouble ) return getRaw<double>();
+    return convertFloat(tag);
+  }
+
+  /**
+   * Read a field with the given type \a tag which was expected to
+   * be an integer, converting it if possible.
+   */
+  long long convertInteger(char tag);
+
+  /**
+   * Read a field with the given type \a tag which was expected to
+   * be a floating point number, converting it if possible.
+   */
+  double convertFloat(char tag);
+
+  /**
+   * Skip the next field in the binary format.
+   */
+  void skipBinaryField();
+  //@}
+
 
   /**
    * Check if the next char to be read is a tBegin marker.
@@ -455,6 +645,11 @@ private:
    */
   bool badState;
 
+  /**
+   * True if the stream was written in the binary format.
+   */
+  bool isBinary;
+
   /** Version number of the PersistentOStream which has written the
    *  file being read. */
   int version;
@@ -468,6 +663,46 @@ private:
    */
   vector<string> theGlobalLibraries;
 
+  /**
+   * True if the stream being read is indexed.
+   */
+  bool isIndexed;
+
+  /**
+   * The stream reading the objects of an indexed stream, if it is not
+   * this.
+   */
+  std::shared_ptr<PersistentIStream> theObjectReader;
+
+  /**
+   * A pointer to this, if this is the stream reading the objects of
+   * an indexed stream.
+   */
+  std::weak_ptr<PersistentIStream> theSelf;
+
+  /**
+   * The position of the first object in an indexed stream.
+   */
+  std::streamoff theObjectStart;
+
+  /**
+   * The positions of the objects in an indexed stream, relative to
+   * the first one.
+   */
+  vector<unsigned long> theObjectOffsets;
+
+  /**
+   * The numbers of the objects read so far from an indexed stream, in
+   * the order they were read.
+   */
+  vector<ObjectVector::size_type> theReadOrder;
+
+  /**
+   * The objects in an indexed stream for which only a transient
+   * pointer is kept, indexed by their numbers.
+   */
+  map<ObjectVector::size_type,tBPtr> theReleasedObjects;
+
   /** @name Special marker characters */
   //@{
   /**
@@ -513,6 +748,33 @@ private:
   static const char tNo = 'n';
   //@}
 
+  /** @name Type tags used in the binary format. */
+  //@{
+  /** A signed integer, written as a zig-zag encoded varint. */
+  static const char bSigned = 'i';
+
+  /** An unsigned integer, written as a varint. */
+  static const char bUnsigned = 'u';
+
+  /** A double, written as eight little-endian bytes. */
+  static const char bDouble = 'd';
+
+  /** A float, written as four little-endian bytes. */
+  static const char bFloat = 'f';
+
+  /** A string, written as a varint length followed by the characters. */
+  static const char bString = 's';
+
+  /** A single character. */
+  static const char bChar = 'c';
+
+  /** A true boolean value. */
+  static const char bYes = 'Y';
+
+  /** A false boolean value. */
+  static const char bNo = 'N';
+  //@}
+
 private:
 
   /**
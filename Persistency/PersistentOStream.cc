@@ -13,31 +13,43 @@
 
 #include "PersistentOStream.h"
 #include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/HoldFlag.h"
 #include <fstream>
 
 namespace ThePEG {
 
-PersistentOStream::PersistentOStream(ostream & os, const vector<string> & libs)
-: theOStream(&os), badState(false), allocStream(false) {
-  init(libs);
+PersistentOStream::PersistentOStream(ostream & os, const vector<string> & libs,
+				     bool binary, bool indexed)
+  : theOStream(&os), badState(false), allocStream(false), isBinary(false),
+    isIndexed(false), writingObjects(false) {
+  init(libs, binary, indexed);
 }
 
-PersistentOStream::PersistentOStream(string file, const vector<string> & libs)
-  : badState(false), allocStream(true) {
+PersistentOStream::PersistentOStream(string file, const vector<string> & libs,
+				     bool binary, bool indexed)
+  : badState(false), allocStream(true), isBinary(false), isIndexed(false),
+    writingObjects(false) {
 //    if ( file[0] == '|' )
 //      theOStream = new opfstream(file.substr(1).c_str());
 //    else if ( file.substr(file.length()-3, file.length()) == ".gz" )
 //      theOStream = new opfstream(string("gzip > " + file).c_str());
 //    else
-    theOStream = new ofstream(file.c_str());
+    theOStream = binary? new ofstream(file.c_str(), ios::binary):
+                         new ofstream(file.c_str());
   if ( theOStream )
-    init(libs);
+    init(libs, binary, indexed);
   else
     setBadState();
 }
 
-void PersistentOStream::init(const vector<string> & libs) {
-  operator<<(string("ThePEG version 1 Database"));
+void PersistentOStream::
+init(const vector<string> & libs, bool binary, bool indexed) {
+  // The header tag is always written as text, and selects the format
+  // for the rest of the stream.
+  operator<<(string("ThePEG version 1 ") + ( indexed? "Indexed ": "" ) +
+	     ( binary? "Binary ": "" ) + "Database");
+  isBinary = binary;
+  isIndexed = indexed;
   operator<<(version);
   operator<<(subVersion);
   *this << DynamicLoader::appendedPaths();
@@ -49,9 +61,20 @@ void PersistentOStream::init(const vector<string> & libs) {
 }
 
 PersistentOStream::~PersistentOStream() {
+  if ( isIndexed ) writeIndex();
   if ( allocStream ) delete theOStream;
 }
 
+bool & PersistentOStream::binaryDefault() {
+  static bool binary = false;
+  return binary;
+}
+
+bool & PersistentOStream::indexedDefault() {
+  static bool indexed = false;
+  return indexed;
+}
+
 void PersistentOStream::
 putObjectPart(tcBPtr obj, const ClassDescriptionBase * db) {
   ClassDescriptionBase::DescriptionVector::const_iterator bit =
@@ -68,25 +91,39 @@ PersistentOStream::outputPointer(tcBPtr obj) {
   if ( !good() ) return *this;
   if ( !obj ) return operator<<(0);
   // It it's the  null pointer, just print a zero.
-  int oid = 0;
+
+  // Check if the object has been written before. In that case just write
+  // out it's number
+  ObjectMap::const_iterator oit = writtenObjects.find(obj);
+  if ( oit != writtenObjects.end() ) {
+    *this << oit->second;
+    return *this;
+  }
+
+  int oid = writtenObjects.size()+1;
+  writtenObjects[obj] = oid;
+  if ( !isIndexed ) {
+    writeObject(obj, oid);
+    return *this;
+  }
+
+  // In an indexed stream only the number is written here. The object
+  // is written after the one currently being written, if any.
+  *this << oid;
+  theObjectQueue.push_back(obj);
+  if ( !writingObjects ) writeQueuedObjects();
+  return *this;
+}
+
+void PersistentOStream::writeObject(tcBPtr obj, int oid) {
   const ClassDescriptionBase * desc = 0;
 
   try {
 
-    // Check if the object has been written before. In that case just write
-    // out it's number
-    ObjectMap::const_iterator oit = writtenObjects.find(obj);
-    if ( oit != writtenObjects.end() ) {
-      *this << oit->second;
-      return *this;
-    }
-
     // This object hasn't been written before so we write it out, beginning
     // with a number, then the class information, and finally let it write
     // itself on the stream.
     beginObject();
-    oid = writtenObjects.size()+1;
-    writtenObjects[obj] = oid;
     *this << oid;
     desc = writeClassId(obj);
     *this << obj->uniqueId;
@@ -106,7 +143,45 @@ PersistentOStream::outputPointer(tcBPtr obj) {
     setBadState();
   }
   checkState();
-  return *this;
+}
+
+void PersistentOStream::writeQueuedObjects() {
+  HoldFlag<> writing(writingObjects, true);
+  HoldFlag<ostream *> buffer(theOStream, &theObjectBuffer);
+  while ( !theObjectQueue.empty() && good() ) {
+    cBPtr obj = theObjectQueue.front();
+    theObjectQueue.pop_front();
+    theObjectOffsets.push_back(theObjectBuffer.tellp());
+    writeObject(obj, writtenObjects[obj]);
+  }
+}
+
+void PersistentOStream::writeIndex() {
+  unsigned long long tables = 0;
+  {
+    HoldFlag<ostream *> buffer(theOStream, &theObjectBuffer);
+    tables = theObjectBuffer.tellp();
+    *this << theIndexedClasses.size();
+    for ( int cid = 0, N = theIndexedClasses.size(); cid < N; ++cid ) {
+      const ClassDescriptionBase * db = theIndexedClasses[cid];
+      *this << db->name() << db->version()
+	    << DynamicLoader::dlnameversion(db->library())
+	    << db->descriptions().size();
+      for ( DescriptionVector::const_iterator bit = db->descriptions().begin();
+	    bit != db->descriptions().end(); ++bit )
+	*this << classNumber(*bit);
+    }
+    *this << theObjectOffsets;
+  }
+  // The objects and the tables are written last, followed by a
+  // trailer of fixed size giving the position of the tables and the
+  // size of it all, so that they can be found from the end of the
+  // stream.
+  string objects = theObjectBuffer.str();
+  os().write(objects.data(), objects.size());
+  putRaw(tables);
+  putRaw(static_cast<unsigned long long>(objects.size()));
+  os().flush();
 }
 
 const ClassDescriptionBase *
@@ -120,10 +195,22 @@ PersistentOStream::writeClassId(tcBPtr obj) {
       << ". Please check that the class has a properly instantiated "
       << "ClassDescription object." << Exception::runerror;
   }
-  writeClassDescription(db);
+  if ( isIndexed ) operator<<(classNumber(db));
+  else writeClassDescription(db);
   return db;
 }
 
+int PersistentOStream::classNumber(const ClassDescriptionBase * db) {
+  ClassMap::iterator cit = writtenClasses.find(db);
+  if ( cit != writtenClasses.end() ) return cit->second;
+  int cid = writtenClasses.size();
+  writtenClasses[db] = cid;
+  theIndexedClasses.push_back(db);
+  DescriptionVector::const_iterator bit = db->descriptions().begin();
+  while ( bit != db->descriptions().end() ) classNumber(*bit++);
+  return cid;
+}
+
 void PersistentOStream::
 writeClassDescription(const ClassDescriptionBase * db) {
   // If objects of this class has been written out before, just write
@@ -155,6 +242,10 @@ PersistentOStream & PersistentOStream::flush() {
 #else
   typedef ObjectMap::iterator Iterator;
 #endif
+  if ( isIndexed ) {
+    os().flush();
+    return *this;
+  }
   Iterator it = writtenObjects.begin();
   while ( it != writtenObjects.end() ) {
     Iterator it2 = it++;
@@ -17,6 +17,7 @@
 #include "PersistentOStream.fh"
 #include "PersistentOStream.xh"
 #include <valarray>
+#include <cstring>
 
 namespace ThePEG {
 
@@ -44,6 +45,23 @@ namespace ThePEG {
  * structures, the virtual base classes will be written out several
  * times for the same object.
  *
+ * By default all values are written as text. Optionally a binary
+ * format may be selected when the stream is created, in which case
+ * integers are written as variable-length integers, floating point
+ * numbers as raw little-endian IEEE numbers and strings prefixed by
+ * their length, each preceded by a one-character type tag. The
+ * object structure is the same in both formats, and the
+ * PersistentIStream selects the format from the header of the stream.
+ *
+ * Either format may also be indexed. Then objects are not written
+ * where they are first referred to. Only their numbers are written
+ * there, while the objects themselves are written one after the
+ * other at the end of the stream, followed by a table of their
+ * positions. A PersistentIStream can then read in each object
+ * separately when it is first needed. Since the whole stream is only
+ * complete when the PersistentOStream is destroyed, the objects are
+ * kept in memory until then.
+ *
  * @see PersistentIStream
  * @see ClassDescription
  * @see ClassTraits
@@ -68,9 +86,12 @@ public:
   /**
    * Constuctor giving an output stream. Optionally a vector of
    * libraries to be loaded before the resulting file can be read in
-   * again can be given in \a libs.
+   * again can be given in \a libs. If \a binary is true the binary
+   * format is used and if \a indexed is true the stream is indexed.
    */
-  PersistentOStream(ostream &, const vector<string> & libs = vector<string>());
+  PersistentOStream(ostream &, const vector<string> & libs = vector<string>(),
+		    bool binary = binaryDefault(),
+		    bool indexed = indexedDefault());
 
   /**
    * Constuctor giving a file name to read. If the first
@@ -78,15 +99,41 @@ public:
    * run and its standard input is used instead. If the filename ends
    * in ".gz" the file is compressed with gzip. Optionally a vector of
    * libraries to be loaded before the resulting file can be read in
-   * again can be given in \a libs.
+   * again can be given in \a libs. If \a binary is true the binary
+   * format is used and if \a indexed is true the stream is indexed.
    */
-  PersistentOStream(string, const vector<string> & libs = vector<string>());
+  PersistentOStream(string, const vector<string> & libs = vector<string>(),
+		    bool binary = binaryDefault(),
+		    bool indexed = indexedDefault());
 
   /**
-   * The destructor
+   * The destructor. For an indexed stream the objects and the table
+   * of their positions are written here.
    */
   ~PersistentOStream();
 
+  /**
+   * Access the flag determining if new streams should use the binary
+   * format if not explicitly specified. By default this is false.
+   */
+  static bool & binaryDefault();
+
+  /**
+   * Return true if this stream uses the binary format.
+   */
+  bool binary() const { return isBinary; }
+
+  /**
+   * Access the flag determining if new streams should be indexed if
+   * not explicitly specified. By default this is false.
+   */
+  static bool & indexedDefault();
+
+  /**
+   * Return true if this stream is indexed.
+   */
+  bool indexed() const { return isIndexed; }
+
   /**
    * Operator for writing persistent objects to the stream.
    * @param p a pointer to the object to be written.
@@ -134,6 +181,12 @@ public:
    * Write a character string.
    */
   PersistentOStream & operator<<(string s) {
+    if ( isBinary ) {
+      put(bString);
+      putVarint(s.size());
+      os().write(s.data(), s.size());
+      return *this;
+    }
     for ( string::const_iterator i = s.begin(); i < s.end(); ++i ) escape(*i);
     put(tSep);
     return *this;
@@ -143,6 +196,11 @@ public:
    * Write a character.
    */
   PersistentOStream & operator<<(char c) {
+    if ( isBinary ) {
+      put(bChar);
+      put(c);
+      return *this;
+    }
     escape(c);
     put(tSep);
     return *this;
@@ -166,8 +224,11 @@ public:
    * Write an integer.
    */
   PersistentOStream & operator<<(int i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putSigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -175,8 +236,11 @@ public:
    * Write an unsigned integer.
    */
   PersistentOStream & operator<<(unsigned int i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putUnsigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -184,8 +248,11 @@ public:
    * Write a long integer.
    */
   PersistentOStream & operator<<(long i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putSigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -193,8 +260,11 @@ public:
    * Write an unsigned long integer.
    */
   PersistentOStream & operator<<(unsigned long i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putUnsigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -202,8 +272,11 @@ public:
    * Write a short integer.
    */
   PersistentOStream & operator<<(short i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putSigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -211,8 +284,11 @@ public:
    * Write an unsigned short integer.
    */
   PersistentOStream & operator<<(unsigned short i) {
-    os() << i;
-    put(tSep);
+    if ( isBinary ) putUnsigned(i);
+    else {
+      os() << i;
+      put(tSep);
+    }
     return *this;
   }
 
@@ -224,6 +300,11 @@ public:
       throw WriteError()
 	<< "Tried to write a NaN or Inf double to a persistent stream."
 	<< Exception::runerror;
+    if ( isBinary ) {
+      put(bDouble);
+      putRaw(d);
+      return *this;
+    }
     os() << setprecision(18) << d;
     put(tSep);
     return *this;
@@ -237,6 +318,11 @@ public:
       throw WriteError()
 	<< "Tried to write a NaN or Inf float to a persistent stream."
 	<< Exception::runerror;
+    if ( isBinary ) {
+      put(bFloat);
+      putRaw(f);
+      return *this;
+    }
     os() << setprecision(9) << f;
     put(tSep);
     return *this;
@@ -246,6 +332,10 @@ public:
    * Write a boolean.
    */
   PersistentOStream & operator<<(bool t) {
+    if ( isBinary ) {
+      put(t? bYes: bNo);
+      return *this;
+    }
     if (t) put(tYes);
     else put(tNo);
     // This is a workaround for a possible bug in gcc 4.0.0
@@ -300,7 +390,8 @@ public:
 
   /**
    * Remove all objects that have been written, except those which are
-   * to be saved, from the list of written objects.
+   * to be saved, from the list of written objects. In an indexed
+   * stream all objects are kept.
    */
   PersistentOStream & flush();
   
@@ -407,6 +498,33 @@ private:
   static const char tNo = 'n';
   //@}
 
+  /** @name Type tags used in the binary format. */
+  //@{
+  /** A signed integer, written as a zig-zag encoded varint. */
+  static const char bSigned = 'i';
+
+  /** An unsigned integer, written as a varint. */
+  static const char bUnsigned = 'u';
+
+  /** A double, written as eight little-endian bytes. */
+  static const char bDouble = 'd';
+
+  /** A float, written as four little-endian bytes. */
+  static const char bFloat = 'f';
+
+  /** A string, written as a varint length followed by the characters. */
+  static const char bString = 's';
+
+  /** A single character. */
+  static const char bChar = 'c';
+
+  /** A true boolean value. */
+  static const char bYes = 'Y';
+
+  /** A false boolean value. */
+  static const char bNo = 'N';
+  //@}
+
   /**
    * Return true if the given character is aspecial marker character.
    */
@@ -432,6 +550,31 @@ private:
    */
   const ClassDescriptionBase * writeClassId(tcBPtr);
 
+  /**
+   * Write the object \a obj with the number \a oid, including its
+   * class information.
+   */
+  void writeObject(tcBPtr obj, int oid);
+
+  /**
+   * Write the objects referred to in an indexed stream which have not
+   * been written yet.
+   */
+  void writeQueuedObjects();
+
+  /**
+   * Write the objects and the tables of classes and object positions
+   * of an indexed stream at the end of the stream.
+   */
+  void writeIndex();
+
+  /**
+   * Return the number of the given class in an indexed stream. If it
+   * has not been numbered before, it and its base classes are
+   * numbered.
+   */
+  int classNumber(const ClassDescriptionBase *);
+
   /**
    * write out class information to the associated ostream.
    */
@@ -469,6 +612,51 @@ private:
       put(c);
   }
 
+  /**
+   * Write an unsigned integer as a varint with seven bits per byte,
+   * least significant first.
+   */
+  void putVarint(unsigned long long u) {
+    char buff[10];
+    int n = 0;
+    while ( u >= 0x80 ) {
+      buff[n++] = char((u & 0x7f) | 0x80);
+      u >>= 7;
+    }
+    buff[n++] = char(u);
+    os().write(buff, n);
+  }
+
+  /**
+   * Write a signed integer in the binary format.
+   */
+  void putSigned(long long i) {
+    put(bSigned);
+    putVarint( ( static_cast<unsigned long long>(i) << 1 ) ^
+	       static_cast<unsigned long long>(i >> 63) );
+  }
+
+  /**
+   * Write an unsigned integer in the binary format.
+   */
+  void putUnsigned(unsigned long long u) {
+    put(bUnsigned);
+    putVarint(u);
+  }
+
+  /**
+   * Write the bytes of a floating point number in little-endian order.
+   */
+  template <typename T>
+  void putRaw(T x) {
+    char buff[sizeof(T)];
+    std::memcpy(buff, &x, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::reverse(buff, buff + sizeof(T));
+#endif
+    os().write(buff, sizeof(T));
+  }
+
   /**
    * Return a reference to the associated ostream.
    */
@@ -482,7 +670,7 @@ private:
   /**
    * Write out initial metainfo on the stream.
    */
-  void init(const vector<string> & libs);
+  void init(const vector<string> & libs, bool binary, bool indexed);
 
   /**
    * List of written objects.
@@ -514,6 +702,44 @@ private:
    */
   bool allocStream;
 
+  /**
+   * True if the binary format is used.
+   */
+  bool isBinary;
+
+  /**
+   * True if the stream is indexed.
+   */
+  bool isIndexed;
+
+  /**
+   * True while objects in an indexed stream are being written.
+   */
+  bool writingObjects;
+
+  /**
+   * The objects in an indexed stream which are referred to but not
+   * yet written.
+   */
+  deque<cBPtr> theObjectQueue;
+
+  /**
+   * The objects written in an indexed stream, kept until the end of
+   * the stream.
+   */
+  ostringstream theObjectBuffer;
+
+  /**
+   * The positions of the objects in theObjectBuffer.
+   */
+  vector<unsigned long> theObjectOffsets;
+
+  /**
+   * The classes used in an indexed stream, in the order of their
+   * numbers.
+   */
+  vector<const ClassDescriptionBase *> theIndexedClasses;
+
 private:
 
   /**
@@ -1,2 +1,3 @@
 #include "ReferenceCounted.h"
-unsigned long ThePEG::Pointer::ReferenceCounted::objectCounter = 0;
+std::atomic<unsigned long> ThePEG::Pointer::ReferenceCounted::objectCounter(0);
+thread_local unsigned long ThePEG::Pointer::ReferenceCounted::requestedId(0);
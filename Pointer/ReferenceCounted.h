@@ -11,18 +11,97 @@
 // This is the declaration of the ReferenceCounted class.
 
 
+#include "ThePEG/Config/RefCountConfig.h"
 #include "RCPtr.fh"
 #include "ThePEG/Persistency/PersistentIStream.fh"
+#include <atomic>
 
 namespace ThePEG {
 namespace Pointer {
 
+/**
+ * ReferenceCounterPolicy defines how the reference count of a
+ * ReferenceCounted object is stored and modified. The general
+ * template uses a plain integer, which is the fastest alternative,
+ * but an object counted this way may only be pointed to from one
+ * thread at the time.
+ */
+template <bool Atomic>
+struct ReferenceCounterPolicy {
+
+  /** The integer type used for counting. */
+  typedef unsigned int CounterType;
+
+  /** The type used to store the count. */
+  typedef CounterType StorageType;
+
+  /** Increment the count \a c. */
+  static void increment(StorageType & c) { ++c; }
+
+  /** Decrement the count \a c and return true if it reached zero. */
+  static bool decrement(StorageType & c) { return !--c; }
+
+  /** Return the value of the count \a c. */
+  static CounterType get(const StorageType & c) { return c; }
+
+};
+
+/**
+ * The thread-safe specialization of ReferenceCounterPolicy, using an
+ * atomic counter. Increments are relaxed, since a new reference can
+ * only be made from an existing one, while decrements use
+ * acquire-release ordering so that the deletion of an object is
+ * ordered after all previous uses of it in other threads.
+ */
+template <>
+struct ReferenceCounterPolicy<true> {
+
+  /** The integer type used for counting. */
+  typedef unsigned int CounterType;
+
+  /** The type used to store the count. */
+  typedef std::atomic<CounterType> StorageType;
+
+  /** Increment the count \a c. */
+  static void increment(StorageType & c) {
+    c.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** Decrement the count \a c and return true if it reached zero. */
+  static bool decrement(StorageType & c) {
+    return c.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  /** Return the value of the count \a c. */
+  static CounterType get(const StorageType & c) {
+    return c.load(std::memory_order_relaxed);
+  }
+
+};
+
+/**
+ * The ReferenceCounterPolicy used by ReferenceCounted. Atomic
+ * counters are used if ThePEG has been configured with
+ * <code>--enable-atomic-refcount</code>, which defines the
+ * ThePEG_ATOMIC_REFCOUNT macro in config.h and in the installed
+ * ThePEG/Config/RefCountConfig.h header, so that all code using
+ * ThePEG gets the same layout of ReferenceCounted.
+ */
+#ifdef ThePEG_ATOMIC_REFCOUNT
+typedef ReferenceCounterPolicy<true> DefaultReferenceCounterPolicy;
+#else
+typedef ReferenceCounterPolicy<false> DefaultReferenceCounterPolicy;
+#endif
+
 /**
  * ReferenceCounted must be the (virtual) base class of all
  * classes which may be pointed to by the RCPtr smart
  * pointer class. It keeps track of all RCPtr and
  * ConstRCPtr pointers which are currently pointing to an
- * object.
+ * object. How the count is kept is determined by the
+ * DefaultReferenceCounterPolicy. Unique IDs are always issued
+ * atomically, so that objects may be created concurrently in
+ * different threads.
  *
  * @see RCPtr
  * @see ConstRCPtr
@@ -35,10 +114,15 @@ class ReferenceCounted {
 
 public:
 
+  /**
+   * The policy used for counting.
+   */
+  typedef DefaultReferenceCounterPolicy CounterPolicy;
+
   /**
    * The integer type used for counting.
    */
-  typedef unsigned int CounterType;
+  typedef CounterPolicy::CounterType CounterType;
 
 protected:
 
@@ -48,14 +132,14 @@ protected:
    * Default constructor.
    */
   ReferenceCounted() 
-    : uniqueId(++objectCounter), 
+    : uniqueId(nextId()),
       theReferenceCounter(CounterType(1)) {}
 
   /**
    * Copy-constructor.
    */
   ReferenceCounted(const ReferenceCounted &)
-    : uniqueId(++objectCounter), 
+    : uniqueId(nextId()),
       theReferenceCounter(CounterType(1)) {}
 
   /**
@@ -75,7 +159,7 @@ public:
    */
   CounterType referenceCount() const 
   { 
-    return theReferenceCounter; 
+    return CounterPolicy::get(theReferenceCounter);
   }
 
 private:
@@ -85,7 +169,7 @@ private:
    */
   void incrementReferenceCount() const 
   { 
-    ++theReferenceCounter; 
+    CounterPolicy::increment(theReferenceCounter);
   }
 
   /**
@@ -93,7 +177,7 @@ private:
    */
   bool decrementReferenceCount() const 
   {
-    return !--theReferenceCounter;
+    return CounterPolicy::decrement(theReferenceCounter);
   }
 
 public:
@@ -109,12 +193,42 @@ private:
    * A counter for issuing unique IDs. It will overflow back to 0 eventually,
    * but it is very unlikely that two identical IDs show up in the same event.
    */
-  static unsigned long objectCounter;
+  static std::atomic<unsigned long> objectCounter;
+
+  /**
+   * If non-zero, the unique ID to be given to the next object created
+   * in the current thread. Used by PersistentIStream to give objects
+   * read back the same IDs as when they were written, without
+   * affecting objects created concurrently in other threads.
+   */
+  static thread_local unsigned long requestedId;
+
+  /**
+   * Issue a new unique ID.
+   */
+  static unsigned long nextId() {
+    if ( requestedId ) return takeRequestedId();
+    return objectCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  /**
+   * Return and reset the requestedId, making sure that no smaller ID
+   * is issued later on.
+   */
+  static unsigned long takeRequestedId() {
+    unsigned long id = requestedId;
+    requestedId = 0;
+    unsigned long current = objectCounter.load(std::memory_order_relaxed);
+    while ( current < id &&
+	    !objectCounter.compare_exchange_weak(current, id,
+						 std::memory_order_relaxed) );
+    return id;
+  }
 
   /**
    * The reference count.
    */
-  mutable CounterType theReferenceCounter;
+  mutable CounterPolicy::StorageType theReferenceCounter;
 
 };
 
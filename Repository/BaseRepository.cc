@@ -31,6 +31,8 @@
 #include "ThePEG/Utilities/StringUtils.h"
 #include "ThePEG/Utilities/Throw.h"
 #include "ThePEG/PDT/DecayMode.h"
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/RandomGenerator.h"
 
 #ifdef ThePEG_TEMPLATES_IN_CC_FILE
 #include "BaseRepository.tcc"
@@ -114,11 +116,12 @@ void BaseRepository::prependReadDir(const std::vector<std::string>& dirs) {
 }
 
 void BaseRepository::appendReadDir(string dir) {
-  readDirs().push_back(dir);
+  if ( find(readDirs().begin(), readDirs().end(), dir) == readDirs().end() )
+    readDirs().push_back(dir);
 }
 
 void BaseRepository::appendReadDir(const std::vector<std::string>& dirs) {
-  readDirs().insert(readDirs().end(), dirs.begin(), dirs.end());
+  for ( size_t i = 0; i < dirs.size(); ++i ) appendReadDir(dirs[i]);
 }
 
 BaseRepository::StringVector & BaseRepository::directoryStack() {
@@ -295,6 +298,48 @@ InterfaceMap BaseRepository::getInterfaces(const type_info & ti, bool all) {
   return interfaceMap;
 }
 
+string BaseRepository::setupKey(const ObjectSet & objs,
+				const set<string> & ignore,
+				vector<string> & skipped) {
+  map<string,tIBPtr> sorted;
+  for ( ObjectSet::const_iterator it = objs.begin(); it != objs.end(); ++it )
+    sorted[(**it).fullName()] = *it;
+  unsigned long long hash = 14695981039346656037ull;
+  auto add = [&hash](string s) {
+    for ( int i = 0, N = s.size(); i < N; ++i ) {
+      hash ^= (unsigned char)(s[i]);
+      hash *= 1099511628211ull;
+    }
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+  };
+  for ( map<string,tIBPtr>::iterator it = sorted.begin();
+	it != sorted.end(); ++it ) {
+    InterfacedBase & obj = *it->second;
+    if ( dynamic_cast<RandomGenerator *>(&obj) ||
+	 dynamic_cast<EventGenerator *>(&obj) ) continue;
+    add(it->first);
+    add(DescriptionList::className(typeid(obj)));
+    InterfaceMap ifs = getInterfaces(typeid(obj));
+    for ( InterfaceMap::iterator iit = ifs.begin(); iit != ifs.end(); ++iit ) {
+      const InterfaceBase & i = *iit->second;
+      if ( i.type() == "Cm" || i.type() == "Dd" ) continue;
+      string tag = it->first + ":" + iit->first;
+      if ( ignore.find(tag) != ignore.end() ) continue;
+      add(iit->first);
+      try {
+	add(i.exactValue(obj));
+      }
+      catch ( ... ) {
+	skipped.push_back(tag);
+      }
+    }
+  }
+  ostringstream os;
+  os << std::hex << setw(16) << std::setfill('0') << hash;
+  return os.str();
+}
+
 void BaseRepository::
 rebind(InterfacedBase & i, const TranslationMap & trans,
        const IVector & defaults) {
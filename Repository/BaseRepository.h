@@ -233,12 +233,13 @@ public:
   static void prependReadDir(const std::vector<std::string>& dirs);
 
   /**
-   * Add a directory to readDirs().
+   * Add a directory to readDirs(), unless it is already there.
    */
   static void appendReadDir(string);
   
     /**
-   * Add a string vector with directories to readDirs().
+   * Add a string vector with directories to readDirs(), skipping
+   * the ones already there.
    */
   static void appendReadDir(const std::vector<std::string>& dirs);
 
@@ -346,6 +347,20 @@ public:
    */
   static InterfaceMap getInterfaces(const type_info & ti, bool all = true);
 
+  /**
+   * Return a key identifying the setup of the objects in \a objs. The
+   * class names and the current values of all interfaces of the
+   * objects, taken in order of their full names and written with
+   * full precision, are combined into a 64-bit FNV-1a hash which is
+   * returned as a hexadecimal string. EventGenerator and
+   * RandomGenerator objects and command interfaces are left out, as
+   * are interfaces given as "object-name:interface-name" in \a
+   * ignore. The same strings for interfaces whose values could not
+   * be obtained are added to \a skipped.
+   */
+  static string setupKey(const ObjectSet & objs, const set<string> & ignore,
+			 vector<string> & skipped);
+
   /**
    * Return an interface with the given \a name to the given \a object.
    */
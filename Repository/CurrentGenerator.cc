@@ -15,6 +15,6 @@
 
 using namespace ThePEG;
 
-vector<EGPtr> CurrentGenerator::theGeneratorStack;
+thread_local vector<EGPtr> CurrentGenerator::theGeneratorStack;
 
 
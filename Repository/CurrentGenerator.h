@@ -17,7 +17,9 @@ namespace ThePEG {
 
 /**
  * This CurrentGenerator class keeps a static stack of EventGenerators
- * which can be used anywhere by any class. When an EventGenerator is
+ * which can be used anywhere by any class. There is one such stack
+ * per thread, so that several EventGenerators may be run
+ * concurrently in different threads. When an EventGenerator is
  * initialized or run it adds itself to the stack which can be used by
  * any other object being initialized or run through the static
  * functions of the CurrentGenerator class. If someone
@@ -254,9 +256,9 @@ public:
 private:
 
   /**
-   * The stack of EventGenerators requested.
+   * The stack of EventGenerators requested in the current thread.
    */
-  static vector<EGPtr> theGeneratorStack;
+  static thread_local vector<EGPtr> theGeneratorStack;
 
   /**
    * True if this object is responsible for pushing a EventGenerator
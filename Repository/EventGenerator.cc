@@ -46,7 +46,12 @@
 #include "ThePEG/Utilities/DynamicLoader.h"
 #include <cstdlib>
 #include "ThePEG/Repository/Main.h"
+#include "ThePEG/Utilities/UnitIO.h"
 #include <csignal>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 #ifdef ThePEG_TEMPLATES_IN_CC_FILE
 #include "EventGenerator.tcc"
@@ -78,11 +83,13 @@ void EventGenerator::checkSignalState() {
 
 EventGenerator::EventGenerator()
   : thePath("."), theNumberOfEvents(1000), theQuickSize(7000),
-    preinitializing(false), ieve(0), weightSum(0.0),
+    preinitializing(false), ieve(0), theEventStride(1), theWorkerIndex(-1),
+    weightSum(0.0),
     theDebugLevel(0), logNonDefault(-1), printEvent(0), dumpPeriod(0),
     keepAllDumps(false),
     debugEvent(0), maxWarnings(10), maxErrors(10), theCurrentRandom(0),
-    theCurrentGenerator(0), useStdout(false), theIntermediateOutput(false) {}
+    theCurrentGenerator(0), useStdout(false), theIntermediateOutput(false),
+    theRegisteredObjects(0), initializingRun(false) {}
 
 EventGenerator::EventGenerator(const EventGenerator & eg)
   : Interfaced(eg), theDefaultObjects(eg.theDefaultObjects),
@@ -94,12 +101,14 @@ EventGenerator::EventGenerator(const EventGenerator & eg)
     theHistogramFactory(eg.theHistogramFactory),
     theEventManipulator(eg.theEventManipulator),
     thePath(eg.thePath), theRunName(eg.theRunName),
-    theNumberOfEvents(eg.theNumberOfEvents), theObjects(eg.theObjects),
+    theNumberOfEvents(eg.theNumberOfEvents), theObjects(eg.objects()),
     theObjectMap(eg.theObjectMap),
     theParticles(eg.theParticles), theQuickParticles(eg.theQuickParticles),
     theQuickSize(eg.theQuickSize), preinitializing(false),
     theMatchers(eg.theMatchers),
-    usedObjects(eg.usedObjects), ieve(eg.ieve), weightSum(eg.weightSum),
+    usedObjects(eg.usedObjects), ieve(eg.ieve),
+    theEventStride(eg.theEventStride), theWorkerIndex(eg.theWorkerIndex),
+    weightSum(eg.weightSum),
     theDebugLevel(eg.theDebugLevel), logNonDefault(eg.logNonDefault),
     printEvent(eg.printEvent), dumpPeriod(eg.dumpPeriod),
     keepAllDumps(eg.keepAllDumps),
@@ -109,7 +118,8 @@ EventGenerator::EventGenerator(const EventGenerator & eg)
     theCurrentEventHandler(eg.theCurrentEventHandler),
     theCurrentStepHandler(eg.theCurrentStepHandler),
     useStdout(eg.useStdout),
-    theIntermediateOutput(eg.theIntermediateOutput) {}
+    theIntermediateOutput(eg.theIntermediateOutput),
+    theRegisteredObjects(0), initializingRun(false) {}
 
 EventGenerator::~EventGenerator() {
   if ( theCurrentRandom ) delete theCurrentRandom;
@@ -129,15 +139,66 @@ tcEventPtr EventGenerator::currentEvent() const {
 }
 
 CrossSection EventGenerator::histogramScale() const {
-  return eventHandler()->histogramScale();
+  if ( theWorkers.empty() ) return eventHandler()->histogramScale();
+  // The sum of weights in each worker is given by the ratio of its
+  // cross section and histogram scale.
+  double sumw = 0.0;
+  for ( int i = 0, N = theWorkers.size(); i < N; ++i ) {
+    CrossSection scale = theWorkers[i]->histogramScale();
+    if ( scale > ZERO ) sumw += theWorkers[i]->integratedXSec()/scale;
+  }
+  return sumw > 0.0? integratedXSec()/sumw: ZERO;
 }
 
 CrossSection EventGenerator::integratedXSec() const {
-  return eventHandler()->integratedXSec();
+  if ( theWorkers.empty() ) return eventHandler()->integratedXSec();
+  return workerXSec().first;
 }
 
 CrossSection EventGenerator::integratedXSecErr() const {
-  return eventHandler()->integratedXSecErr();
+  if ( theWorkers.empty() ) return eventHandler()->integratedXSecErr();
+  return workerXSec().second;
+}
+
+pair<CrossSection,CrossSection> EventGenerator::workerXSec() const {
+  // Combine the independent estimates weighted with the inverse of
+  // their variance, or with their sum of weights if some estimate
+  // lacks an error.
+  double sumx = 0.0;
+  double sumw = 0.0;
+  double sumerr2 = 0.0;
+  bool useErrors = true;
+  for ( int i = 0, N = theWorkers.size(); i < N; ++i )
+    if ( theWorkers[i]->integratedXSecErr() <= ZERO ) useErrors = false;
+  for ( int i = 0, N = theWorkers.size(); i < N; ++i ) {
+    double x = theWorkers[i]->integratedXSec()/nanobarn;
+    double err = theWorkers[i]->integratedXSecErr()/nanobarn;
+    double w = useErrors? 1.0/sqr(err): theWorkers[i]->sumWeights();
+    sumx += w*x;
+    sumw += w;
+    sumerr2 += sqr(w*err);
+  }
+  if ( sumw <= 0.0 ) return make_pair(ZERO, ZERO);
+  if ( useErrors ) return make_pair(sumx/sumw*nanobarn, nanobarn/sqrt(sumw));
+  return make_pair(sumx/sumw*nanobarn, sqrt(sumerr2)/sumw*nanobarn);
+}
+
+void EventGenerator::workerStatistics(ostream & os) const {
+  string line = "======================================="
+    "=======================================\n";
+  os << line << "Events were generated in " << theWorkers.size()
+     << " threads. Full statistics for each thread\n"
+     << "can be found in the corresponding output files.\n\n"
+     << "Thread                                        events    "
+     << "xsec (nb)\n" << line;
+  for ( int i = 0, N = theWorkers.size(); i < N; ++i )
+    os << std::left << setw(40) << theWorkers[i]->runName() << std::right
+       << setw(12) << theWorkers[i]->currentEventNumber() << setw(17)
+       << ouniterr(theWorkers[i]->integratedXSec(),
+		   theWorkers[i]->integratedXSecErr(), nanobarn) << '\n';
+  os << line << "Total:" << setw(46) << ieve << setw(17)
+     << ouniterr(integratedXSec(), integratedXSecErr(), nanobarn) << '\n'
+     << line;
 }
 
 void EventGenerator::setSeed(long seed) {
@@ -177,9 +238,74 @@ EventGenerator::setup(string newRunName,
 }
 
 IBPtr EventGenerator::getPointer(string name) const {
-  ObjectMap::const_iterator it = objectMap().find(name);
-  if ( it == objectMap().end() ) return IBPtr();
-  else return it->second;
+  ObjectMap::const_iterator it = theObjectMap.find(name);
+  if ( it != theObjectMap.end() ) return it->second;
+  map<string,unsigned long>::const_iterator iit = theIndexedObjects.find(name);
+  if ( iit == theIndexedObjects.end() ) return IBPtr();
+  return readIndexedObject(iit->second);
+}
+
+void EventGenerator::readAllObjects() const {
+  EventGenerator & eg = const_cast<EventGenerator &>(*this);
+  while ( !theIndexedObjects.empty() ) {
+    string name = theIndexedObjects.begin()->first;
+    IBPtr obj = readIndexedObject(theIndexedObjects.begin()->second);
+    // Normally the object has been added under the same name.
+    if ( eg.theIndexedObjects.erase(name) ) {
+      eg.theObjectMap[name] = obj;
+      eg.theObjects.insert(obj);
+    }
+  }
+  while ( !theIndexedParticles.empty() ) {
+    long id = theIndexedParticles.begin()->first;
+    unsigned long oid = theIndexedParticles.begin()->second;
+    PDPtr pd = dynamic_ptr_cast<PDPtr>(readIndexedObject(oid));
+    if ( eg.theIndexedParticles.erase(id) ) eg.theParticles[id] = pd;
+  }
+}
+
+IBPtr EventGenerator::readIndexedObject(unsigned long oid) const {
+  EventGenerator & eg = const_cast<EventGenerator &>(*this);
+  IBPtr obj = dynamic_ptr_cast<IBPtr>(theObjectReader->getObject(oid));
+  vector<IBPtr> added = eg.registerReadObjects();
+  if ( !obj ) throw Exception()
+    << "The EventGenerator '" << name() << "' could not read in object "
+    << "number " << oid << " from the indexed file." << Exception::runerror;
+  // Objects read in after the run has been initialized must be
+  // initialized as well.
+  if ( initState == runready || initializingRun )
+    for_each(added, std::mem_fn(&InterfacedBase::initrun));
+  return obj;
+}
+
+vector<IBPtr> EventGenerator::registerReadObjects() {
+  vector<IBPtr> added;
+  for ( ; theRegisteredObjects < theObjectReader->objectsRead();
+	++theRegisteredObjects ) {
+    IBPtr obj = dynamic_ptr_cast<IBPtr>
+      (theObjectReader->objectRead(theRegisteredObjects));
+    if ( !obj ) continue;
+    PDPtr pd = dynamic_ptr_cast<PDPtr>(obj);
+    if ( pd ) {
+      map<long,unsigned long>::iterator pit = theIndexedParticles.find(pd->id());
+      if ( pit != theIndexedParticles.end() ) {
+	theIndexedParticles.erase(pit);
+	theParticles[pd->id()] = pd;
+	if ( abs(pd->id()) < theQuickSize && theQuickParticles.size() )
+	  theQuickParticles[pd->id()+theQuickSize] = pd;
+      }
+    }
+    map<string,unsigned long>::iterator it =
+      theIndexedObjects.find(obj->fullName());
+    if ( it == theIndexedObjects.end() ) continue;
+    theIndexedObjects.erase(it);
+    theObjectMap[obj->fullName()] = obj;
+    theObjects.insert(obj);
+    PMPtr pm = dynamic_ptr_cast<PMPtr>(obj);
+    if ( pm ) theMatchers.insert(pm);
+    added.push_back(obj);
+  }
+  return added;
 }
 
 void EventGenerator::openOutputFiles() {
@@ -272,6 +398,11 @@ void EventGenerator::doinitrun() {
 
   currentEventHandler(eventHandler());
 
+  // If this generator was read from an indexed file, only the objects
+  // read in so far are initialized here. The others are initialized
+  // when they are first read in.
+  HoldFlag<> initializing(initializingRun, true);
+
   Interfaced::doinitrun();
   random().initrun();
 
@@ -286,14 +417,14 @@ void EventGenerator::doinitrun() {
     }
   }
   // initialize particles first
-  for(ParticleMap::const_iterator pit = particles().begin();
-      pit != particles().end(); ++pit) {
+  for(ParticleMap::const_iterator pit = theParticles.begin();
+      pit != theParticles.end(); ++pit) {
     pit->second->initrun();
   }
   eventHandler()->initrun();
 
   
-  for_each(objects(), std::mem_fn(&InterfacedBase::initrun));
+  for_each(theObjects, std::mem_fn(&InterfacedBase::initrun));
 
   if ( logNonDefault > 0 || ( ThePEG_DEBUG_LEVEL && logNonDefault == 0 ) ) {
     vector< pair<IBPtr, const InterfaceBase *> > changed =
@@ -318,11 +449,16 @@ void EventGenerator::doinitrun() {
 
 PDPtr EventGenerator::getParticleData(PID id) const {
   long newId = id;
-  if ( abs(newId) < theQuickSize && theQuickParticles.size() )
+  if ( abs(newId) < theQuickSize && theQuickParticles.size() &&
+       ( theQuickParticles[newId+theQuickSize] ||
+	 theIndexedParticles.empty() ) )
     return theQuickParticles[newId+theQuickSize];
   ParticleMap::const_iterator it = theParticles.find(newId);
-  if ( it == theParticles.end() ) return PDPtr();
-  return it->second;
+  if ( it != theParticles.end() ) return it->second;
+  map<long,unsigned long>::const_iterator iit =
+    theIndexedParticles.find(newId);
+  if ( iit == theIndexedParticles.end() ) return PDPtr();
+  return dynamic_ptr_cast<PDPtr>(readIndexedObject(iit->second));
 }
 
 PPtr EventGenerator::getParticle(PID newId) const {
@@ -342,11 +478,16 @@ void EventGenerator::dofinish() {
 
   HoldFlag<int> debug(Debug::level, Debug::isset? Debug::level: theDebugLevel);
 
-  // first write out statistics from the event handler.
-  eventHandler()->statistics(out());
+  // first write out statistics from the event handler, or from the
+  // worker generators if this was a multi-threaded run.
+  if ( theWorkers.empty() ) eventHandler()->statistics(out());
+  else workerStatistics(out());
 
-  // Call the finish method for all other objects.
-  for_each(objects(), std::mem_fn(&InterfacedBase::finish));
+  // Call the finish method for all other objects. Objects which were
+  // not read in from an indexed file before the run was finished were
+  // never used and need not be finished.
+  ObjectSet objs = theObjects;
+  for_each(objs, std::mem_fn(&InterfacedBase::finish));
 
   if ( theExceptions.empty() ) {
     log() << "No exceptions reported in this run.\n";
@@ -397,6 +538,8 @@ void EventGenerator::finally() {
   theCurrentRandom = 0;
   theCurrentGenerator = 0;
 
+  theWorkers.clear();
+
 }
 
 void EventGenerator::initialize(bool initOnly) {
@@ -423,6 +566,17 @@ void EventGenerator::go(long next, long maxevent, bool tics) {
   doGo(next, maxevent, tics);
 }
 
+void EventGenerator::go(long next, long maxevent, bool tics,
+			unsigned int nthreads, bool ordered) {
+  if ( nthreads < 2 ) {
+    go(next, maxevent, tics);
+    return;
+  }
+  UseRandom currentRandom(theRandom);
+  CurrentGenerator currentGenerator(this);
+  doGoThreaded(next, maxevent, tics, nthreads, ordered);
+}
+
 EventPtr EventGenerator::shoot() {
   static DebugItem debugfpu("ThePEG::FPU", 1);
   if ( debugfpu ) Debug::unmaskFpuErrors();
@@ -437,7 +591,7 @@ EventPtr EventGenerator::shoot() {
 
 EventPtr EventGenerator::doShoot() {
   EventPtr event;
-  if ( N() >= 0 && ++ieve > N() ) return event;
+  if ( N() >= 0 && ( ieve += theEventStride ) > N() ) return event;
   HoldFlag<int> debug(Debug::level, Debug::isset? Debug::level: theDebugLevel);
   do { 
     int state = 0;
@@ -598,6 +752,251 @@ void EventGenerator::doGo(long next, long maxevent, bool tics) {
 
 }
 
+EGPtr EventGenerator::makeWorker(const string & snapshot,
+				 unsigned int ithread) {
+  EGPtr worker;
+  istringstream is(snapshot);
+  PersistentIStream pis(is);
+  pis >> worker;
+  if ( !worker ) return worker;
+
+  // The analysis is done by this generator, so the worker should
+  // neither have analysis handlers nor a histogram factory.
+  worker->removeAnalysis();
+
+  ostringstream tag;
+  tag << "-thread" << ithread;
+  worker->runName(runName() + tag.str());
+  worker->theWorkerIndex = ithread;
+  // If possible give each worker its own substream of random numbers,
+  // otherwise just give it a new seed.
+  if ( worker->random().hasStreams() )
+    worker->random().substream(ithread + 1);
+  else
+    worker->setSeed(long(random().rnd(1.0e8)) + 1);
+  return worker;
+}
+
+void EventGenerator::removeAnalysis() {
+  for ( int i = 0, N = theAnalysisHandlers.size(); i < N; ++i ) {
+    theObjects.erase(theAnalysisHandlers[i]);
+    theObjectMap.erase(theAnalysisHandlers[i]->fullName());
+  }
+  theAnalysisHandlers.clear();
+  if ( theHistogramFactory ) {
+    theObjects.erase(theHistogramFactory);
+    theObjectMap.erase(theHistogramFactory->fullName());
+    theHistogramFactory = HistFacPtr();
+  }
+}
+
+void EventGenerator::initializeAnalysis() {
+  UseRandom currentRandom(theRandom);
+  CurrentGenerator currentGenerator(this);
+  HoldFlag<int> debug(Debug::level, Debug::isset? Debug::level: theDebugLevel);
+  openOutputFiles();
+  random().init();
+  random().initrun();
+  for ( AnalysisVector::iterator it = analysisHandlers().begin();
+	it != analysisHandlers().end(); ++it ) {
+    (**it).init();
+    (**it).initrun();
+  }
+  if ( theHistogramFactory ) {
+    theHistogramFactory->init();
+    theHistogramFactory->initrun();
+  }
+  // This generator is now ready to analyze events and to be finished.
+  initState = runready;
+  if ( !ThePEG_DEBUG_LEVEL ) Exception::noabort = true;
+}
+
+EGPtr EventGenerator::makeInitWorker(const string & snapshot) const {
+  EGPtr worker;
+  istringstream is(snapshot);
+  PersistentIStream pis(is);
+  pis >> worker;
+  if ( !worker ) return worker;
+  worker->removeAnalysis();
+  worker->runName(runName() + "-init");
+
+  // Objects which were ready for the run in the snapshot have lost
+  // their transient state and need to be initialized again.
+  for ( ObjectSet::iterator it = worker->theObjects.begin();
+	it != worker->theObjects.end(); ++it )
+    if ( (**it).initState == runready ) (**it).initState = initialized;
+
+  // Anything written while initializing has already been written
+  // when this generator was initialized.
+  HoldFlag<int> debug(Debug::level, 0);
+  UseRandom workerRandom(worker->theRandom);
+  CurrentGenerator workerGenerator(worker);
+  worker->currentEventHandler(worker->eventHandler());
+  worker->random().initrun();
+  worker->standardModel()->initrun();
+  if ( worker->strategy() ) worker->strategy()->initrun();
+  for ( ParticleMap::const_iterator pit = worker->particles().begin();
+	pit != worker->particles().end(); ++pit )
+    pit->second->initrun();
+  worker->eventHandler()->initrun();
+  for_each(worker->objects(), std::mem_fn(&InterfacedBase::initrun));
+  return worker;
+}
+
+void EventGenerator::doGoThreaded(long next, long maxevent, bool tics,
+				  unsigned int nthreads, bool ordered) {
+
+  // Resuming an interrupted run can only be done in one thread.
+  if ( next < 0 ) {
+    doGo(next, maxevent, tics);
+    return;
+  }
+
+  if ( maxevent >= 0 ) N(maxevent);
+
+  // Save the state of this generator before it is initialized, to be
+  // used as the starting point for all workers. The binary format is
+  // faster to write and read back, and the workers need all objects
+  // anyway, so the snapshot is never indexed.
+  ostringstream snapshot;
+  {
+    PersistentOStream os(snapshot, globalLibraries(), true, false);
+    os << tcEGPtr(this);
+  }
+
+  // Create the workers, assigning the events to them in a
+  // round-robin fashion, so that the events generated are always the
+  // same for a given seed and number of threads. Each worker numbers
+  // its events with their number in the full run.
+  for ( unsigned int i = 0; i < nthreads; ++i ) {
+    EGPtr worker = makeWorker(snapshot.str(), i);
+    if ( !worker ) throw Exception()
+      << "Could not create worker number " << i << " of the EventGenerator '"
+      << name() << "' for a multi-threaded run." << Exception::runerror;
+    theWorkers.push_back(worker);
+  }
+
+  // Initialize the workers in parallel. This generator only needs
+  // to be able to analyze the events. Only the first worker writes
+  // any grid and cache files, the others may read them if they exist.
+  if ( tics ) 
+    cerr << "event> " << setw(9) << "init\r" << flush;
+  initializeAnalysis();
+  {
+    std::mutex initMutex;
+    std::exception_ptr initError;
+    auto init = [&](tEGPtr eg) {
+      try {
+	eg->initialize();
+      }
+      catch ( ... ) {
+	std::lock_guard<std::mutex> lock(initMutex);
+	if ( !initError ) initError = std::current_exception();
+      }
+    };
+    vector<std::thread> threads;
+    for ( unsigned int i = 0; i < nthreads; ++i )
+      threads.push_back(std::thread(init, theWorkers[i]));
+    for ( unsigned int i = 0; i < nthreads; ++i ) threads[i].join();
+    if ( initError ) std::rethrow_exception(initError);
+  }
+  ieve = next - 1;
+  for ( unsigned int i = 0; i < nthreads; ++i ) {
+    theWorkers[i]->N(N());
+    theWorkers[i]->ieve = next + i - nthreads;
+    theWorkers[i]->theEventStride = nthreads;
+  }
+
+  std::mutex analysisMutex;
+  std::condition_variable analysisDone;
+  long nextEvent = ieve + 1;
+  long ndone = 0;
+  bool aborted = false;
+  std::exception_ptr error;
+  int debuglevel = Debug::level;
+
+  auto work = [&](unsigned int ithread) {
+    tEGPtr worker = theWorkers[ithread];
+    Debug::level = debuglevel;
+    try {
+      static DebugItem debugfpu("ThePEG::FPU", 1);
+      if ( debugfpu ) Debug::unmaskFpuErrors();
+      long local = 0;
+      while ( !THEPEG_SIGNAL_STATE ) {
+	EventPtr event;
+	{
+	  UseRandom workerRandom(worker->theRandom);
+	  CurrentGenerator workerGenerator(worker);
+	  event = worker->doShoot();
+	}
+	if ( !event ) break;
+	worker->weightSum += event->weight();
+	long ievent = next + ithread + local*nthreads;
+
+	// Analyze the event with the handlers of this generator, one
+	// thread at the time.
+	std::unique_lock<std::mutex> lock(analysisMutex);
+	if ( ordered )
+	  analysisDone.wait(lock, [&]() {
+	      return aborted || THEPEG_SIGNAL_STATE || nextEvent == ievent; });
+	if ( aborted || ( ordered && nextEvent != ievent ) ) break;
+	UseRandom currentRandom(theRandom);
+	CurrentGenerator currentGenerator(this);
+	ieve = ievent;
+	weightSum += event->weight();
+	ReferenceCounted::CounterType nref = event->referenceCount();
+	for ( AnalysisVector::iterator it = analysisHandlers().begin();
+	      it != analysisHandlers().end(); ++it )
+	  (**it).analyze(event, ieve, -1, 0);
+#ifndef ThePEG_ATOMIC_REFCOUNT
+	// The event will be released in this thread without holding the
+	// lock, so no other thread may refer to it.
+	if ( event->referenceCount() != nref ) throw Exception()
+	  << "An analysis handler of the EventGenerator '" << name()
+	  << "' kept a reference to an analyzed event, which is not "
+	  << "allowed in a multi-threaded run unless ThePEG is configured "
+	  << "with --enable-atomic-refcount." << Exception::runerror;
+#endif
+	++nextEvent;
+	++local;
+	DebugItem::tic();
+	if ( tics ) tic(++ndone, N());
+	analysisDone.notify_all();
+      }
+      worker->ieve = local;
+      std::lock_guard<std::mutex> lock(analysisMutex);
+      analysisDone.notify_all();
+    }
+    catch ( ... ) {
+      std::lock_guard<std::mutex> lock(analysisMutex);
+      if ( !error ) error = std::current_exception();
+      aborted = true;
+      analysisDone.notify_all();
+    }
+  };
+
+  if ( tics ) tic(ndone, N());
+  vector<std::thread> threads;
+  for ( unsigned int i = 0; i < nthreads; ++i )
+    threads.push_back(std::thread(work, i));
+  for ( unsigned int i = 0; i < nthreads; ++i ) threads[i].join();
+
+  ieve = nextEvent - 1;
+  for ( unsigned int i = 0; i < nthreads; ++i ) theWorkers[i]->finalize();
+
+  if ( error ) {
+    finish();
+    std::rethrow_exception(error);
+  }
+
+  checkSignalState();
+
+  finish();
+
+  finally();
+
+}
+
 void EventGenerator::tic(long currev, long totev) const {
   if ( !currev ) currev = ieve;
   if ( !totev ) totev = N();
@@ -821,6 +1220,7 @@ struct ObjectOrdering {
 };
 
 void EventGenerator::persistentOutput(PersistentOStream & os) const {
+  readAllObjects();
   set<tcPMPtr,MatcherOrdering> match(theMatchers.begin(), theMatchers.end());
   set<tcIBPtr,ObjectOrdering> usedset(usedObjects.begin(), usedObjects.end());
   os << theDefaultObjects << theLocalParticles << theStandardModel
@@ -842,8 +1242,24 @@ void EventGenerator::persistentInput(PersistentIStream & is, int) {
   is >> theDefaultObjects >> theLocalParticles >> theStandardModel
      >> theStrategy >> theRandom >> theEventHandler >> theAnalysisHandlers
      >> theHistogramFactory >> theEventManipulator >> thePath >> theRunName
-     >> theNumberOfEvents >> theObjectMap >> theParticles
-     >> theQuickParticles >> theQuickSize >> theMatchers >> usedObjects
+     >> theNumberOfEvents;
+  theObjectMap.clear();
+  theParticles.clear();
+  theMatchers.clear();
+  theIndexedObjects.clear();
+  theIndexedParticles.clear();
+  if ( is.indexed() ) {
+    // In an indexed file only the numbers of the objects in this run
+    // are read here, and the objects are read in when first needed.
+    vector<unsigned long> quick;
+    vector<unsigned long> matchers;
+    is >> theIndexedObjects >> theIndexedParticles >> quick >> theQuickSize
+       >> matchers;
+    theQuickParticles = PDVector(quick.size());
+  } else
+    is >> theObjectMap >> theParticles >> theQuickParticles >> theQuickSize
+       >> theMatchers;
+  is >> usedObjects
      >> ieve >> weightSum >> theDebugLevel >> logNonDefault >> printEvent
      >> dumpPeriod >> keepAllDumps >> debugEvent
      >> maxWarnings >> maxErrors >> theCurrentEventHandler
@@ -855,6 +1271,14 @@ void EventGenerator::persistentInput(PersistentIStream & is, int) {
   for ( ObjectMap::iterator it = theObjectMap.begin();
 	it != theObjectMap.end(); ++it ) theObjects.insert(it->second);
   Repository::appendReadDir(readdirs);
+  theObjectReader = is.objectReader();
+  theRegisteredObjects = 0;
+  if ( theObjectReader ) {
+    // The stream is kept to read in the remaining objects, but must
+    // not keep this generator alive.
+    is.releaseObject(tcBPtr(this));
+    registerReadObjects();
+  }
 }
 
 void EventGenerator::setLocalParticles(PDPtr pd, int) {
@@ -21,6 +21,7 @@
 #include "ThePEG/Handlers/EventHandler.fh"
 #include "ThePEG/Analysis/FactoryBase.fh"
 #include <fstream>
+#include <memory>
 #include "EventGenerator.xh"
 
 namespace ThePEG {
@@ -179,6 +180,64 @@ public:
    */
   void go(long next = 1, long maxevent = -1, bool tics = false);
 
+  /**
+   * Run this EventGenerator session using several threads. One copy
+   * of this generator is created for each thread, each with its own
+   * random number stream, and the events are generated concurrently
+   * by these copies. The analysis handlers of this generator are
+   * then called for each event. Calls the virtual method
+   * doGoThreaded().
+   *
+   * The copies are complete and independent, so nothing is shared
+   * between them, and the memory used grows with the number of
+   * threads. Only the first copy writes files which would otherwise
+   * be written by all of them, such as grid, cache and scan summary
+   * files (see writesSharedFiles()). This generator itself is not
+   * initialized for generating events, only its analysis handlers and
+   * histogram factory are. The ParticleData objects and handlers
+   * referred to by the events given to the analysis handlers belong
+   * to the copy which generated the event, so they should be compared
+   * by their PDG id and name rather than with the objects of this
+   * generator.
+   *
+   * No reference counted object is shared between the threads, so
+   * that this works also without atomic reference counts. Each copy
+   * is read from a snapshot of this generator and only used in its
+   * own thread. An event is analyzed in the thread where it was
+   * generated, one thread at the time. Unless ThePEG was configured
+   * with <code>--enable-atomic-refcount</code>, analysis handlers
+   * must therefore not keep references to an event after it has been
+   * analyzed, which is checked.
+   *
+   * @param next the number of the first event to be generated. If
+   * negative a previously interrupted run is resumed, which is only
+   * possible in a single thread.
+   * @param maxevent the maximum number of events to be generated. If
+   * negative the N() is used instead.
+   * @param tics if true information the number of events generated
+   * and elapsed time will be written to std::cerr after each event.
+   * @param nthreads the number of threads to use. If less than two,
+   * go(long,long,bool) is called instead.
+   * @param ordered if true the analysis handlers will see the events
+   * in the order of their event numbers, otherwise they are analyzed
+   * as soon as they have been generated.
+   */
+  void go(long next, long maxevent, bool tics,
+	  unsigned int nthreads, bool ordered = true);
+
+  /**
+   * Create a copy of this generator from a persistent \a snapshot of
+   * it, made while this generator is being initialized for a run, to
+   * be used on a separate thread to help with the initialization.
+   * The copy has no analysis handlers. Objects in the copy which had
+   * already been initialized for the run when the snapshot was made
+   * are initialized again, so that also their transient state is set
+   * up, while objects which were being initialized at the time are
+   * left as they are. The copy should be used with its own
+   * UseRandom and CurrentGenerator objects.
+   */
+  EGPtr makeInitWorker(const string & snapshot) const;
+
   /**
    * Generate one event. Calls the virtual method doShoot();
    */
@@ -225,6 +284,28 @@ public:
    */
   long currentEventNumber() const { return ieve; }
 
+  /**
+   * The difference between the numbers of consecutive events
+   * generated by this generator. This is the number of threads for a
+   * worker in a multi-threaded run and one otherwise.
+   */
+  long eventStride() const { return theEventStride; }
+
+  /**
+   * The index of this generator if it is a worker in a
+   * multi-threaded run, otherwise -1.
+   */
+  int workerIndex() const { return theWorkerIndex; }
+
+  /**
+   * Return true if this generator may write files which are shared
+   * by all generators in a multi-threaded run, such as grid and
+   * cache files. This is only the case for the first worker, and for
+   * a generator which is not a worker. The other workers may read
+   * such files but should not write them.
+   */
+  bool writesSharedFiles() const { return theWorkerIndex <= 0; }
+
   /**
    * Return the event being generated.
    */
@@ -382,15 +463,24 @@ public:
   /** @name Access objects included in this run. */
   //@{
   /**
-   * Return the set of objects used in this run.
+   * Return the set of objects used in this run. If this generator was
+   * read from an indexed file, all objects are first read in.
    */
-  const ObjectSet & objects() const { return theObjects; }
+  const ObjectSet & objects() const {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theObjects;
+  }
 
 
   /**
-   * Return the map of objects used in this run indexed by their name.
+   * Return the map of objects used in this run indexed by their
+   * name. If this generator was read from an indexed file, all
+   * objects are first read in.
    */
-  const ObjectMap & objectMap() const { return theObjectMap; }
+  const ObjectMap & objectMap() const {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theObjectMap;
+  }
 
   /**
    * Return a garbage collected pointer to a given object. If the
@@ -438,21 +528,36 @@ public:
 
   /**
    * Return a reference to the complete list of matchers in this
-   * generator.
+   * generator. If this generator was read from an indexed file, all
+   * objects are first read in.
    */
-  const MatcherSet & matchers() const { return theMatchers; }
+  const MatcherSet & matchers() const {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theMatchers;
+  }
 
   /**
    * Return a reference to the complete map of particle data objects
-   * in this generator, indexed by their id numbers.
+   * in this generator, indexed by their id numbers. If this generator
+   * was read from an indexed file, all objects are first read in.
    */
-  const ParticleMap & particles() const { return theParticles; }
+  const ParticleMap & particles() const {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theParticles;
+  }
 
   /**
    * Return a reference to the set of objects which have been
    * registered as used during the current run.
    */
   const ObjectSet & used() const { return usedObjects; }
+
+  /**
+   * Return a pointer to the default RandomGenerator object in this
+   * run, e.g. to be pushed with UseRandom when objects in this
+   * generator are used on a separate thread.
+   */
+  tRanGenPtr randomGenerator() const { return theRandom; }
   //@}
 
 protected:
@@ -484,6 +589,13 @@ protected:
    */
   virtual void doGo(long next, long maxevent, bool tics);
 
+  /**
+   * Run this EventGenerator session in \a nthreads threads. Is called
+   * from go(long,long,bool,unsigned int,bool).
+   */
+  virtual void doGoThreaded(long next, long maxevent, bool tics,
+			    unsigned int nthreads, bool ordered);
+
   /**
    * Initialize this generator. Is called from initialize().
    */
@@ -583,6 +695,58 @@ private:
    */
   string doMakeRun(string);
 
+  /**
+   * Create a worker generator for thread number \a ithread from the
+   * persistent \a snapshot of this generator, used by doGoThreaded().
+   */
+  EGPtr makeWorker(const string & snapshot, unsigned int ithread);
+
+  /**
+   * Remove the analysis handlers and the histogram factory from this
+   * generator, used for worker generators.
+   */
+  void removeAnalysis();
+
+  /**
+   * If this generator was read from an indexed file, read in all
+   * objects which have not yet been read.
+   */
+  void readAllObjects() const;
+
+  /**
+   * If this generator was read from an indexed file, read in the
+   * object with the given number \a oid. Any objects read in are
+   * added to this generator and, if the run has been initialized,
+   * initialized for the run.
+   */
+  IBPtr readIndexedObject(unsigned long oid) const;
+
+  /**
+   * Add the objects read in from the indexed file since the last
+   * call to this generator and return them.
+   */
+  vector<IBPtr> registerReadObjects();
+
+  /**
+   * Initialize only the random number generator, the analysis
+   * handlers and the histogram factory of this generator, and open
+   * the output files. Used by doGoThreaded(), where this generator
+   * only analyzes the events generated by the workers.
+   */
+  void initializeAnalysis();
+
+  /**
+   * Combine the cross section estimates of the worker generators
+   * used in a multi-threaded run.
+   */
+  pair<CrossSection,CrossSection> workerXSec() const;
+
+  /**
+   * Write out the cross sections of the worker generators used in a
+   * multi-threaded run.
+   */
+  void workerStatistics(ostream &) const;
+
 public:
 
   /** @name The following functions may be called by objects belonging
@@ -832,13 +996,19 @@ protected:
   /**
    * Return the set of all objects to be used in this run.
    */
-  ObjectSet & objects() { return theObjects; }
+  ObjectSet & objects() {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theObjects;
+  }
 
   /**
    * Return the map of all objects to be used in this run indexed by
    * their name.
    */
-  ObjectMap & objectMap() { return theObjectMap; }
+  ObjectMap & objectMap() {
+    if ( !theIndexedObjects.empty() ) readAllObjects();
+    return theObjectMap;
+  }
 
   /**
    * Print out the .tex file with descriptions of and references to
@@ -1006,6 +1176,18 @@ protected:
    */
   long ieve;
 
+  /**
+   * The difference between the numbers of consecutive events
+   * generated by this generator.
+   */
+  long theEventStride;
+
+  /**
+   * The index of this generator if it is a worker in a
+   * multi-threaded run, otherwise -1.
+   */
+  int theWorkerIndex;
+
   /**
    * The sum of the weights of the events produced so far.
    */
@@ -1120,6 +1302,12 @@ private:
    */
   CurrentGenerator * theCurrentGenerator;
 
+  /**
+   * The worker generators used in a multi-threaded run. Empty unless
+   * doGoThreaded() is running or finishing.
+   */
+  vector<EGPtr> theWorkers;
+
   /**
    * The currently active EventHandler.
    */
@@ -1146,6 +1334,35 @@ private:
    */
   vector<string> theGlobalLibraries;
 
+  /**
+   * The stream from which the objects of this generator are read if
+   * it was read from an indexed file.
+   */
+  std::shared_ptr<PersistentIStream> theObjectReader;
+
+  /**
+   * The numbers in the indexed file of the objects in this run which
+   * have not yet been read in, indexed by their names.
+   */
+  map<string,unsigned long> theIndexedObjects;
+
+  /**
+   * The numbers in the indexed file of the particle data objects
+   * which have not yet been read in, indexed by their id numbers.
+   */
+  map<long,unsigned long> theIndexedParticles;
+
+  /**
+   * The number of objects read in from the indexed file which have
+   * been added to this generator.
+   */
+  unsigned long theRegisteredObjects;
+
+  /**
+   * True while doinitrun() is running.
+   */
+  bool initializingRun;
+
 private:
 
   /**
@@ -15,6 +15,7 @@
 #include "ThePEG/Interface/ClassDocumentation.h"
 #include "ThePEG/Interface/Command.h"
 #include "ThePEG/Interface/Reference.h"
+#include "ThePEG/Interface/Switch.h"
 #include "ThePEG/Repository/BaseRepository.h"
 #include "ThePEG/Persistency/PersistentOStream.h"
 #include "ThePEG/Persistency/PersistentIStream.h"
@@ -145,6 +146,15 @@ void MultiEventGenerator::addTag(string tag) {
 
 
 
+void MultiEventGenerator::
+doGoThreaded(long next, long maxevent, bool tics,
+	     unsigned int nthreads, bool ordered) {
+  if ( theObjects.empty() )
+    EventGenerator::doGoThreaded(next, maxevent, tics, nthreads, ordered);
+  else
+    doGo(next, maxevent, tics);
+}
+
 void MultiEventGenerator::doGo(long next, long maxevent, bool tics) {
 
   if ( theObjects.empty() || next < 0 ) {
@@ -161,6 +171,12 @@ void MultiEventGenerator::doGo(long next, long maxevent, bool tics) {
     interfaces.push_back(BaseRepository::FindInterface(theObjects[i],
 						       theInterfaces[i]));
   }
+  if ( useSubstreams && !random().hasStreams() ) throw Exception()
+    << "The MultiEventGenerator '" << name() << "' was asked to use "
+    << "separate random substreams for each sub-run, but the random "
+    << "number generator '" << random().name() << "' does not support "
+    << "this." << Exception::runerror;
+
   if ( theSeparateRandom ) {
     theSeparateRandom->init();
     theSeparateRandom->initrun();
@@ -202,6 +218,7 @@ void MultiEventGenerator::doGo(long next, long maxevent, bool tics) {
     for_each(objects(), mem_fn(&InterfacedBase::reset));
     
     init();
+    if ( useSubstreams ) random().substream(iargs + 1);
     initrun();
 
     ieve = next-1;
@@ -263,12 +280,12 @@ heading(long iargs, const vector<const InterfaceBase *> & interfaces,
 
 void MultiEventGenerator::persistentOutput(PersistentOStream & os) const {
   os << theObjects << theInterfaces << thePosArgs << theValues
-     << firstSubrun << lastSubrun << theSeparateRandom;
+     << firstSubrun << lastSubrun << theSeparateRandom << useSubstreams;
 }
 
 void MultiEventGenerator::persistentInput(PersistentIStream & is, int) {
   is >> theObjects >> theInterfaces >> thePosArgs >> theValues
-     >> firstSubrun >> lastSubrun >> theSeparateRandom;
+     >> firstSubrun >> lastSubrun >> theSeparateRandom >> useSubstreams;
 }
 
 IVector MultiEventGenerator::getReferences() {
@@ -340,6 +357,24 @@ void MultiEventGenerator::Init() {
      "random generator will be used instead.",
      &MultiEventGenerator::theSeparateRandom, true, false, true, true, false);
 
+  static Switch<MultiEventGenerator,bool> interfaceSubrunStreams
+    ("SubrunStreams",
+     "Use a separate, non-overlapping substream of random numbers for "
+     "each sub-run. This requires a random number generator supporting "
+     "independent streams, such as ThePEG::PhiloxRandom.",
+     &MultiEventGenerator::useSubstreams, false, true, false);
+  static SwitchOption interfaceSubrunStreamsYes
+    (interfaceSubrunStreams,
+     "Yes",
+     "Each sub-run uses its own substream of random numbers.",
+     true);
+  static SwitchOption interfaceSubrunStreamsNo
+    (interfaceSubrunStreams,
+     "No",
+     "The random number generator is restarted with the same seed "
+     "for each sub-run.",
+     false);
+
   interfaceAddInterface.rank(10.7);
   interfaceRemoveInterface.rank(10.5);
 
@@ -40,7 +40,8 @@ public:
   /**
    * Default constructor.
    */
-  MultiEventGenerator(): firstSubrun(0), lastSubrun(0) {}
+  MultiEventGenerator()
+    : firstSubrun(0), lastSubrun(0), useSubstreams(false) {}
 
   /**
    * Destructor.
@@ -65,6 +66,15 @@ protected:
    * EventGenerator::go(long,long,bool).
    */
   virtual void doGo(long next, long maxevent, bool tics);
+
+  /**
+   * Run this EventGenerator session. Is called from
+   * EventGenerator::go(long,long,bool,unsigned int,bool). If
+   * different parameter settings have been specified, the sub-runs
+   * are done one after the other in a single thread.
+   */
+  virtual void doGoThreaded(long next, long maxevent, bool tics,
+			    unsigned int nthreads, bool ordered);
   //@}
 
   /** @name Functions used by the Command<MultiEventGenerator>
@@ -218,6 +228,12 @@ private:
    */
   RanGenPtr theSeparateRandom;
 
+  /**
+   * If true, each sub-run uses its own substream of the random number
+   * generator, rather than restarting the same sequence.
+   */
+  bool useSubstreams;
+
 private:
 
   /**
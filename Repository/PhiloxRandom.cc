@@ -0,0 +1,182 @@
+// -*- C++ -*-
+//
+// PhiloxRandom.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+//
+// This is the implementation of the non-inlined, non-templated member
+// functions of the PhiloxRandom class.
+//
+
+#include "PhiloxRandom.h"
+#include "ThePEG/Interface/ClassDocumentation.h"
+#include "ThePEG/Interface/Parameter.h"
+
+using namespace ThePEG;
+
+namespace {
+
+/** The multipliers and key increments of Philox4x32. */
+const PhiloxRandom::Word M0 = 0xD2511F53;
+const PhiloxRandom::Word M1 = 0xCD9E8D57;
+const PhiloxRandom::Word W0 = 0x9E3779B9;
+const PhiloxRandom::Word W1 = 0xBB67AE85;
+
+/** Convert the upper 53 bits of a 64-bit word to a double in ]0,1[. */
+inline double toDouble(std::uint64_t x) {
+  return ( double(std::int64_t(x >> 11)) + 0.5 )*(1.0/9007199254740992.0);
+}
+
+}
+
+IBPtr PhiloxRandom::clone() const {
+  return new_ptr(*this);
+}
+
+IBPtr PhiloxRandom::fullclone() const {
+  return new_ptr(*this);
+}
+
+PhiloxRandom::Block PhiloxRandom::philox(Block ctr, array<Word,2> key) {
+  typedef std::uint64_t Long;
+  for ( int round = 0; round < 10; ++round ) {
+    if ( round ) {
+      key[0] += W0;
+      key[1] += W1;
+    }
+    Long p0 = Long(M0)*ctr[0];
+    Long p1 = Long(M1)*ctr[2];
+    Block next = {{ Word(p1 >> 32) ^ ctr[1] ^ key[0], Word(p1),
+		    Word(p0 >> 32) ^ ctr[3] ^ key[1], Word(p0) }};
+    ctr = next;
+  }
+  return ctr;
+}
+
+void PhiloxRandom::setSeed(long seed) {
+  if ( seed == -1 ) seed = 19940801;
+  theKey[0] = Word(static_cast<unsigned long>(seed));
+  theKey[1] = Word(static_cast<unsigned long>(seed) >> 16 >> 16);
+  theCounter = 0;
+  flush();
+}
+
+void PhiloxRandom::setStream(unsigned long id) {
+  theStream = Word(id);
+  theSubstream = 0;
+  theCounter = 0;
+  flush();
+}
+
+void PhiloxRandom::setStreamInterface(long id) {
+  setStream(id);
+}
+
+void PhiloxRandom::substream(unsigned long k) {
+  theSubstream = Word(k);
+  theCounter = 0;
+  flush();
+}
+
+void PhiloxRandom::skip(unsigned long n) {
+  unsigned long cached = theNumbers.end() - nextNumber;
+  if ( n <= cached ) {
+    nextNumber += n;
+    gaussSaved = false;
+    return;
+  }
+  theCounter += n - cached;
+  flush();
+}
+
+void PhiloxRandom::generate(unsigned long block, double * r) const {
+  typedef std::uint64_t Long;
+  // The rounds are done for a whole batch of counters at the time in
+  // fixed-size loops, which the compiler can vectorise.
+  Word c0[Batch], c1[Batch], c2[Batch], c3[Batch];
+  for ( int i = 0; i < Batch; ++i ) {
+    c0[i] = Word(block + i);
+    c1[i] = Word((block + i) >> 16 >> 16);
+    c2[i] = Word(theSubstream);
+    c3[i] = Word(theStream);
+  }
+  Word k0 = theKey[0];
+  Word k1 = theKey[1];
+  for ( int round = 0; round < 10; ++round ) {
+    for ( int i = 0; i < Batch; ++i ) {
+      Long p0 = Long(M0)*c0[i];
+      Long p1 = Long(M1)*c2[i];
+      c0[i] = Word(p1 >> 32) ^ c1[i] ^ k0;
+      c1[i] = Word(p1);
+      c2[i] = Word(p0 >> 32) ^ c3[i] ^ k1;
+      c3[i] = Word(p0);
+    }
+    k0 += W0;
+    k1 += W1;
+  }
+  for ( int i = 0; i < Batch; ++i ) {
+    r[2*i] = toDouble(( Long(c0[i]) << 32 ) | c1[i]);
+    r[2*i + 1] = toDouble(( Long(c2[i]) << 32 ) | c3[i]);
+  }
+}
+
+void PhiloxRandom::fill() {
+  RndVector::iterator it = theNumbers.begin();
+  // Full batches can only be used when starting at the beginning of
+  // a block, the rest is done one block at the time.
+  while ( it != theNumbers.end() ) {
+    if ( theCounter%2 == 0 && theNumbers.end() - it >= 2*Batch ) {
+      generate(theCounter/2, &*it);
+      it += 2*Batch;
+      theCounter += 2*Batch;
+      continue;
+    }
+    unsigned long block = theCounter/2;
+    Block ctr = {{ Word(block), Word(block >> 16 >> 16),
+		   Word(theSubstream), Word(theStream) }};
+    Block r = philox(ctr, theKey);
+    for ( int i = theCounter%2; i < 2 && it != theNumbers.end(); ++i ) {
+      *it++ = toDouble(( std::uint64_t(r[2*i]) << 32 ) | r[2*i + 1]);
+      ++theCounter;
+    }
+  }
+  nextNumber = theNumbers.begin();
+}
+
+void PhiloxRandom::persistentOutput(PersistentOStream & os) const {
+  os << theKey << theStream << theSubstream << theCounter;
+}
+
+void PhiloxRandom::persistentInput(PersistentIStream & is, int) {
+  is >> theKey >> theStream >> theSubstream >> theCounter;
+}
+
+ClassDescription<PhiloxRandom> PhiloxRandom::initPhiloxRandom;
+
+void PhiloxRandom::Init() {
+
+  static ClassDocumentation<PhiloxRandom> documentation
+    ("A counter-based random number generator implementing the "
+     "Philox4x32-10 algorithm, with independent, non-overlapping "
+     "streams and substreams.",
+     "Random numbers were generated with the Philox4x32-10 algorithm "
+     "\\cite{Salmon:2011philox}.",
+     "\\bibitem{Salmon:2011philox} J.K. Salmon, M.A. Moraes, R.O. Dror "
+     "and D.E. Shaw, Proc. SC11 (2011) 16.");
+
+  static Parameter<PhiloxRandom,long> interfaceStream
+    ("Stream",
+     "The id of the random number stream to be used. Generators with "
+     "the same seed but different stream ids are guaranteed to give "
+     "non-overlapping sequences of random numbers, which can be used "
+     "to run several jobs in parallel. Threads within a job are "
+     "automatically given different substreams of this stream.",
+     &PhiloxRandom::theStream, 0, 0, 4294967295L, true, false, true,
+     &PhiloxRandom::setStreamInterface);
+
+  interfaceStream.rank(8);
+
+}
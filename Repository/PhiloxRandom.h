@@ -0,0 +1,229 @@
+// -*- C++ -*-
+//
+// PhiloxRandom.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_PhiloxRandom_H
+#define ThePEG_PhiloxRandom_H
+// This is the declaration of the PhiloxRandom class.
+
+#include "RandomGenerator.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include <cstdint>
+
+namespace ThePEG {
+
+/**
+ * PhiloxRandom inherits from the RandomGenerator class and implements
+ * the counter-based Philox4x32-10 algorithm of Salmon et al. (Proc. of
+ * SC11, 2011). Each random number is a pure function of the seed and
+ * of a 128-bit counter, which is here split into a 32-bit stream id,
+ * a 32-bit substream index and a 64-bit position within the
+ * substream. Hence setStream(), substream() and skip() are all done
+ * in constant time, and different streams and substreams are
+ * guaranteed never to overlap.
+ *
+ * Each call to the underlying algorithm gives two random numbers
+ * with 53 random bits each, strictly in the interval \f$]0,1[\f$.
+ *
+ * @see \ref PhiloxRandomInterfaces "The interfaces"
+ * defined for PhiloxRandom.
+ */
+class PhiloxRandom: public RandomGenerator {
+
+public:
+
+  /** The type of the counter and key words. */
+  typedef std::uint32_t Word;
+
+  /** The result of one call to the underlying algorithm. */
+  typedef array<Word,4> Block;
+
+  /** The number of counters processed together when filling the cache. */
+  static const int Batch = 8;
+
+public:
+
+  /** @name Standard constructors and destructors. */
+  //@{
+  /**
+   * Default constructor.
+   */
+  PhiloxRandom()
+    : theKey(), theStream(0), theSubstream(0), theCounter(0) {
+    if ( theSeed != 0 ) setSeed(theSeed);
+  }
+  //@}
+
+public:
+
+  /**
+   * Reset the underlying random algorithm with the given seed and
+   * restart the current substream. If the \a seed is set to -1 a
+   * standard seed will be used.
+   */
+  virtual void setSeed(long seed);
+
+  /** @name Functions for independent random number streams. */
+  //@{
+  /**
+   * This generator supports independent streams.
+   */
+  virtual bool hasStreams() const { return true; }
+
+  /**
+   * Select the stream with the given \a id (which must be less than
+   * \f$2^{32}\f$) and restart it from its first substream.
+   */
+  virtual void setStream(unsigned long id);
+
+  /**
+   * Return the current stream id.
+   */
+  virtual unsigned long stream() const { return theStream; }
+
+  /**
+   * Restart the generator at the beginning of substream \a k (which
+   * must be less than \f$2^{32}\f$) of the current stream.
+   */
+  virtual void substream(unsigned long k);
+
+  /**
+   * Skip the next \a n random numbers in constant time.
+   */
+  virtual void skip(unsigned long n);
+  //@}
+
+  /**
+   * The Philox4x32-10 function mapping the given \a counter and \a
+   * key to four random words.
+   */
+  static Block philox(Block counter, array<Word,2> key);
+
+protected:
+
+  /**
+   * Fill the cache with random numbers.
+   */
+  virtual void fill();
+
+  /**
+   * Generate the 2*Batch random numbers corresponding to Batch
+   * consecutive counters, starting with \a block, in the current
+   * substream, and write them to \a r. Gives the same result as
+   * Batch calls to philox().
+   */
+  void generate(unsigned long block, double * r) const;
+
+public:
+
+  /** @name Functions used by the persistent I/O system. */
+  //@{
+  /**
+   * Function used to write out object persistently.
+   * @param os the persistent output stream written to.
+   */
+  void persistentOutput(PersistentOStream & os) const;
+
+  /**
+   * Function used to read in object persistently.
+   * @param is the persistent input stream read from.
+   * @param version the version number of the object when written.
+   */
+  void persistentInput(PersistentIStream & is, int version);
+  //@}
+
+  /**
+   * Standard Init function used to initialize the interface.
+   */
+  static void Init();
+
+protected:
+
+  /** @name Clone Methods. */
+  //@{
+  /**
+   * Make a simple clone of this object.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr clone() const;
+
+  /** Make a clone of this object, possibly modifying the cloned object
+   * to make it sane.
+   * @return a pointer to the new object.
+   */
+  virtual IBPtr fullclone() const;
+  //@}
+
+private:
+
+  /**
+   * Utility function for the interface.
+   */
+  void setStreamInterface(long id);
+
+private:
+
+  /**
+   * The key derived from the seed.
+   */
+  array<Word,2> theKey;
+
+  /**
+   * The current stream id.
+   */
+  long theStream;
+
+  /**
+   * The current substream index.
+   */
+  unsigned long theSubstream;
+
+  /**
+   * The index of the next random number to be generated in the
+   * current substream. Two numbers are generated for each counter
+   * value.
+   */
+  unsigned long theCounter;
+
+private:
+
+  /**
+   * Describe a concrete class with persistent data.
+   */
+  static ClassDescription<PhiloxRandom> initPhiloxRandom;
+
+  /**
+   *  Private and non-existent assignment operator.
+   */
+  PhiloxRandom & operator=(const PhiloxRandom &) = delete;
+
+};
+
+/** @cond TRAITSPECIALIZATIONS */
+
+/** This template specialization informs ThePEG about the base classes
+ *  of PhiloxRandom. */
+template <>
+struct BaseClassTrait<PhiloxRandom,1>: public ClassTraitsType {
+  /** Typedef of the first base class of PhiloxRandom. */
+  typedef RandomGenerator NthBase;
+};
+
+/** This template specialization informs ThePEG about the name of the
+ *  PhiloxRandom class. */
+template <>
+struct ClassTraits<PhiloxRandom>: public ClassTraitsBase<PhiloxRandom> {
+  /** Return a platform-independent class name */
+  static string className() { return "ThePEG::PhiloxRandom"; }
+};
+
+/** @endcond */
+
+}
+
+#endif /* ThePEG_PhiloxRandom_H */
@@ -75,6 +75,7 @@ void RandomGenerator::doinit() {
 }
 
 void RandomGenerator::setSize(size_type newSize) {
+  theSize = newSize;
   RndVector newNumbers(newSize);
   RndVector::iterator nextNew = newNumbers.end() -
     min( int(theNumbers.end() - nextNumber), int(newSize) );
@@ -85,6 +86,58 @@ void RandomGenerator::setSize(size_type newSize) {
   nextNumber = theNumbers.begin() + pos;
 }
 
+void RandomGenerator::setStream(unsigned long) {
+  throw NoStreams()
+    << "The random number generator '" << name() << "' does not "
+    << "support independent streams." << Exception::runerror;
+}
+
+void RandomGenerator::substream(unsigned long) {
+  throw NoStreams()
+    << "The random number generator '" << name() << "' does not "
+    << "support independent substreams." << Exception::runerror;
+}
+
+void RandomGenerator::skip(unsigned long n) {
+  gaussSaved = false;
+  while ( n-- ) rnd();
+}
+
+void RandomGenerator::rnd(double * r, size_type n) {
+  while ( n ) {
+    if ( nextNumber == theNumbers.end() ) fill();
+    size_type m = min(n, size_type(theNumbers.end() - nextNumber));
+    std::copy(nextNumber, nextNumber + m, r);
+    nextNumber += m;
+    r += m;
+    n -= m;
+  }
+}
+
+void RandomGenerator::rndExp(double * r, size_type n) {
+  rnd(r, n);
+  for ( size_type i = 0; i < n; ++i ) r[i] = -log(r[i]);
+}
+
+void RandomGenerator::rndGauss(double * r, size_type n) {
+  if ( n && gaussSaved ) {
+    gaussSaved = false;
+    *r++ = savedGauss;
+    --n;
+  }
+  // Draw the flat numbers for all complete pairs at once and
+  // transform them in place as in rndGaussTwoNumbers().
+  size_type npair = n/2;
+  rnd(r, 2*npair);
+  for ( size_type i = 0; i < npair; ++i ) {
+    double rad = sqrt(-2.0*log(r[2*i]));
+    double phi = r[2*i + 1]*2.0*Constants::pi;
+    r[2*i] = rad*sin(phi);
+    r[2*i + 1] = rad*cos(phi);
+  }
+  if ( n%2 ) r[n - 1] = rndGauss();
+}
+
 bool RandomGenerator::prndbool(double p) {
   if ( p >= 1.0 ) return true;
   if ( p <= 0.0 ) return false;
@@ -165,8 +218,10 @@ void RandomGenerator::Init() {
 
   static Parameter<RandomGenerator,size_type> interfaceSize
     ("CacheSize",
-     "The Random numbers are generated in chunks of this size.",
-     &RandomGenerator::theSize, 1000, 10, 100000, true, false, true,
+     "The Random numbers are generated in chunks of this size. Larger "
+     "chunks reduce the overhead of refilling the cache, in particular "
+     "when many numbers are drawn at once.",
+     &RandomGenerator::theSize, 1000, 10, 1000000, true, false, true,
      &RandomGenerator::setSize);
 
   static Parameter<RandomGenerator,long> interfaceSeed
@@ -12,6 +12,7 @@
 
 #include "ThePEG/Config/ThePEG.h"
 #include "ThePEG/Interface/Interfaced.h"
+#include "ThePEG/Utilities/Exception.h"
 #include "gsl/gsl_rng.h"
 
 namespace ThePEG {
@@ -30,6 +31,12 @@ namespace ThePEG {
  * classes using the engine returned from the randomGenerator()
  * method.
  *
+ * Sub-classes may in addition support independent streams of random
+ * numbers (see hasStreams()), where each stream is identified by a
+ * stream id and may be further split into substreams. Such streams
+ * are guaranteed not to overlap and can be safely handed out to
+ * different jobs or threads of a parallel run.
+ *
  * @see \ref RandomGeneratorInterfaces "The interfaces"
  * defined for RandomGenerator.
  * @see UseRandom
@@ -70,6 +77,47 @@ public:
    */
   virtual void setSeed(long seed) = 0;
 
+  /** @name Functions for independent random number streams. */
+  //@{
+  /**
+   * Return true if this generator supports independent streams
+   * through setStream() and substream(). The default version returns
+   * false.
+   */
+  virtual bool hasStreams() const { return false; }
+
+  /**
+   * Select the stream with the given \a id and restart it from its
+   * first substream. Different streams from generators with the same
+   * seed are guaranteed not to overlap. The default version throws a
+   * NoStreams exception.
+   */
+  virtual void setStream(unsigned long id);
+
+  /**
+   * Return the current stream id. The default version returns 0.
+   */
+  virtual unsigned long stream() const { return 0; }
+
+  /**
+   * Restart the generator at the beginning of substream \a k of the
+   * current stream. Different substreams of the same stream are
+   * guaranteed not to overlap. The default version throws a
+   * NoStreams exception.
+   */
+  virtual void substream(unsigned long k);
+
+  /**
+   * Skip the next \a n random numbers. The default version simply
+   * draws and discards them, while sub-classes supporting streams
+   * will typically do this in constant time.
+   */
+  virtual void skip(unsigned long n);
+
+  /** Exception class used if streams are not supported. */
+  class NoStreams: public Exception {};
+  //@}
+
   /** @name Functions to return random numbers. */
   //@{
   /**
@@ -100,10 +148,17 @@ public:
    */
   RndVector rndvec(int n) {
     RndVector ret(n);
-    for ( int i = 0; i < n; ++i ) ret[i] = rnd();
+    if ( n > 0 ) rnd(&ret[0], n);
     return ret;
   }
 
+  /**
+   * Fill the array \a r with \a n flat random numbers in the interval
+   * \f$]0,1[\f$. The numbers are copied from the cache in chunks and
+   * are the same as would be given by \a n calls to rnd().
+   */
+  void rnd(double * r, size_type n);
+
   /**
    * Return a (possibly cached) flat random number in the interval
    * \f$]0,1[\f$.
@@ -204,6 +259,13 @@ public:
   template <typename Unit>
   Unit rndExp(Unit mean) { return mean*rndExp(); }
 
+  /**
+   * Fill the array \a r with \a n numbers distributed according to
+   * \f$e^-x\f$. The numbers are the same as would be given by \a n
+   * calls to rndExp().
+   */
+  void rndExp(double * r, size_type n);
+
     /**
    * Return two numbers distributed according to a Gaussian distribution
    * with zero mean and unit variance.
@@ -236,6 +298,14 @@ public:
     return randomNumberOne;
   }
 
+  /**
+   * Fill the array \a r with \a n numbers distributed according to a
+   * Gaussian distribution with zero mean and unit variance. The
+   * numbers are the same as would be given by \a n calls to
+   * rndGauss().
+   */
+  void rndGauss(double * r, size_type n);
+
   /**
    * Return a number distributed according to a Gaussian distribution
    * with a given standard deviation, \a sigma, and a given \a mean.
@@ -290,7 +290,10 @@ protected:
   static MatcherSet & matchers();
 
   /**
-   * All isolated generators mapped to their run name.
+   * All isolated generators mapped to their run name. As the rest of
+   * the Repository this is only meant to be accessed from one thread
+   * during the setup phase. The isolated generators themselves do not
+   * refer back to it and may be run concurrently in different threads.
    */
   static GeneratorMap & generators();
 
@@ -15,6 +15,6 @@
 
 using namespace ThePEG;
 
-vector<RanGenPtr> UseRandom::theRandomStack;
+thread_local vector<RanGenPtr> UseRandom::theRandomStack;
 
 
@@ -24,7 +24,9 @@ namespace ThePEG {
  * object a new UseRandom object can be constructed with a pointer to
  * the desired RandomGenerator object as argument and that object will
  * the be used by the static UseRandom functions until the UseRandom
- * object is destructed.
+ * object is destructed. There is one such stack per thread, so that
+ * several EventGenerators may be run concurrently in different
+ * threads.
  *
  * @see RandomGenerator
  * @see EventGenerator
@@ -273,9 +275,9 @@ public:
 private:
 
   /**
-   * The stack of RandomGenerators requested.
+   * The stack of RandomGenerators requested in the current thread.
    */
-  static vector<RanGenPtr> theRandomStack;
+  static thread_local vector<RanGenPtr> theRandomStack;
 
   /**
    * True if this object is responsible for pushing a RandomGenerator
@@ -0,0 +1,181 @@
+// -*- C++ -*-
+//
+// repositoryTestCFile.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_Repository_Test_CFile_H
+#define ThePEG_Repository_Test_CFile_H
+
+#include <boost/test/unit_test.hpp>
+
+#include "ThePEG/Utilities/CFile.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Helper functions to write a file through CFile and read it back.
+ */
+namespace CFileTest {
+
+using namespace ThePEG;
+
+/*
+ * Return the lines written to the test files. Enough lines are
+ * produced to span several decompression chunks.
+ */
+vector<string> lines() {
+  vector<string> ret;
+  for ( int i = 0; i < 100000; ++i ) {
+    std::ostringstream os;
+    os << "Line " << i << " of the CFile round-trip test: "
+       << string(i%37, char('a' + i%26));
+    ret.push_back(os.str());
+  }
+  return ret;
+}
+
+/*
+ * Return true if the given external command can be run.
+ */
+bool haveCommand(string cmd) {
+  return std::system((cmd + " > /dev/null 2>&1").c_str()) == 0;
+}
+
+/*
+ * Write the given lines to the given file.
+ */
+void write(string file, const vector<string> & data) {
+  CFile f(file, "w");
+  for ( int i = 0, N = data.size(); i < N; ++i ) {
+    f.puts(data[i].c_str());
+    f.puts("\n");
+  }
+  f.close();
+}
+
+/*
+ * Read back all lines in the given file, mixing gets(), getc(),
+ * ungetc() and read() as the readers of Les Houches files do.
+ */
+vector<string> read(string file) {
+  vector<string> ret;
+  CFile f(file, "r");
+  char buff[256];
+  while ( true ) {
+    int c = f.getc();
+    if ( c == EOF ) break;
+    f.ungetc(c);
+    if ( ret.size()%3 == 2 ) {
+      string line;
+      char ch;
+      while ( f.read(&ch, 1) == 1 && ch != '\n' ) line += ch;
+      ret.push_back(line);
+    } else {
+      if ( !f.gets(buff, 256) ) break;
+      string line = buff;
+      if ( !line.empty() && line[line.size() - 1] == '\n' )
+	line.erase(line.size() - 1);
+      ret.push_back(line);
+    }
+  }
+  f.close();
+  return ret;
+}
+
+/*
+ * Write the test lines to a file with the given suffix and check
+ * that they are read back unchanged, both with and without
+ * decompression on a separate thread.
+ */
+void roundTrip(string suffix) {
+  string file = "repositoryTestCFile" + suffix;
+  vector<string> data = lines();
+  write(file, data);
+  for ( int threaded = 0; threaded < 2; ++threaded ) {
+    CFile::threadedDecompression() = threaded;
+    vector<string> back = read(file);
+    BOOST_CHECK_EQUAL(back.size(), data.size());
+    BOOST_CHECK(back == data);
+  }
+  CFile::threadedDecompression() = false;
+  std::remove(file.c_str());
+}
+
+}
+
+/*
+ * Start of boost unit tests for CFile
+ *
+ */
+BOOST_AUTO_TEST_SUITE(repositoryCFile)
+
+BOOST_AUTO_TEST_CASE(plain)
+{
+  CFileTest::roundTrip(".txt");
+}
+
+BOOST_AUTO_TEST_CASE(gzip)
+{
+  CFileTest::roundTrip(".gz");
+}
+
+BOOST_AUTO_TEST_CASE(uncompressedWithSuffix)
+{
+  // Files named as compressed but written as plain text are read as
+  // they are.
+  using namespace ThePEG;
+  vector<string> data = CFileTest::lines();
+  const char * suffixes[] = { ".gz", ".bz2", ".xz", ".zst" };
+  for ( int i = 0; i < 4; ++i ) {
+    string file = string("repositoryTestCFilePlain") + suffixes[i];
+    CFileTest::write(file + ".txt", data);
+    std::rename((file + ".txt").c_str(), file.c_str());
+    for ( int threaded = 0; threaded < 2; ++threaded ) {
+      CFile::threadedDecompression() = threaded;
+      vector<string> back = CFileTest::read(file);
+      BOOST_CHECK_EQUAL(back.size(), data.size());
+      BOOST_CHECK(back == data);
+    }
+    CFile::threadedDecompression() = false;
+    std::remove(file.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bzip2)
+{
+  if ( !CFileTest::haveCommand("bzip2 --help") ) {
+    BOOST_TEST_MESSAGE("bzip2 not found, skipping the bzip2 round-trip test.");
+    return;
+  }
+  CFileTest::roundTrip(".bz2");
+}
+
+BOOST_AUTO_TEST_CASE(xz)
+{
+  if ( !CFileTest::haveCommand("xz --version") ) {
+    BOOST_TEST_MESSAGE("xz not found, skipping the xz round-trip test.");
+    return;
+  }
+  CFileTest::roundTrip(".xz");
+}
+
+BOOST_AUTO_TEST_CASE(zstd)
+{
+  if ( !CFileTest::haveCommand("zstd --version") ) {
+    BOOST_TEST_MESSAGE("zstd not found, skipping the zstd round-trip test.");
+    return;
+  }
+  CFileTest::roundTrip(".zst");
+}
+
+/*
+ * End of boost unit tests for CFile
+ *
+ */
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,205 @@
+// -*- C++ -*-
+//
+// repositoryTestParticleStore.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_Repository_Test_ParticleStore_H
+#define ThePEG_Repository_Test_ParticleStore_H
+
+#include <boost/test/unit_test.hpp>
+
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/EventRecord/Step.h"
+#include "ThePEG/EventRecord/ParticleStore.h"
+#include "ThePEG/PDT/ParticleData.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+
+#include <sstream>
+
+/*
+ * Helper functions to produce particles, with and without an index,
+ * to be put in a ParticleStore.
+ */
+namespace ParticleStoreTest {
+
+using namespace ThePEG;
+
+PPtr makeParticle(tcPDPtr pd, int i) {
+  return pd->produceParticle(LorentzMomentum(ZERO, ZERO, double(i)*GeV,
+					     double(i)*GeV));
+}
+
+/*
+ * Return an event with two incoming particles. Particles in the
+ * event have an index.
+ */
+EventPtr makeEvent(tcPDPtr pd) {
+  return new_ptr(Event(make_pair(makeParticle(pd, 1), makeParticle(pd, 2))));
+}
+
+/*
+ * Add n particles to a new step in the given event and return them.
+ */
+PVector addParticles(tEventPtr event, tcPDPtr pd, int n) {
+  PVector ret;
+  tStepPtr step = event->newStep();
+  for ( int i = 0; i < n; ++i ) {
+    ret.push_back(makeParticle(pd, i + 3));
+    step->addParticle(ret.back());
+  }
+  return ret;
+}
+
+}
+
+/*
+ * Start of boost unit tests for ParticleStore
+ *
+ */
+BOOST_AUTO_TEST_SUITE(repositoryParticleStore)
+
+BOOST_AUTO_TEST_CASE(insertAndFind)
+{
+  using namespace ParticleStoreTest;
+  PDPtr pd = ParticleData::Create(22, "gamma");
+  EventPtr event = makeEvent(pd);
+  PVector indexed = addParticles(event, pd, 100);
+
+  ParticleStore s;
+  PPtr unindexed = makeParticle(pd, 1000);
+  BOOST_CHECK_EQUAL(unindexed->index(), 0);
+  for ( int i = 0, N = indexed.size(); i < N; ++i ) {
+    BOOST_CHECK(indexed[i]->index() > 0);
+    BOOST_CHECK(s.insert(indexed[i]).second);
+    if ( i == N/2 ) BOOST_CHECK(s.insert(unindexed).second);
+  }
+  BOOST_CHECK(!s.insert(indexed[0]).second);
+  BOOST_CHECK(!s.insert(unindexed).second);
+  BOOST_CHECK(!s.insert(PPtr()).second);
+  BOOST_CHECK_EQUAL(s.size(), indexed.size() + 1);
+
+  // The particles are kept in the order they were inserted.
+  ParticleStore::const_iterator it = s.begin();
+  for ( int i = 0, N = indexed.size(); i < N; ++i ) {
+    BOOST_CHECK(*it++ == indexed[i]);
+    if ( i == N/2 ) BOOST_CHECK(*it++ == unindexed);
+  }
+  BOOST_CHECK(it == s.end());
+
+  const ParticleStore & cs = s;
+  for ( int i = 0, N = indexed.size(); i < N; ++i ) {
+    BOOST_CHECK(cs.find(indexed[i]) != cs.end());
+    BOOST_CHECK(*cs.find(indexed[i]) == indexed[i]);
+  }
+  BOOST_CHECK(*cs.find(unindexed) == unindexed);
+  BOOST_CHECK(cs.find(makeParticle(pd, 1001)) == cs.end());
+  BOOST_CHECK(cs.find(tcPPtr()) == cs.end());
+  BOOST_CHECK_EQUAL(cs.count(unindexed), size_t(1));
+
+  // A particle given an index after it was inserted is still found.
+  ParticleStore late;
+  PPtr p = makeParticle(pd, 2000);
+  late.insert(p);
+  event->newStep()->addParticle(p);
+  BOOST_CHECK(p->index() > 0);
+  const ParticleStore & clate = late;
+  BOOST_CHECK(clate.find(p) != clate.end());
+  BOOST_CHECK(late.find(p) != late.end());
+  BOOST_CHECK(clate.find(p) != clate.end());
+}
+
+BOOST_AUTO_TEST_CASE(insertKeepsIterators)
+{
+  using namespace ParticleStoreTest;
+  PDPtr pd = ParticleData::Create(22, "gamma");
+  EventPtr event = makeEvent(pd);
+  ParticleStore s;
+  s.insert(event->incoming().first);
+  s.insert(event->incoming().second);
+  ParticleStore::const_iterator first = s.begin();
+  // Make sure the vector has been reallocated.
+  for ( int i = 0; i < 1000; ++i ) s.insert(makeParticle(pd, i));
+  BOOST_CHECK(first == s.begin());
+  BOOST_CHECK(*first == event->incoming().first);
+  BOOST_CHECK(*++first == event->incoming().second);
+  BOOST_CHECK_EQUAL(s.size(), size_t(1002));
+}
+
+BOOST_AUTO_TEST_CASE(eraseWhileIterating)
+{
+  using namespace ParticleStoreTest;
+  PDPtr pd = ParticleData::Create(22, "gamma");
+  EventPtr event = makeEvent(pd);
+  PVector particles = addParticles(event, pd, 50);
+  ParticleStore s(particles.begin(), particles.end());
+  for ( int i = 0; i < 10; ++i ) s.insert(makeParticle(pd, 100 + i));
+
+  // Erase every other particle.
+  int n = 0;
+  for ( ParticleStore::const_iterator it = s.begin(); it != s.end(); )
+    if ( n++%2 ) s.erase(it++);
+    else ++it;
+  BOOST_CHECK_EQUAL(s.size(), size_t(30));
+  BOOST_CHECK(s.find(particles[0]) != s.end());
+  BOOST_CHECK(s.find(particles[1]) == s.end());
+  BOOST_CHECK_EQUAL(s.erase(particles[1]), size_t(0));
+  int left = 0;
+  for ( ParticleStore::const_iterator it = s.begin(); it != s.end(); ++it )
+    ++left;
+  BOOST_CHECK_EQUAL(left, 30);
+
+  // Erase the rest, including the last one.
+  ParticleStore::const_iterator it = s.begin();
+  while ( it != s.end() ) s.erase(it++);
+  BOOST_CHECK(s.empty());
+  BOOST_CHECK(s.begin() == s.end());
+  BOOST_CHECK(s.find(particles[0]) == s.end());
+
+  // Erased particles can be inserted again.
+  BOOST_CHECK(s.insert(particles[0]).second);
+  BOOST_CHECK(s.find(particles[0]) != s.end());
+  BOOST_CHECK_EQUAL(s.size(), size_t(1));
+}
+
+BOOST_AUTO_TEST_CASE(persistency)
+{
+  using namespace ParticleStoreTest;
+  PDPtr pd = ParticleData::Create(22, "gamma");
+  EventPtr event = makeEvent(pd);
+  ParticleStore s;
+  s.insert(event->incoming().first);
+  s.insert(makeParticle(pd, 3));
+  s.insert(event->incoming().second);
+
+  std::ostringstream os;
+  {
+    PersistentOStream pos(os);
+    pos << s;
+  }
+  ParticleStore r;
+  {
+    std::istringstream is(os.str());
+    PersistentIStream pis(is);
+    pis >> r;
+  }
+  BOOST_REQUIRE_EQUAL(r.size(), s.size());
+  for ( ParticleStore::const_iterator it = s.begin(), rit = r.begin();
+	it != s.end(); ++it, ++rit ) {
+    BOOST_CHECK_EQUAL((**rit).index(), (**it).index());
+    BOOST_CHECK_EQUAL((**rit).id(), (**it).id());
+    BOOST_CHECK_EQUAL((**rit).momentum().z()/GeV, (**it).momentum().z()/GeV);
+    BOOST_CHECK(r.find(*rit) == rit);
+  }
+}
+
+/*
+ * End of boost unit tests for ParticleStore
+ *
+ */
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,148 @@
+// -*- C++ -*-
+//
+// repositoryTestPhiloxRandom.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_Repository_Test_PhiloxRandom_H
+#define ThePEG_Repository_Test_PhiloxRandom_H
+
+#include <boost/test/unit_test.hpp>
+
+#include "ThePEG/Repository/PhiloxRandom.h"
+#include "ThePEG/Repository/StandardRandom.h"
+
+/*
+ * Start of boost unit tests for PhiloxRandom.h
+ *
+ */
+BOOST_AUTO_TEST_SUITE(repositoryPhiloxRandom)
+
+/*
+ * Known answers for Philox4x32-10 from the Random123 distribution.
+ */
+BOOST_AUTO_TEST_CASE(knownAnswers)
+{
+  using ThePEG::PhiloxRandom;
+  PhiloxRandom::Block ctr0 = {{ 0, 0, 0, 0 }};
+  ThePEG::array<PhiloxRandom::Word,2> key0 = {{ 0, 0 }};
+  PhiloxRandom::Block r0 = PhiloxRandom::philox(ctr0, key0);
+  BOOST_CHECK_EQUAL(r0[0], 0x6627e8d5u);
+  BOOST_CHECK_EQUAL(r0[1], 0xe169c58du);
+  BOOST_CHECK_EQUAL(r0[2], 0xbc57ac4cu);
+  BOOST_CHECK_EQUAL(r0[3], 0x9b00dbd8u);
+
+  PhiloxRandom::Block ctr1 = {{ 0xffffffff, 0xffffffff,
+				0xffffffff, 0xffffffff }};
+  ThePEG::array<PhiloxRandom::Word,2> key1 = {{ 0xffffffff, 0xffffffff }};
+  PhiloxRandom::Block r1 = PhiloxRandom::philox(ctr1, key1);
+  BOOST_CHECK_EQUAL(r1[0], 0x408f276du);
+  BOOST_CHECK_EQUAL(r1[1], 0x41c83b0eu);
+  BOOST_CHECK_EQUAL(r1[2], 0xa20bc7c6u);
+  BOOST_CHECK_EQUAL(r1[3], 0x6d5451fdu);
+
+  PhiloxRandom::Block ctr2 = {{ 0x243f6a88, 0x85a308d3,
+				0x13198a2e, 0x03707344 }};
+  ThePEG::array<PhiloxRandom::Word,2> key2 = {{ 0xa4093822, 0x299f31d0 }};
+  PhiloxRandom::Block r2 = PhiloxRandom::philox(ctr2, key2);
+  BOOST_CHECK_EQUAL(r2[0], 0xd16cfe09u);
+  BOOST_CHECK_EQUAL(r2[1], 0x94fdccebu);
+  BOOST_CHECK_EQUAL(r2[2], 0x5001e420u);
+  BOOST_CHECK_EQUAL(r2[3], 0x24126ea1u);
+}
+
+BOOST_AUTO_TEST_CASE(fillMatchesPhilox)
+{
+  // The batched filling of the cache must agree with the plain
+  // algorithm, also when starting in the middle of a block.
+  using ThePEG::PhiloxRandom;
+  PhiloxRandom rng;
+  rng.setSeed(4711);
+  rng.setStream(3);
+  rng.substream(5);
+  rng.skip(3);
+  ThePEG::array<PhiloxRandom::Word,2> key = {{ 4711, 0 }};
+  for ( unsigned long n = 3; n < 2500; ++n ) {
+    PhiloxRandom::Block ctr = {{ PhiloxRandom::Word(n/2), 0, 5, 3 }};
+    PhiloxRandom::Block r = PhiloxRandom::philox(ctr, key);
+    std::uint64_t x = ( std::uint64_t(r[2*(n%2)]) << 32 ) | r[2*(n%2) + 1];
+    BOOST_REQUIRE_EQUAL(rng.rnd(), ( double(x >> 11) + 0.5 )/9007199254740992.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(flatInterval)
+{
+  ThePEG::PhiloxRandom rng;
+  double sum = 0.0;
+  int N = 100000;
+  for ( int i = 0; i < N; ++i ) {
+    double r = rng.rnd();
+    BOOST_REQUIRE(r > 0.0 && r < 1.0);
+    sum += r;
+  }
+  BOOST_CHECK_CLOSE(sum/N, 0.5, 1);
+}
+
+BOOST_AUTO_TEST_CASE(skipAhead)
+{
+  ThePEG::PhiloxRandom a, b;
+  a.setSeed(4711);
+  b.setSeed(4711);
+  // Skip both within and beyond the cache, and an odd number of
+  // numbers so that the next number is in the middle of a block.
+  std::vector<double> ref;
+  for ( int i = 0; i < 5000; ++i ) ref.push_back(a.rnd());
+  b.rnd();
+  b.skip(9);
+  BOOST_CHECK_EQUAL(b.rnd(), ref[10]);
+  b.skip(3210);
+  BOOST_CHECK_EQUAL(b.rnd(), ref[3221]);
+  b.skip(1);
+  BOOST_CHECK_EQUAL(b.rnd(), ref[3223]);
+  b.setSeed(4711);
+  b.skip(4999);
+  BOOST_CHECK_EQUAL(b.rnd(), ref[4999]);
+}
+
+BOOST_AUTO_TEST_CASE(streams)
+{
+  ThePEG::PhiloxRandom a, b;
+  BOOST_CHECK(a.hasStreams());
+  a.setSeed(4711);
+  b.setSeed(4711);
+  BOOST_CHECK_EQUAL(a.rnd(), b.rnd());
+
+  // Different streams and substreams differ.
+  a.setStream(1);
+  b.setStream(2);
+  BOOST_CHECK_EQUAL(a.stream(), 1u);
+  BOOST_CHECK(a.rnd() != b.rnd());
+  b.setStream(1);
+  b.substream(1);
+  a.substream(0);
+  BOOST_CHECK(a.rnd() != b.rnd());
+
+  // Restarting a substream reproduces it, also after a reseed.
+  a.substream(3);
+  double first = a.rnd();
+  a.rnd();
+  a.substream(3);
+  BOOST_CHECK_EQUAL(a.rnd(), first);
+  a.setSeed(4711);
+  BOOST_CHECK_EQUAL(a.rnd(), first);
+
+  // Generators without streams complain.
+  ThePEG::StandardRandom s;
+  BOOST_CHECK(!s.hasStreams());
+  BOOST_CHECK_THROW(s.substream(1), ThePEG::Exception);
+}
+
+/*
+ * End of boost unit tests for PhiloxRandom.h
+ *
+ */
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -340,6 +340,29 @@ BOOST_AUTO_TEST_CASE(rndZeroToOneVector)
   }
 }
 
+BOOST_AUTO_TEST_CASE(rndBulk)
+{
+  // The bulk functions must give the same numbers as repeated calls
+  // to the single-number functions, also across cache refills.
+  ThePEG::StandardRandom ref;
+  rng.setSeed(4711);
+  ref.setSeed(4711);
+  int N = 2501;
+  std::vector<double> bulk(N);
+
+  rng.rnd(&bulk[0], N);
+  for(int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL(bulk[i], ref.rnd());
+
+  rng.rndExp(&bulk[0], N);
+  for(int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL(bulk[i], ref.rndExp());
+
+  // An odd number of Gaussians leaves one saved for the next call.
+  rng.rndGauss(&bulk[0], N);
+  for(int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL(bulk[i], ref.rndGauss());
+  rng.rndGauss(&bulk[0], 4);
+  for(int i = 0; i < 4; ++i) BOOST_REQUIRE_EQUAL(bulk[i], ref.rndGauss());
+}
+
 BOOST_AUTO_TEST_CASE(rndBoolSingleProbability)
 {
   int N = 1000;
@@ -0,0 +1,140 @@
+// -*- C++ -*-
+//
+// repositoryTestSelector.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_Repository_Test_Selector_H
+#define ThePEG_Repository_Test_Selector_H
+
+#include <boost/test/unit_test.hpp>
+
+#include "ThePEG/Utilities/Selector.h"
+#include "ThePEG/Utilities/VSelector.h"
+
+/*
+ * Helper functions to check the selection done by frozen selectors.
+ */
+namespace SelectorTest {
+
+using namespace ThePEG;
+
+/*
+ * The weights used in the tests. The zero weights are placed at the
+ * beginning, in the middle and at the end.
+ */
+vector<double> weights() {
+  double w[] = { 0.0, 1.0, 7.5, 0.5, 0.0, 3.0, 0.001, 12.0, 2.0, 0.0 };
+  return vector<double>(w, w + sizeof(w)/sizeof(double));
+}
+
+/*
+ * Select \a N times from the given frozen selector with evenly
+ * spaced random numbers in ]0,1[ and check that the frequency of each
+ * index matches its weight, that indices with zero weight are never
+ * selected and that the remainder is uniformly distributed in [0,1[.
+ */
+template <typename Sel>
+void checkSelection(const Sel & sel, const vector<double> & w) {
+  BOOST_REQUIRE(sel.frozen());
+  const int N = 1000000;
+  const int nBins = 10;
+  double sum = 0.0;
+  for ( int i = 0, M = w.size(); i < M; ++i ) sum += w[i];
+  vector<long> count(w.size(), 0);
+  vector<long> bins(nBins, 0);
+  vector<double> remSum(w.size(), 0.0);
+  bool inRange = true;
+  for ( int k = 0; k < N; ++k ) {
+    double rem = -1.0;
+    int i = sel.select((k + 0.5)/N, &rem);
+    ++count[i];
+    remSum[i] += rem;
+    if ( rem < 0.0 || rem >= 1.0 ) inRange = false;
+    else ++bins[min(int(rem*nBins), nBins - 1)];
+  }
+  BOOST_CHECK(inRange);
+  for ( int i = 0, M = w.size(); i < M; ++i ) {
+    if ( w[i] == 0.0 ) {
+      BOOST_CHECK_EQUAL(count[i], 0);
+      continue;
+    }
+    // The evenly spaced random numbers give discretization errors of
+    // the order of one count per slot of the alias table.
+    BOOST_CHECK_SMALL(double(count[i])/N - w[i]/sum, 2.0*w.size()/N);
+    BOOST_CHECK_SMALL((remSum[i] - 0.5*count[i])/N, 2.0*w.size()/N);
+  }
+  for ( int b = 0; b < nBins; ++b )
+    BOOST_CHECK_CLOSE_FRACTION(double(bins[b])/N, 1.0/nBins, 1.0e-3);
+}
+
+}
+
+/*
+ * Start of boost unit tests for Selector.h and VSelector.h
+ *
+ */
+BOOST_AUTO_TEST_SUITE(repositorySelector)
+
+BOOST_AUTO_TEST_CASE(frozenSelector)
+{
+  using namespace ThePEG;
+  vector<double> w = SelectorTest::weights();
+  Selector<int> sel;
+  for ( int i = 0, N = w.size(); i < N; ++i ) sel.insert(w[i], i);
+  sel.freeze();
+  SelectorTest::checkSelection(sel, w);
+
+  // Copies of a frozen Selector are frozen, and inserting unfreezes.
+  Selector<int> copy(sel);
+  SelectorTest::checkSelection(copy, w);
+  copy.insert(1.0, 3);
+  BOOST_CHECK(!copy.frozen());
+  w[3] += 1.0;
+  copy.freeze();
+  SelectorTest::checkSelection(copy, w);
+}
+
+BOOST_AUTO_TEST_CASE(frozenVSelector)
+{
+  using namespace ThePEG;
+  vector<double> w = SelectorTest::weights();
+  VSelector<int> sel;
+  // Zero weights can only be set in a VSelector by reweighting.
+  for ( int i = 0, N = w.size(); i < N; ++i )
+    sel.insert(w[i] > 0.0? w[i]: 1.0, i);
+  for ( int i = 0, N = w.size(); i < N; ++i )
+    if ( w[i] == 0.0 ) sel.reweight(0.0, i);
+  sel.freeze();
+  SelectorTest::checkSelection(sel, w);
+
+  // Reweighting unfreezes.
+  sel.reweight(4.0, 0);
+  BOOST_CHECK(!sel.frozen());
+  w[0] = 4.0;
+  sel.freeze();
+  SelectorTest::checkSelection(sel, w);
+}
+
+BOOST_AUTO_TEST_CASE(emptySelector)
+{
+  using namespace ThePEG;
+  Selector<int> sel;
+  sel.freeze();
+  BOOST_CHECK(!sel.frozen());
+  BOOST_CHECK_THROW(sel.select(0.5), std::range_error);
+  VSelector<int> vsel;
+  vsel.freeze();
+  BOOST_CHECK(!vsel.frozen());
+  BOOST_CHECK_THROW(vsel.select(0.5), std::range_error);
+}
+
+/*
+ * End of boost unit tests for Selector.h and VSelector.h
+ *
+ */
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
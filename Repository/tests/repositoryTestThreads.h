@@ -0,0 +1,272 @@
+// -*- C++ -*-
+//
+// repositoryTestThreads.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_Repository_Test_Threads_H
+#define ThePEG_Repository_Test_Threads_H
+
+#include <boost/test/unit_test.hpp>
+
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/CurrentGenerator.h"
+#include "ThePEG/Repository/UseRandom.h"
+#include "ThePEG/Repository/StandardRandom.h"
+#include "ThePEG/Repository/Repository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/Utilities/Debug.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+
+/*
+ * Helper functions to generate a stream of random numbers through the
+ * static UseRandom interface, after having pushed the given generator
+ * on the current stack. Boost checks are not thread safe, so the
+ * results are only collected here and checked in the main thread.
+ */
+namespace ThreadsTest {
+
+typedef std::vector<double> Stream;
+
+const int nrnd = 10000;
+
+ThePEG::RanGenPtr makeRandom(long seed) {
+  ThePEG::RanGenPtr r = ThePEG::new_ptr(ThePEG::StandardRandom());
+  r->setSeed(seed);
+  return r;
+}
+
+void generate(ThePEG::RanGenPtr r, Stream & s, std::atomic<int> * start = 0) {
+  ThePEG::UseRandom use(r);
+  // Make sure the threads are running concurrently.
+  if ( start ) {
+    --*start;
+    while ( *start > 0 );
+  }
+  s.clear();
+  for ( int i = 0; i < nrnd; ++i ) {
+    switch ( i%3 ) {
+    case 0: s.push_back(ThePEG::UseRandom::rnd()); break;
+    case 1: s.push_back(ThePEG::UseRandom::rndExp()); break;
+    case 2: s.push_back(double(ThePEG::UseRandom::irnd(1000000))); break;
+    }
+  }
+}
+
+void followGenerator(ThePEG::EGPtr eg, int & nwrong, std::atomic<int> * start) {
+  nwrong = ThePEG::CurrentGenerator::isVoid()? 0: 1;
+  ThePEG::CurrentGenerator use(eg);
+  --*start;
+  while ( *start > 0 );
+  for ( int i = 0; i < nrnd; ++i )
+    if ( ThePEG::CurrentGenerator::ptr() != eg.operator->() ) ++nwrong;
+}
+
+/*
+ * The default repository built in the src directory, which is used
+ * to set up full event generators. It is only available if make has
+ * been run in the src directory before the tests.
+ */
+const std::string defaultRepository = "../src/ThePEGDefaults.rpo";
+
+const int nevents = 200;
+
+/*
+ * Return an isolated copy of the SimpleLEPGenerator in the default
+ * repository with the given run name and random seed.
+ */
+ThePEG::EGPtr makeLEP(std::string name, long seed) {
+  using namespace ThePEG;
+  tEGPtr eg =
+    Repository::GetObject<tEGPtr>("/Defaults/Generators/SimpleLEPGenerator");
+  if ( !eg ) return EGPtr();
+  EGPtr run = Repository::makeRun(eg, name);
+  run->setSeed(seed);
+  BaseRepository::FindInterface(run, "NumberOfEvents")
+    ->exec(*run, "set", std::to_string(nevents));
+  return run;
+}
+
+/*
+ * Initialize the given generator and generate events, saving the
+ * weight, particle content and momenta of each event in the stream.
+ */
+void generateEvents(ThePEG::EGPtr eg, Stream & s, std::string & error,
+		    std::atomic<int> * start = 0) {
+  using namespace ThePEG;
+  if ( start ) {
+    --*start;
+    while ( *start > 0 );
+  }
+  s.clear();
+  try {
+    eg->initialize();
+    for ( int i = 0; i < nevents; ++i ) {
+      EventPtr event = eg->shoot();
+      if ( !event ) break;
+      s.push_back(event->number());
+      s.push_back(event->weight());
+      tPVector fs = event->getFinalState();
+      s.push_back(double(fs.size()));
+      for ( int j = 0, N = fs.size(); j < N; ++j ) {
+	s.push_back(double(fs[j]->id()));
+	s.push_back(fs[j]->momentum().x()/GeV);
+	s.push_back(fs[j]->momentum().y()/GeV);
+	s.push_back(fs[j]->momentum().z()/GeV);
+	s.push_back(fs[j]->momentum().e()/GeV);
+      }
+    }
+    eg->finalize();
+  }
+  catch ( std::exception & e ) {
+    error = e.what();
+  }
+  catch ( ... ) {
+    error = "unknown exception";
+  }
+}
+
+void removeFiles(std::string name) {
+  const char * suffix[] = { ".log", ".out", ".tex", ".dump" };
+  for ( int i = 0; i < 4; ++i ) std::remove((name + suffix[i]).c_str());
+}
+
+void followDebug(int level, int & nwrong, std::atomic<int> * start) {
+  nwrong = ThePEG::Debug::level == ThePEG::Debug::noDebug? 0: 1;
+  ThePEG::Debug::level = level;
+  --*start;
+  while ( *start > 0 );
+  for ( int i = 0; i < nrnd; ++i )
+    if ( ThePEG::Debug::level != level ) ++nwrong;
+    else ThePEG::Debug::level = level;
+}
+
+}
+
+/*
+ * Start of boost unit tests for running generators concurrently
+ *
+ */
+BOOST_AUTO_TEST_SUITE(repositoryThreads)
+
+BOOST_AUTO_TEST_CASE(randomStreamsBitIdentical)
+{
+  using namespace ThreadsTest;
+  ThePEG::RandomGenerator * global = &ThePEG::UseRandom::current();
+
+  Stream serial1, serial2;
+  generate(makeRandom(4711), serial1);
+  generate(makeRandom(1234), serial2);
+  BOOST_CHECK_EQUAL(serial1.size(), size_t(nrnd));
+  BOOST_CHECK(serial1 != serial2);
+
+  Stream thread1, thread2;
+  std::atomic<int> start(2);
+  std::thread t1(generate, makeRandom(4711), std::ref(thread1), &start);
+  std::thread t2(generate, makeRandom(1234), std::ref(thread2), &start);
+  t1.join();
+  t2.join();
+
+  BOOST_CHECK(thread1 == serial1);
+  BOOST_CHECK(thread2 == serial2);
+  BOOST_CHECK_EQUAL(&ThePEG::UseRandom::current(), global);
+}
+
+BOOST_AUTO_TEST_CASE(currentGeneratorPerThread)
+{
+  using namespace ThreadsTest;
+  BOOST_CHECK(ThePEG::CurrentGenerator::isVoid());
+
+  ThePEG::EGPtr eg1 = ThePEG::new_ptr(ThePEG::EventGenerator());
+  ThePEG::EGPtr eg2 = ThePEG::new_ptr(ThePEG::EventGenerator());
+  ThePEG::CurrentGenerator use(eg1);
+
+  int nwrong1 = -1, nwrong2 = -1;
+  std::atomic<int> start(2);
+  std::thread t1(followGenerator, eg1, std::ref(nwrong1), &start);
+  std::thread t2(followGenerator, eg2, std::ref(nwrong2), &start);
+  t1.join();
+  t2.join();
+
+  BOOST_CHECK_EQUAL(nwrong1, 0);
+  BOOST_CHECK_EQUAL(nwrong2, 0);
+  BOOST_CHECK_EQUAL(ThePEG::CurrentGenerator::ptr(), eg1.operator->());
+}
+
+BOOST_AUTO_TEST_CASE(debugLevelPerThread)
+{
+  using namespace ThreadsTest;
+  int level = ThePEG::Debug::level;
+
+  int nwrong1 = -1, nwrong2 = -1;
+  std::atomic<int> start(2);
+  std::thread t1(followDebug, int(ThePEG::Debug::printSomeEvents),
+		 std::ref(nwrong1), &start);
+  std::thread t2(followDebug, int(ThePEG::Debug::full),
+		 std::ref(nwrong2), &start);
+  t1.join();
+  t2.join();
+
+  BOOST_CHECK_EQUAL(nwrong1, 0);
+  BOOST_CHECK_EQUAL(nwrong2, 0);
+  BOOST_CHECK_EQUAL(ThePEG::Debug::level, level);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentGeneratorsBitIdentical)
+{
+  using namespace ThreadsTest;
+  if ( !std::ifstream(defaultRepository.c_str()) ) {
+    BOOST_TEST_MESSAGE("No default repository found in '" << defaultRepository
+		       << "', skipping concurrent event generation test.");
+    return;
+  }
+  ThePEG::DynamicLoader::appendPath("../lib");
+  std::string msg = ThePEG::Repository::load(defaultRepository);
+  BOOST_REQUIRE_MESSAGE(msg.empty(), msg);
+
+  // The two generators have different seeds, and are first run one
+  // after the other.
+  Stream serial1, serial2;
+  std::string error1, error2;
+  generateEvents(makeLEP("ThreadsTestLEP1", 4711), serial1, error1);
+  generateEvents(makeLEP("ThreadsTestLEP2", 1234), serial2, error2);
+  BOOST_REQUIRE_MESSAGE(error1.empty(), error1);
+  BOOST_REQUIRE_MESSAGE(error2.empty(), error2);
+  BOOST_CHECK(serial1.size() > size_t(nevents));
+  BOOST_CHECK(serial1 != serial2);
+
+  // Then new copies of the same generators are run concurrently.
+  ThePEG::EGPtr eg1 = makeLEP("ThreadsTestLEP1", 4711);
+  ThePEG::EGPtr eg2 = makeLEP("ThreadsTestLEP2", 1234);
+  Stream thread1, thread2;
+  std::atomic<int> start(2);
+  std::thread t1(generateEvents, eg1, std::ref(thread1), std::ref(error1),
+		 &start);
+  std::thread t2(generateEvents, eg2, std::ref(thread2), std::ref(error2),
+		 &start);
+  t1.join();
+  t2.join();
+  BOOST_CHECK_MESSAGE(error1.empty(), error1);
+  BOOST_CHECK_MESSAGE(error2.empty(), error2);
+
+  BOOST_CHECK(thread1 == serial1);
+  BOOST_CHECK(thread2 == serial2);
+  removeFiles("ThreadsTestLEP1");
+  removeFiles("ThreadsTestLEP2");
+}
+
+/*
+ * End of boost unit tests for running generators concurrently
+ *
+ */
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
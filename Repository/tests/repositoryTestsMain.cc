@@ -26,6 +26,11 @@
  * Include here the sub tests
  */
 #include "ThePEG/Repository/tests/repositoryTestRandomGenerator.h"
+#include "ThePEG/Repository/tests/repositoryTestPhiloxRandom.h"
+#include "ThePEG/Repository/tests/repositoryTestThreads.h"
+#include "ThePEG/Repository/tests/repositoryTestParticleStore.h"
+#include "ThePEG/Repository/tests/repositoryTestCFile.h"
+#include "ThePEG/Repository/tests/repositoryTestSelector.h"
 
 
 /**
@@ -0,0 +1,143 @@
+// -*- C++ -*-
+//
+// AliasTable.h is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+#ifndef ThePEG_AliasTable_H
+#define ThePEG_AliasTable_H
+// This is the declaration of the AliasTable class.
+
+#include "ThePEG/Config/ThePEG.h"
+
+namespace ThePEG {
+
+/**
+ * AliasTable implements Walker's alias method (in the formulation of
+ * Vose) for selecting one of a fixed set of indices according to
+ * given weights in constant time, using one flat random number. The
+ * table is divided into as many equal slots as there are indices.
+ * Each slot holds the probability of its own index and an alias
+ * index, which is selected if the random number falls in the rest of
+ * the slot.
+ *
+ * AliasTable is used by Selector and VSelector when they are frozen.
+ *
+ * @see Selector
+ * @see VSelector
+ */
+class AliasTable {
+
+public:
+
+  /** The size type used for the indices. */
+  typedef vector<double>::size_type size_type;
+
+public:
+
+  /**
+   * Build the table for the given (non-negative) weights, which need
+   * not be normalized. Indices with zero weight are never selected.
+   * If the weights do not have a positive finite sum, the table is
+   * left empty.
+   */
+  void build(const vector<double> & weights) {
+    clear();
+    size_type n = weights.size();
+    double sum = 0.0;
+    for ( size_type i = 0; i < n; ++i ) sum += weights[i];
+    if ( !( sum > 0.0 && sum < Constants::MaxDouble ) ) return;
+    theProbabilities.resize(n);
+    theAliases.resize(n);
+    vector<size_type> small, large;
+    for ( size_type i = 0; i < n; ++i ) {
+      theProbabilities[i] = weights[i]*n/sum;
+      theAliases[i] = i;
+      if ( theProbabilities[i] < 1.0 ) small.push_back(i);
+      else large.push_back(i);
+    }
+    while ( !small.empty() && !large.empty() ) {
+      size_type s = small.back();
+      size_type l = large.back();
+      small.pop_back();
+      theAliases[s] = l;
+      theProbabilities[l] -= 1.0 - theProbabilities[s];
+      if ( theProbabilities[l] < 1.0 ) {
+	large.pop_back();
+	small.push_back(l);
+      }
+    }
+    // Whatever is left is due to rounding errors and should be full.
+    for ( size_type i = 0; i < large.size(); ++i )
+      theProbabilities[large[i]] = 1.0;
+    for ( size_type i = 0; i < small.size(); ++i )
+      if ( theAliases[small[i]] == small[i] )
+	theProbabilities[small[i]] = 1.0;
+  }
+
+  /**
+   * Select an index given a random number \a rnd in the interval
+   * ]0,1[. If \a remainder is non-zero the double pointed to will be
+   * set to a uniform random number in the interval [0,1[ calculated
+   * from the fraction of \a rnd which was in the range of the selected
+   * index. The table must not be empty.
+   */
+  size_type select(double rnd, double * remainder = 0) const {
+    double x = rnd*theProbabilities.size();
+    size_type i = min(size_type(x), theProbabilities.size() - 1);
+    double f = x - i;
+    double p = theProbabilities[i];
+    if ( f < p ) {
+      if ( remainder ) *remainder = f/p;
+      return i;
+    }
+    if ( remainder ) *remainder = (f - p)/(1.0 - p);
+    return theAliases[i];
+  }
+
+  /**
+   * Return true if the table has not been built.
+   */
+  bool empty() const { return theProbabilities.empty(); }
+
+  /**
+   * Return the number of indices in the table.
+   */
+  size_type size() const { return theProbabilities.size(); }
+
+  /**
+   * Remove the table.
+   */
+  void clear() {
+    theProbabilities.clear();
+    theAliases.clear();
+  }
+
+  /**
+   * Swap the table with the argument.
+   */
+  void swap(AliasTable & t) {
+    theProbabilities.swap(t.theProbabilities);
+    theAliases.swap(t.theAliases);
+  }
+
+private:
+
+  /**
+   * The probability of selecting the index of each slot rather than
+   * its alias.
+   */
+  vector<double> theProbabilities;
+
+  /**
+   * The alias index of each slot.
+   */
+  vector<size_type> theAliases;
+
+};
+
+}
+
+#endif /* ThePEG_AliasTable_H */
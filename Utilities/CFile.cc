@@ -17,22 +17,599 @@
 #include <cstdio>
 #include "Throw.h"
 #include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
 
 #ifdef HAVE_LIBZ
 #include <zlib.h>
 #else
 typedef void * gzFile;
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
+#ifdef HAVE_LIBBZ2
 #include <bzlib.h>
-#else
-typedef void BZFILE;
+#endif
+#ifdef HAVE_LIBLZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
 #endif
 
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * The codecs which can be used by a DecompressStream.
+ */
+enum Codec { noCodec, gzipCodec, bzip2Codec, xzCodec, zstdCodec };
+
+/**
+ * Return the codec indicated by the suffix of the given file name,
+ * whether or not the corresponding library is available.
+ */
+Codec suffixCodec(const string & filename) {
+  string::size_type n = filename.length();
+  if ( n > 3 && filename.substr(n - 3) == ".gz" ) return gzipCodec;
+  if ( n > 4 && filename.substr(n - 4) == ".bz2" ) return bzip2Codec;
+  if ( n > 3 && filename.substr(n - 3) == ".xz" ) return xzCodec;
+  if ( n > 4 && filename.substr(n - 4) == ".zst" ) return zstdCodec;
+  return noCodec;
+}
+
+/**
+ * Return the codec to use for the given file name, or noCodec if
+ * the corresponding library is not available.
+ */
+Codec codecFor(const string & filename) {
+  switch ( suffixCodec(filename) ) {
+#ifdef HAVE_LIBZ
+  case gzipCodec: return gzipCodec;
+#endif
+#ifdef HAVE_LIBBZ2
+  case bzip2Codec: return bzip2Codec;
+#endif
+#ifdef HAVE_LIBLZMA
+  case xzCodec: return xzCodec;
+#endif
+#ifdef HAVE_LIBZSTD
+  case zstdCodec: return zstdCodec;
+#endif
+  default: return noCodec;
+  }
+}
+
+/**
+ * Return true if the given file starts with the magic bytes of the
+ * given codec. The file is left positioned at its beginning.
+ */
+bool hasMagic(FILE * f, Codec c) {
+  static const unsigned char gzMagic[] = { 0x1f, 0x8b };
+  static const unsigned char bz2Magic[] = { 'B', 'Z', 'h' };
+  static const unsigned char xzMagic[] = { 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+  static const unsigned char zstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+  const unsigned char * magic = 0;
+  size_t n = 0;
+  switch ( c ) {
+  case gzipCodec: magic = gzMagic; n = sizeof(gzMagic); break;
+  case bzip2Codec: magic = bz2Magic; n = sizeof(bz2Magic); break;
+  case xzCodec: magic = xzMagic; n = sizeof(xzMagic); break;
+  case zstdCodec: magic = zstdMagic; n = sizeof(zstdMagic); break;
+  default: return false;
+  }
+  unsigned char head[8];
+  size_t nread = fread(head, 1, n, f);
+  rewind(f);
+  return nread == n && std::equal(magic, magic + n, head);
+}
+
+/**
+ * If the given file has a compression suffix but is not actually
+ * compressed, open and return it for plain reading, otherwise
+ * return null.
+ */
+FILE * openUncompressed(const string & filename) {
+  Codec c = suffixCodec(filename);
+  if ( c == noCodec ) return 0;
+  FILE * f = fopen(filename.c_str(), "rb");
+  if ( !f ) return 0;
+  if ( !hasMagic(f, c) ) return f;
+  fclose(f);
+  return 0;
+}
+
+/**
+ * DecompressStream reads a compressed file in large chunks and
+ * decompresses it in-process, optionally on a separate thread, giving
+ * access to the uncompressed data through C-style read functions.
+ * Concatenated compressed streams are handled for all codecs.
+ */
+class DecompressStream {
+
+public:
+
+  /** The size of the chunks of uncompressed data. */
+  static const size_t chunkSize = 1 << 20;
+
+  /** The size of the buffer of compressed data. */
+  static const size_t inSize = 1 << 18;
+
+  /** The number of chunks which may be decompressed in advance. */
+  static const size_t maxChunks = 4;
+
+  /**
+   * Decompress the given file, opened from \a filename, with the
+   * given codec. If \a threaded is true, decompression is done on a
+   * separate thread.
+   */
+  DecompressStream(FILE * f, string filename, Codec c, bool threaded)
+    : file(f), name(filename), codec(c), in(inSize), inPtr(0), inAvail(0),
+      inEOF(false), finished(false), failed(false), warned(false),
+      pos(0), len(0), isThreaded(threaded), producerDone(false),
+      stopProducer(false) {
+    if ( !initCodec() ) {
+      failed = finished = true;
+      return;
+    }
+    if ( isThreaded ) producer = std::thread(&DecompressStream::produce, this);
+  }
+
+  /**
+   * The destructor stops the decompression thread and closes the file.
+   */
+  ~DecompressStream() {
+    if ( producer.joinable() ) {
+      {
+	std::lock_guard<std::mutex> lock(mutex);
+	stopProducer = true;
+      }
+      spaceAvailable.notify_all();
+      producer.join();
+    }
+    endCodec();
+    fclose(file);
+  }
+
+  /**
+   * Return true if the codec could not be initialized or if the
+   * decompression has failed.
+   */
+  bool error() const { return failed; }
+
+  /**
+   * Read up to \a n bytes into \a ptr, returning the number of bytes read.
+   */
+  size_t read(char * ptr, size_t n) {
+    size_t done = 0;
+    while ( done < n && !pushback.empty() ) {
+      ptr[done++] = pushback.back();
+      pushback.erase(pushback.size() - 1);
+    }
+    while ( done < n ) {
+      if ( pos == len && !fill() ) break;
+      size_t m = min(n - done, len - pos);
+      std::memcpy(ptr + done, &current[pos], m);
+      pos += m;
+      done += m;
+    }
+    return done;
+  }
+
+  /**
+   * Return the next character, or EOF.
+   */
+  int getc() {
+    if ( !pushback.empty() ) {
+      int c = static_cast<unsigned char>(pushback.back());
+      pushback.erase(pushback.size() - 1);
+      return c;
+    }
+    if ( pos == len && !fill() ) return EOF;
+    return static_cast<unsigned char>(current[pos++]);
+  }
+
+  /**
+   * Push back the character \a c.
+   */
+  int ungetc(int c) {
+    if ( c == EOF ) return EOF;
+    if ( pushback.empty() && pos > 0 ) current[--pos] = char(c);
+    else pushback += char(c);
+    return c;
+  }
+
+  /**
+   * Read a line of at most \a size - 1 characters into \a s, as fgets().
+   */
+  char * gets(char * s, int size) {
+    if ( size <= 0 ) return 0;
+    int n = 0;
+    while ( n < size - 1 ) {
+      if ( !pushback.empty() ) {
+	char c = pushback.back();
+	pushback.erase(pushback.size() - 1);
+	s[n++] = c;
+	if ( c == '\n' ) break;
+	continue;
+      }
+      if ( pos == len && !fill() ) break;
+      // Copy up to and including the next newline directly from the chunk.
+      size_t m = min(size_t(size - 1 - n), len - pos);
+      const char * start = &current[pos];
+      const char * nl = static_cast<const char *>(std::memchr(start, '\n', m));
+      if ( nl ) m = nl - start + 1;
+      std::memcpy(s + n, start, m);
+      pos += m;
+      n += m;
+      if ( nl ) break;
+    }
+    if ( n == 0 ) return 0;
+    s[n] = '\0';
+    return s;
+  }
+
+private:
+
+  /**
+   * Make the next chunk of uncompressed data current. Return false
+   * if there is no more data.
+   */
+  bool fill() {
+    pos = len = 0;
+    if ( !isThreaded ) {
+      if ( current.size() < chunkSize ) current.resize(chunkSize);
+      len = decompress(&current[0], chunkSize);
+      if ( len == 0 ) warnIfFailed();
+      return len > 0;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    dataAvailable.wait(lock, [this]{ return !ready.empty() || producerDone; });
+    if ( ready.empty() ) {
+      lock.unlock();
+      warnIfFailed();
+      return false;
+    }
+    if ( !current.empty() ) spare.push_back(std::move(current));
+    current = std::move(ready.front());
+    ready.pop_front();
+    len = current.size();
+    spaceAvailable.notify_one();
+    return len > 0;
+  }
+
+  /**
+   * Issue a warning if the end of the data was reached because the
+   * decompression failed.
+   */
+  void warnIfFailed() {
+    if ( !failed || warned ) return;
+    warned = true;
+    Throw<CFile::FileError>()
+      << "Decompression of " << name << " failed. The file may be "
+      << "truncated or corrupt." << Exception::warning;
+  }
+
+  /**
+   * The function run by the decompression thread.
+   */
+  void produce() {
+    while ( true ) {
+      vector<char> chunk;
+      {
+	std::unique_lock<std::mutex> lock(mutex);
+	spaceAvailable.wait(lock, [this]{
+	    return ready.size() < maxChunks || stopProducer; });
+	if ( stopProducer ) break;
+	if ( !spare.empty() ) {
+	  chunk = std::move(spare.back());
+	  spare.pop_back();
+	}
+      }
+      chunk.resize(chunkSize);
+      size_t n = decompress(&chunk[0], chunkSize);
+      chunk.resize(n);
+      std::lock_guard<std::mutex> lock(mutex);
+      if ( n > 0 ) ready.push_back(std::move(chunk));
+      if ( n == 0 ) break;
+      dataAvailable.notify_one();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    producerDone = true;
+    dataAvailable.notify_all();
+  }
+
+  /**
+   * Decompress up to \a n bytes into \a out, returning the number of
+   * bytes produced. Returns 0 only at the end of the file or on error.
+   */
+  size_t decompress(char * out, size_t n) {
+    size_t produced = 0;
+    while ( produced < n && !finished ) {
+      if ( inAvail == 0 && !inEOF ) refill();
+      size_t consumed = 0;
+      size_t made = 0;
+      int status = step(inPtr, inAvail, out + produced, n - produced,
+			consumed, made);
+      inPtr += consumed;
+      inAvail -= consumed;
+      produced += made;
+      if ( status < 0 ) {
+	failed = finished = true;
+      }
+      else if ( status > 0 ) {
+	// End of a compressed stream. Continue if another one follows.
+	if ( inAvail == 0 && !inEOF ) refill();
+	if ( inAvail == 0 ) finished = true;
+	else if ( !resetCodec() ) failed = finished = true;
+      }
+      else if ( consumed == 0 && made == 0 && inAvail == 0 && inEOF ) {
+	// The file was truncated.
+	failed = finished = true;
+      }
+    }
+    return produced;
+  }
+
+  /**
+   * Read the next block of compressed data.
+   */
+  void refill() {
+    inAvail = fread(&in[0], 1, in.size(), file);
+    inPtr = &in[0];
+    if ( inAvail == 0 ) inEOF = true;
+  }
+
+  /**
+   * Run the codec on the given input and output buffers, returning
+   * the number of bytes \a consumed and \a made. Returns 1 at the end
+   * of a compressed stream, -1 on error and 0 otherwise.
+   */
+  int step(const char * src, size_t nsrc, char * dst, size_t ndst,
+	   size_t & consumed, size_t & made) {
+    switch ( codec ) {
+#ifdef HAVE_LIBZ
+    case gzipCodec: {
+      zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(src));
+      zs.avail_in = nsrc;
+      zs.next_out = reinterpret_cast<Bytef *>(dst);
+      zs.avail_out = ndst;
+      int ret = inflate(&zs, Z_NO_FLUSH);
+      consumed = nsrc - zs.avail_in;
+      made = ndst - zs.avail_out;
+      if ( ret == Z_STREAM_END ) return 1;
+      if ( ret == Z_BUF_ERROR && ( consumed || made || nsrc == 0 ) ) return 0;
+      return ret == Z_OK? 0: -1;
+    }
+#endif
+#ifdef HAVE_LIBBZ2
+    case bzip2Codec: {
+      bzs.next_in = const_cast<char *>(src);
+      bzs.avail_in = nsrc;
+      bzs.next_out = dst;
+      bzs.avail_out = ndst;
+      int ret = BZ2_bzDecompress(&bzs);
+      consumed = nsrc - bzs.avail_in;
+      made = ndst - bzs.avail_out;
+      if ( ret == BZ_STREAM_END ) return 1;
+      return ret == BZ_OK? 0: -1;
+    }
+#endif
+#ifdef HAVE_LIBLZMA
+    case xzCodec: {
+      xzs.next_in = reinterpret_cast<const uint8_t *>(src);
+      xzs.avail_in = nsrc;
+      xzs.next_out = reinterpret_cast<uint8_t *>(dst);
+      xzs.avail_out = ndst;
+      lzma_ret ret = lzma_code(&xzs, inEOF? LZMA_FINISH: LZMA_RUN);
+      consumed = nsrc - xzs.avail_in;
+      made = ndst - xzs.avail_out;
+      if ( ret == LZMA_STREAM_END ) return 1;
+      if ( ret == LZMA_BUF_ERROR && ( consumed || made ) ) return 0;
+      return ret == LZMA_OK? 0: -1;
+    }
+#endif
+#ifdef HAVE_LIBZSTD
+    case zstdCodec: {
+      ZSTD_inBuffer ib = { src, nsrc, 0 };
+      ZSTD_outBuffer ob = { dst, ndst, 0 };
+      size_t ret = ZSTD_decompressStream(zstds, &ob, &ib);
+      consumed = ib.pos;
+      made = ob.pos;
+      if ( ZSTD_isError(ret) ) return -1;
+      // A zero return means a frame was completely decoded and flushed.
+      return ret == 0? 1: 0;
+    }
+#endif
+    default:
+      return -1;
+    }
+  }
+
+  /**
+   * Initialize the codec.
+   */
+  bool initCodec() {
+    switch ( codec ) {
+#ifdef HAVE_LIBZ
+    case gzipCodec:
+      std::memset(&zs, 0, sizeof(zs));
+      // Automatic detection of gzip or zlib headers.
+      return inflateInit2(&zs, 15 + 32) == Z_OK;
+#endif
+#ifdef HAVE_LIBBZ2
+    case bzip2Codec:
+      std::memset(&bzs, 0, sizeof(bzs));
+      return BZ2_bzDecompressInit(&bzs, 0, 0) == BZ_OK;
+#endif
+#ifdef HAVE_LIBLZMA
+    case xzCodec:
+      xzs = LZMA_STREAM_INIT;
+      return lzma_stream_decoder(&xzs, UINT64_MAX, LZMA_CONCATENATED)
+	== LZMA_OK;
+#endif
+#ifdef HAVE_LIBZSTD
+    case zstdCodec:
+      zstds = ZSTD_createDStream();
+      return zstds && !ZSTD_isError(ZSTD_initDStream(zstds));
+#endif
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * Prepare the codec for a new concatenated compressed stream.
+   */
+  bool resetCodec() {
+    switch ( codec ) {
+#ifdef HAVE_LIBZ
+    case gzipCodec:
+      return inflateReset(&zs) == Z_OK;
+#endif
+#ifdef HAVE_LIBBZ2
+    case bzip2Codec:
+      BZ2_bzDecompressEnd(&bzs);
+      return initCodec();
+#endif
+    default:
+      // xz and zstd handle concatenated streams themselves.
+      return true;
+    }
+  }
+
+  /**
+   * Release the resources used by the codec.
+   */
+  void endCodec() {
+    switch ( codec ) {
+#ifdef HAVE_LIBZ
+    case gzipCodec:
+      inflateEnd(&zs);
+      break;
+#endif
+#ifdef HAVE_LIBBZ2
+    case bzip2Codec:
+      BZ2_bzDecompressEnd(&bzs);
+      break;
+#endif
+#ifdef HAVE_LIBLZMA
+    case xzCodec:
+      lzma_end(&xzs);
+      break;
+#endif
+#ifdef HAVE_LIBZSTD
+    case zstdCodec:
+      ZSTD_freeDStream(zstds);
+      break;
+#endif
+    default:
+      break;
+    }
+  }
+
+private:
+
+  /** The compressed file. */
+  FILE * file;
+
+  /** The name of the compressed file. */
+  string name;
+
+  /** The codec used. */
+  Codec codec;
+
+#ifdef HAVE_LIBZ
+  /** The zlib state. */
+  z_stream zs;
+#endif
+#ifdef HAVE_LIBBZ2
+  /** The libbz2 state. */
+  bz_stream bzs;
+#endif
+#ifdef HAVE_LIBLZMA
+  /** The liblzma state. */
+  lzma_stream xzs;
+#endif
+#ifdef HAVE_LIBZSTD
+  /** The libzstd state. */
+  ZSTD_DStream * zstds;
+#endif
+
+  /** The buffer of compressed data. */
+  vector<char> in;
+
+  /** The next compressed byte to be used. */
+  const char * inPtr;
+
+  /** The number of compressed bytes left in the buffer. */
+  size_t inAvail;
+
+  /** True if the end of the compressed file has been reached. */
+  bool inEOF;
+
+  /** True if no more data can be decompressed. */
+  bool finished;
+
+  /** True if the decompression failed. */
+  bool failed;
+
+  /** True if a warning about a failed decompression has been issued. */
+  bool warned;
+
+  /** The current chunk of uncompressed data. */
+  vector<char> current;
+
+  /** The position of the next byte in the current chunk. */
+  size_t pos;
+
+  /** The number of bytes in the current chunk. */
+  size_t len;
+
+  /** Characters pushed back with ungetc() (last one on top). */
+  string pushback;
+
+  /** True if decompression is done on a separate thread. */
+  bool isThreaded;
+
+  /** The decompression thread. */
+  std::thread producer;
+
+  /** Protects the chunk queues and the flags below. */
+  std::mutex mutex;
+
+  /** Signalled when a chunk is ready or the producer is done. */
+  std::condition_variable dataAvailable;
+
+  /** Signalled when there is space for another chunk. */
+  std::condition_variable spaceAvailable;
+
+  /** Decompressed chunks ready to be used. */
+  std::deque< vector<char> > ready;
+
+  /** Used chunks which may be reused. */
+  vector< vector<char> > spare;
+
+  /** True when the decompression thread has finished. */
+  bool producerDone;
+
+  /** True if the decompression thread should stop. */
+  bool stopProducer;
+
+};
+
+}
+
+bool & CFile::threadedDecompression() {
+  static bool threaded = false;
+  return threaded;
+}
+
 void CFile::open(string filename, string mode) {
   close();
+  Codec codec = codecFor(filename);
   if ( filename[filename.length()-1] == '|' &&
        mode.find("r") != string::npos ) {
     filename = filename.substr(0, filename.length() - 1);
@@ -45,6 +622,26 @@ void CFile::open(string filename, string mode) {
     file = popen(filename.c_str(), mode.c_str());
     fileType = pipe;
   }
+  else if ( mode.find("r") != string::npos &&
+	    ( file = openUncompressed(filename) ) ) {
+    // Not actually compressed, in spite of the name.
+    fileType = plain;
+  }
+  else if ( codec != noCodec && mode.find("r") != string::npos ) {
+    FILE * f = fopen(filename.c_str(), "rb");
+    if ( f ) {
+      DecompressStream * s =
+	new DecompressStream(f, filename, codec, threadedDecompression());
+      if ( s->error() ) {
+	delete s;
+	Throw<FileError>()
+	  << "Could not initialize decompression of " << filename
+	  << Exception::runerror;
+      }
+      file = s;
+      fileType = stream;
+    }
+  }
   else if ( filename.substr(filename.length()-3,3) == ".gz" ) {
 #ifdef HAVE_LIBZ
     file = gzopen(filename.c_str(), mode.c_str());
@@ -66,10 +663,6 @@ void CFile::open(string filename, string mode) {
 #endif
   }
   else if ( filename.substr(filename.length()-4,4) == ".bz2" ) {
-#ifdef HAVE_LIBBZ2_NEVER
-    file = BZ2_bzopen(filename.c_str(), mode.c_str());
-    fileType = bzip2;
-#else
 #ifdef ThePEG_BZ2READ_FILE
 #ifdef ThePEG_BZ2WRITE_FILE
     if ( mode.find("r") != string::npos )
@@ -83,15 +676,30 @@ void CFile::open(string filename, string mode) {
     fileType = plain;
 #endif
 #endif
-#endif
+  }
+  else if ( filename.substr(filename.length()-3,3) == ".xz" ) {
+    if ( mode.find("r") != string::npos )
+      filename = "xz -d -c " + filename + " 2>/dev/null";
+    else
+      filename = "xz -c > " + filename + " 2>/dev/null";
+    file = popen(filename.c_str(), mode.c_str());
+    fileType = pipe;
+  }
+  else if ( filename.substr(filename.length()-4,4) == ".zst" ) {
+    if ( mode.find("r") != string::npos )
+      filename = "zstd -d -q -c " + filename + " 2>/dev/null";
+    else
+      filename = "zstd -q -c > " + filename + " 2>/dev/null";
+    file = popen(filename.c_str(), mode.c_str());
+    fileType = pipe;
   }
   else {
     file = fopen(filename.c_str(), mode.c_str());
     fileType = plain;
   }
   if ( !file ) {
-    Throw<FileError>() 
-      << std::strerror(errno) << ": " << filename 
+    Throw<FileError>()
+      << std::strerror(errno) << ": " << filename
       << Exception::runerror;
   }
 }
@@ -113,11 +721,9 @@ void CFile::close() {
     gzclose((gzFile)file);
     break;
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2:
-    BZ2_bzclose(file);
+  case stream:
+    delete (DecompressStream*)file;
     break;
-#endif
   default:
     break;
   }
@@ -132,9 +738,7 @@ char * CFile::gets(char * s, int size) {
 #ifdef HAVE_LIBZ
   case gzip: return gzgets((gzFile)file, s, size);
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: // don't know what to do here
-#endif
+  case stream: return ((DecompressStream*)file)->gets(s, size);
   default:
     return 0;
   }
@@ -146,9 +750,6 @@ int CFile::puts(const char * s) {
   case pipe: return fputs(s, (FILE*)file);
 #ifdef HAVE_LIBZ
   case gzip: return gzputs((gzFile)file, s);
-#endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: // don't know what to do here
 #endif
   default:
     return 0;
@@ -162,9 +763,7 @@ int CFile::getc() {
 #ifdef HAVE_LIBZ
   case gzip: return gzgetc((gzFile)file);
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
-    case bzip2:// don't know what to do here
-#endif
+  case stream: return ((DecompressStream*)file)->getc();
   default:
     return 0;
   }
@@ -176,9 +775,6 @@ int CFile::putc(int c) {
   case pipe: return fputc(c, (FILE*)file);
 #ifdef HAVE_LIBZ
   case gzip: return gzputc((gzFile)file, c);
-#endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: // don't know what to do here
 #endif
   default:
     return 0;
@@ -192,9 +788,7 @@ int CFile::ungetc(int c) {
 #ifdef HAVE_LIBZ
   case gzip: return gzungetc(c, (gzFile)file);
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: // don't know what to do here
-#endif
+  case stream: return ((DecompressStream*)file)->ungetc(c);
   default:
     return 0;
   }
@@ -207,9 +801,8 @@ size_t CFile::read(void *ptr, size_t size, size_t nmemb) {
 #ifdef HAVE_LIBZ
   case gzip: return gzread((gzFile)file, ptr, size);
 #endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: return BZ2_bzread(file, ptr, size);
-#endif
+  case stream:
+    return ((DecompressStream*)file)->read((char*)ptr, size*nmemb)/size;
   default:
     return 0;
   }
@@ -221,14 +814,8 @@ size_t CFile::write(const void *ptr, size_t size, size_t nmemb) {
   case pipe: return fwrite(ptr, size, nmemb, (FILE*)file);
 #ifdef HAVE_LIBZ
   case gzip:  return gzwrite((gzFile)file, ptr, size);
-#endif
-#ifdef HAVE_LIBBZ2_NEVER
-  case bzip2: return BZ2_bzwrite(file, ptr, size);
 #endif
   default:
     return 0;
   }
 }
-
-
-
@@ -10,7 +10,14 @@
 namespace ThePEG {
 
 /**
- * Here is the documentation of the CFile class.
+ * CFile is a thin wrapper around C-style file handles, which can
+ * also read and write compressed files. Files ending in ".gz",
+ * ".bz2", ".xz" and ".zst" are decompressed in-process when read,
+ * using zlib, libbz2, liblzma and libzstd respectively if they were
+ * found when ThePEG was configured. Otherwise, and when writing
+ * compressed files other than gzip, the file is piped through an
+ * external program. Optionally the decompression may be done on a
+ * separate thread, see threadedDecompression().
  */
 class CFile {
 
@@ -20,7 +27,7 @@ public:
    *  Type of the file
    */
   enum FileType {
-    undefined, plain, pipe, gzip, bzip2
+    undefined, plain, pipe, gzip, bzip2, stream
   };
 
 public:
@@ -56,6 +63,15 @@ public:
    */
   void close();
 
+  /**
+   * Access the flag determining if files which are decompressed
+   * in-process should be decompressed on a separate thread, so that
+   * the decompression runs in parallel with the processing of the
+   * data read. By default this is false. The setting only affects
+   * files opened after it is changed.
+   */
+  static bool & threadedDecompression();
+
   /**
    *  Pointer to the file
    */
@@ -108,7 +124,8 @@ public:
 private:
 
   /**
-   * Pointer to the file
+   * Pointer to the file, or to the internal decompression stream if
+   * the fileType is stream.
    */
   void * file;
 
@@ -14,9 +14,136 @@
 #include "CFileLineReader.h"
 #include "config.h"
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
 
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * Return true if \a c is a white space character in the "C" locale.
+ */
+inline bool isSpace(char c) {
+  return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
+/**
+ * Return true if \a c is a decimal digit.
+ */
+inline bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * Parse a long integer from \a str in the same way as
+ * std::strtol(str, end, 0). Plain decimal numbers are parsed
+ * directly, while anything else (octal, hexadecimal or possibly
+ * overflowing numbers) is passed on to std::strtol.
+ */
+long parseLong(char * str, char ** end) {
+  char * p = str;
+  while ( isSpace(*p) ) ++p;
+  bool neg = ( *p == '-' );
+  if ( neg || *p == '+' ) ++p;
+  if ( !isDigit(*p) || ( *p == '0' && ( isDigit(p[1]) ||
+				       p[1] == 'x' || p[1] == 'X' ) ) )
+    return std::strtol(str, end, 0);
+  char * first = p;
+  unsigned long l = 0;
+  while ( isDigit(*p) ) l = 10*l + ( *p++ - '0' );
+  if ( p - first > 18 ) return std::strtol(str, end, 0);
+  *end = p;
+  return neg? -long(l): long(l);
+}
+
+/**
+ * Parse an unsigned long integer from \a str in the same way as
+ * std::strtoul(str, end, 0).
+ */
+unsigned long parseULong(char * str, char ** end) {
+  char * p = str;
+  while ( isSpace(*p) ) ++p;
+  if ( !isDigit(*p) || ( *p == '0' && ( isDigit(p[1]) ||
+				       p[1] == 'x' || p[1] == 'X' ) ) )
+    return std::strtoul(str, end, 0);
+  char * first = p;
+  unsigned long l = 0;
+  while ( isDigit(*p) ) l = 10*l + ( *p++ - '0' );
+  if ( p - first > 18 ) return std::strtoul(str, end, 0);
+  *end = p;
+  return l;
+}
+
+/**
+ * Parse a double from \a str in the same way as std::strtod(str,
+ * end) in the "C" locale. If the decimal mantissa has at most 19
+ * significant digits and is exactly representable as a double, and
+ * the power of ten is exactly representable as well, a single
+ * multiplication or division gives the correctly rounded result
+ * (Clinger's fast path). Everything else is passed on to std::strtod.
+ */
+double parseDouble(char * str, char ** end) {
+  static const double pow10[] = {
+    1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+    1.0e8,  1.0e9,  1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15,
+    1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22 };
+  char * p = str;
+  while ( isSpace(*p) ) ++p;
+  bool neg = ( *p == '-' );
+  if ( neg || *p == '+' ) ++p;
+  if ( *p == '0' && ( p[1] == 'x' || p[1] == 'X' ) )
+    return std::strtod(str, end);
+  uint64_t m = 0;
+  int ndig = 0;
+  int nsig = 0;
+  int exp10 = 0;
+  while ( isDigit(*p) ) {
+    if ( m || *p != '0' ) {
+      m = 10*m + ( *p - '0' );
+      ++nsig;
+    }
+    ++ndig;
+    ++p;
+  }
+  if ( *p == '.' ) {
+    ++p;
+    while ( isDigit(*p) ) {
+      if ( m || *p != '0' ) {
+	m = 10*m + ( *p - '0' );
+	++nsig;
+      }
+      --exp10;
+      ++ndig;
+      ++p;
+    }
+  }
+  if ( ndig == 0 || nsig > 19 ) return std::strtod(str, end);
+  if ( *p == 'e' || *p == 'E' ) {
+    char * q = p + 1;
+    bool eneg = ( *q == '-' );
+    if ( eneg || *q == '+' ) ++q;
+    if ( isDigit(*q) ) {
+      int e = 0;
+      while ( isDigit(*q) ) {
+	if ( e < 10000 ) e = 10*e + ( *q - '0' );
+	++q;
+      }
+      exp10 += eneg? -e: e;
+      p = q;
+    }
+  }
+  if ( m > ( uint64_t(1) << 53 ) || exp10 < -22 || exp10 > 22 )
+    return std::strtod(str, end);
+  *end = p;
+  double d = double(m);
+  if ( exp10 < 0 ) d /= pow10[-exp10];
+  else d *= pow10[exp10];
+  return neg? -d: d;
+}
+
+}
+
 CFileLineReader::CFileLineReader()
   : bufflen(defsize), buff(new char[defsize]), pos(buff), bad(false) {}
 
@@ -71,16 +198,24 @@ bool CFileLineReader::skip(char c) {
 }
 
 bool CFileLineReader::find(string str) const {
-  return ( string(pos).find(str) != string::npos );
+  return find(str.c_str());
+}
+
+bool CFileLineReader::find(const char * str) const {
+  return std::strstr(pos, str) != 0;
 }
 
 std::string CFileLineReader::getline() const {
   return std::string(pos);
 }
 
+const char * CFileLineReader::line() const {
+  return pos;
+}
+
 CFileLineReader & CFileLineReader::operator>>(long & l) {
   char * next;
-  l = std::strtol(pos, &next, 0);
+  l = parseLong(pos, &next);
   bad = ( next == pos );
   pos = next;
   return *this;
@@ -88,7 +223,7 @@ CFileLineReader & CFileLineReader::operator>>(long & l) {
 
  CFileLineReader & CFileLineReader::operator>>(int & i) {
   char * next;
-  i = int(std::strtol(pos, &next, 0));
+  i = int(parseLong(pos, &next));
   bad = ( next == pos );
   pos = next;
   return *this;
@@ -96,7 +231,7 @@ CFileLineReader & CFileLineReader::operator>>(long & l) {
 
 CFileLineReader & CFileLineReader::operator>>(unsigned long & l) {
   char * next;
-  l = std::strtoul(pos, &next, 0);
+  l = parseULong(pos, &next);
   bad = ( next == pos );
   pos = next;
   return *this;
@@ -104,7 +239,7 @@ CFileLineReader & CFileLineReader::operator>>(unsigned long & l) {
 
 CFileLineReader & CFileLineReader::operator>>(unsigned int & i) {
   char * next;
-  i = static_cast<unsigned int>(std::strtoul(pos, &next, 0));
+  i = static_cast<unsigned int>(parseULong(pos, &next));
   bad = ( next == pos );
   pos = next;
   return *this;
@@ -112,7 +247,7 @@ CFileLineReader & CFileLineReader::operator>>(unsigned int & i) {
 
 CFileLineReader & CFileLineReader::operator>>(double & d) {
   char * next;
-  d = std::strtod(pos, &next);
+  d = parseDouble(pos, &next);
   bad = ( next == pos );
   pos = next;
   // fortran formatted doubles
@@ -127,7 +262,7 @@ CFileLineReader & CFileLineReader::operator>>(double & d) {
 
 CFileLineReader & CFileLineReader::operator>>(float & f) {
   char * next;
-  f = float(std::strtod(pos, &next));
+  f = float(parseDouble(pos, &next));
   bad = ( next == pos );
   pos = next;
   // fortran formatted doubles
@@ -29,15 +29,18 @@ namespace ThePEG {
  * filled by hand one line at the time.
  *
  * Contrary to std::ifstream the CFileLineReader can also handle
- * gipped files and pipes. Gzipped files are automatically handles by
- * a pipe using the <code>zcat</code> command if the file name ends
- * with <code>.gz</code>. Also if a file name ends with a
- * <code>|</code> sign, the preceding string is interpreted as a
- * command defining a pipe from which to read.
+ * compressed files and pipes. Files with names ending in
+ * <code>.gz</code>, <code>.bz2</code>, <code>.xz</code> or
+ * <code>.zst</code> are automatically decompressed by CFile. Also if
+ * a file name ends with a <code>|</code> sign, the preceding string
+ * is interpreted as a command defining a pipe from which to read.
  *
  * Since CFileLineReader is very close to the standard C FILE stream
  * it is in many cases much faster than eg. reading from lines via
- * std::istringstream.
+ * std::istringstream. Numbers are parsed directly from the line
+ * buffer without any copying, and the common case of decimal numbers
+ * with at most 19 significant digits is handled without calling
+ * std::strtod, giving identical, correctly rounded, results.
  */
 class CFileLineReader {
 
@@ -52,11 +55,10 @@ public:
 
   /**
    * Constructor taking a \a filename as argument. Optionally the size
-   * \a len of the line buffer can be specified. If \a filename ends
-   * with <code>.gz</code> a pipe is opened where the file is read by
-   * <code>zcat</code>. If \a filename ends with a <code>|</code>
-   * sign, the preceding string is interpreted as a command defining a
-   * pipe from which to read.
+   * \a len of the line buffer can be specified. Compressed files are
+   * decompressed as described in CFile. If \a filename ends
+   * with a <code>|</code> sign, the preceding string is interpreted
+   * as a command defining a pipe from which to read.
    */
   CFileLineReader(string filename, int len = defsize);
 
@@ -69,11 +71,10 @@ public:
   /** @name Initialization functions. */
   //@{
   /**
-   * Initialize with a \a filename. If \a filename ends with
-   * <code>.gz</code> a pipe is opened where the file is read by
-   * <code>zcat</code>. If \a filename ends with a <code>|</code>
-   * sign, the preceding string is interpreted as a command defining a
-   * pipe from which to read.
+   * Initialize with a \a filename. Compressed files are
+   * decompressed as described in CFile. If \a filename ends
+   * with a <code>|</code> sign, the preceding string is interpreted
+   * as a command defining a pipe from which to read.
    */
   void open(string filename);
 
@@ -100,6 +101,12 @@ public:
    */
   string getline() const;
 
+  /**
+   * Return a pointer to what is left of the line buffer, without
+   * copying it. The pointer is invalidated by the next readline().
+   */
+  const char * line() const;
+
   /**
    * Return the underlying c-file.
    */
@@ -127,6 +134,13 @@ public:
    */
   bool find(string str) const;
 
+  /**
+   * Check if a given string is present in the current line
+   * buffer. This version avoids constructing a temporary std::string
+   * when called with a literal.
+   */
+  bool find(const char * str) const;
+
   /** @name Operators to read from the line buffer. */
   //@{
   /**
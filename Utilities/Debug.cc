@@ -22,7 +22,7 @@
 
 using namespace ThePEG;
 
-int Debug::level = 0;
+thread_local int Debug::level = 0;
 
 bool Debug::isset = false;
 
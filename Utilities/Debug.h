@@ -33,14 +33,19 @@ public:
   };
 
   /**
-   * The current level.
+   * The current level. There is one level per thread, so that
+   * EventGenerators with different debug settings may run
+   * concurrently. A new thread starts at noDebug and must inherit the
+   * level explicitly from the thread which started it, if so desired.
    */
-  static int level;
+  static thread_local int level;
 
   /**
    * If true, the debug level has been set from the outside from the
    * calling program. This would then override any debug settings in
-   * the event generator.
+   * the event generator. This flag, and the debugItems below, are
+   * shared by all threads and should only be set before any event
+   * generation is started.
    */
   static bool isset;
 
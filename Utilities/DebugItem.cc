@@ -6,10 +6,24 @@
 
 #include "DebugItem.h"
 #include "ThePEG/Utilities/Debug.h"
+#include <mutex>
 
 using namespace ThePEG;
 
+namespace {
+
+/**
+ * Lock protecting the static registry of DebugItem objects.
+ */
+std::mutex & registryMutex() {
+  static std::mutex m;
+  return m;
+}
+
+}
+
 DebugItem::DebugItem(string itemname, int level): debug(false) {
+  std::lock_guard<std::mutex> lock(registryMutex());
   if ( level <= Debug::level ) debug = true;
   items().insert(make_pair(itemname, this));
   map<string,long>::iterator it = nametics().find(itemname);
@@ -30,6 +44,7 @@ DebugItem::DebugItem(string itemname, int level): debug(false) {
 }
 
 void DebugItem::tic() {
+  std::lock_guard<std::mutex> lock(registryMutex());
   ticker()++;
   multimap<long,DebugItem*>::iterator it = itemtics().begin();
   while ( it != itemtics().end() &&
@@ -39,6 +54,7 @@ void DebugItem::tic() {
 
 void DebugItem::setDebugItem(string itemname, long after) {
   typedef multimap<string,DebugItem*>::iterator ItemIt;
+  std::lock_guard<std::mutex> lock(registryMutex());
   if ( itemname.rfind('=') != string::npos ) {
     after =  atoi(itemname.substr(itemname.rfind('=') + 1).c_str());
     itemname = itemname.substr(0, itemname.rfind('='));
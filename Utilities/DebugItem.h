@@ -6,6 +6,7 @@
 //
 
 #include "ThePEG/Config/ThePEG.h"
+#include <atomic>
 
 namespace ThePEG {
 
@@ -18,6 +19,10 @@ namespace ThePEG {
  * once). After that the object is automatically cast to a bool
  * indicating whether or not debugging has been requested for this
  * item.
+ *
+ * The registry of DebugItem objects and the tic counter are shared
+ * between threads and are protected by a lock, while testing an
+ * individual DebugItem is lock-free.
  */
 class DebugItem {
 
@@ -54,7 +59,7 @@ public:
    */
   operator bool () const {
 #ifndef ThePEG_NO_DEBUG
-    return debug;
+    return debug.load(std::memory_order_relaxed);
 #else
     return false;
 #endif
@@ -63,9 +68,10 @@ public:
 private:
 
   /**
-   * Set to true if debugging requested.
+   * Set to true if debugging requested. May be switched on from
+   * another thread.
    */
-  bool debug;
+  std::atomic<bool> debug;
 
   /**
    * Counter for number of tics.
@@ -91,6 +97,11 @@ private:
 
 private:
 
+  /**
+   * The copy constructor is private and must never be called.
+   */
+  DebugItem(const DebugItem &) = delete;
+
   /**
    * The assignment operator is private and must never be called.
    * In fact, it should not even be implemented.
@@ -27,8 +27,8 @@ template <int I>
  * the behavior of the methods are reversed.
  *
  * <code>Direction</code> is templated with an integer template argument
- * (default = 0), and only one object per class can be instatiated at
- * the time. Attempts to instatiate a second object of a
+ * (default = 0), and only one object per class and thread can be
+ * instatiated at the time. Attempts to instatiate a second object of a
  * <code>Direction</code> class will result in an exception being
  * thrown. To have several different directions classes with different
  * template arguments must be instantiated. <code>Direction<0></code> is
@@ -132,9 +132,9 @@ public:
 private:
 
   /**
-   * The direction.
+   * The direction. There is one per thread.
    */
-  static Dir theDirection;
+  static thread_local Dir theDirection;
 
 private:
 
@@ -154,7 +154,8 @@ private:
 };
 
 template<int I>
-typename Direction<I>::Dir Direction<I>::theDirection = Direction<I>::Undefined;
+thread_local typename Direction<I>::Dir
+Direction<I>::theDirection = Direction<I>::Undefined;
 
 }
 
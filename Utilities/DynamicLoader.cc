@@ -90,6 +90,7 @@ bool DynamicLoader::loadcmd(string file) {
 void DynamicLoader::appendPath(string path) {
   if (path.size()==0) return;
   if ( path[path.size()-1] != '/' ) path += '/';
+  if ( find(apppaths.begin(), apppaths.end(), path) != apppaths.end() ) return;
   paths.push_back(path);
   apppaths.push_back(path);
 }
@@ -97,6 +98,7 @@ void DynamicLoader::appendPath(string path) {
 void DynamicLoader::prependPath(string path) {
   if (path.size()==0) return;
   if ( path[path.size()-1] != '/' ) path += '/';
+  if ( find(prepaths.begin(), prepaths.end(), path) != prepaths.end() ) return;
   paths.insert(paths.begin(), path);
   prepaths.push_back(path);
 }
@@ -43,13 +43,15 @@ public:
 
   /**
    * Add a path to the bottom of the list of directories to seach for
-   * dynaically linkable libraries.
+   * dynaically linkable libraries. Paths which have already been
+   * appended are ignored.
    */
   static void appendPath(string);
 
   /**
    * Add a path to the top of the list of directories to seach for
-   * dynaically linkable libraries.
+   * dynaically linkable libraries. Paths which have already been
+   * prepended are ignored.
    */
   static void prependPath(string);
 
@@ -11,6 +11,7 @@
 // This is the declaration of the Selector class.
 
 #include "ThePEG/Config/ThePEG.h"
+#include "ThePEG/Utilities/AliasTable.h"
 #include <stdexcept>
 #include <algorithm>
 #include <stdexcept>
@@ -40,7 +41,15 @@ namespace ThePEG {
  * <code>foo * f = bar.select(random())</code>  // randomly returns
  * a pointer to f1 or f2<BR>
  *
+ * When all objects have been inserted, the Selector may be frozen
+ * with freeze(), after which objects are selected in constant time
+ * using an AliasTable. A frozen Selector selects objects with the
+ * same probabilities, but a given random number will in general not
+ * give the same object as before. Any change to the probabilities
+ * unfreezes the Selector.
+ *
  * @see VSelector
+ * @see AliasTable
  */
 template <typename T, typename WeightType = double>
 class Selector {
@@ -66,6 +75,25 @@ public:
    */
   Selector() : theSum(WeightType()) {}
 
+  /**
+   * Copy constructor. If \a s is frozen, so is the copy.
+   */
+  Selector(const Selector & s) : theMap(s.theMap), theSum(s.theSum) {
+    if ( s.frozen() ) freeze();
+  }
+
+  /**
+   * Assignment. If \a s is frozen, so is this.
+   */
+  Selector & operator=(const Selector & s) {
+    if ( this == &s ) return *this;
+    theMap = s.theMap;
+    theSum = s.theSum;
+    unfreeze();
+    if ( s.frozen() ) freeze();
+    return *this;
+  }
+
   /**
    * Swap the underlying representation with the argument.
    */
@@ -73,8 +101,30 @@ public:
   {
     theMap.swap(s.theMap);
     std::swap(theSum, s.theSum);
+    theAliasTable.swap(s.theAliasTable);
+    theAliasObjects.swap(s.theAliasObjects);
   }
 
+  /**
+   * Build an AliasTable for the objects inserted so far, so that they
+   * can be selected in constant time. The Selector is unfrozen again
+   * if the probabilities are changed.
+   */
+  void freeze();
+
+  /**
+   * Remove the AliasTable built by freeze().
+   */
+  void unfreeze() {
+    theAliasTable.clear();
+    theAliasObjects.clear();
+  }
+
+  /**
+   * Return true if the Selector has been frozen.
+   */
+  bool frozen() const { return !theAliasTable.empty(); }
+
   /**
    * Insert an object given a probability for this object. If the
    * probability is zero or negative, the object will not be inserted
@@ -85,6 +135,7 @@ public:
     typedef typename MapType::value_type value_type;
     WeightType newSum = theSum + d;
     if ( newSum <= theSum ) return d;
+    unfreeze();
     theMap.insert(theMap.end(), value_type((theSum = newSum), t));
     return theSum;
   }
@@ -236,7 +287,7 @@ public:
   /**
    * Erases all objects.
    */
-  void clear() { theMap.clear(); theSum = WeightType(); }
+  void clear() { unfreeze(); theMap.clear(); theSum = WeightType(); }
 
   /**
    * Output to a stream for dimensionful units.
@@ -274,6 +325,16 @@ private:
    */
   WeightType theSum;
 
+  /**
+   * The alias table used if frozen.
+   */
+  AliasTable theAliasTable;
+
+  /**
+   * The objects corresponding to the indices of theAliasTable.
+   */
+  vector<iterator> theAliasObjects;
+
 };
 
 /**
@@ -11,6 +11,7 @@ namespace ThePEG {
 
 template <typename T, typename WeightType>
 WeightType Selector<T,WeightType>::erase(const T & t) {
+  unfreeze();
   Selector<T,WeightType> newSelector;
   WeightType oldsum = WeightType();
   for ( iterator it = theMap.begin();
@@ -23,11 +24,31 @@ WeightType Selector<T,WeightType>::erase(const T & t) {
   return theSum = newSelector.theSum;
 }
 
+template <typename T, typename WeightType>
+void Selector<T,WeightType>::freeze() {
+  unfreeze();
+  vector<double> weights;
+  WeightType oldsum = WeightType();
+  for ( iterator it = theMap.begin(); it != theMap.end(); ++it ) {
+    weights.push_back((it->first - oldsum)/theSum);
+    oldsum = it->first;
+    theAliasObjects.push_back(it);
+  }
+  theAliasTable.build(weights);
+  if ( theAliasTable.empty() ) theAliasObjects.clear();
+}
+
 template <typename T, typename WeightType>
 const T & Selector<T,WeightType>::
 select(double rnd, double * remainder) const {
   if ( rnd <= 0 )
     throw range_error("Random number out of range in Selector::select.");
+  if ( frozen() ) {
+    if ( rnd >= 1.0 )
+      throw range_error("Empty Selector, or random number out of range "
+			"in Selector::select");
+    return theAliasObjects[theAliasTable.select(rnd, remainder)]->second;
+  }
   const_iterator it = theMap.upper_bound(rnd*theSum);
   if ( it == theMap.end() )
     throw range_error("Empty Selector, or random number out of range "
@@ -49,6 +70,12 @@ T & Selector<T,WeightType>::
 select(double rnd, double * remainder) {
   if ( rnd <= 0 )
     throw range_error("Random number out of range in Selector::select.");
+  if ( frozen() ) {
+    if ( rnd >= 1.0 )
+      throw range_error("Empty Selector, or random number out of range "
+			"in Selector::select");
+    return theAliasObjects[theAliasTable.select(rnd, remainder)]->second;
+  }
   iterator it = theMap.upper_bound(rnd*theSum);
   if ( it == theMap.end() )
     throw range_error("Empty Selector, or random number out of range "
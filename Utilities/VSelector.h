@@ -11,6 +11,7 @@
 // This is the definition of the ThePEG::VSelector class.
 
 #include "ThePEG/Config/ThePEG.h"
+#include "ThePEG/Utilities/AliasTable.h"
 #include <stdexcept>
 #include <algorithm>
 #include <stdexcept>
@@ -41,7 +42,11 @@ template <typename T, typename WeightType = double>
  * <code>foo * f = bar.select(random())</code>  // randomly returns
  * a pointer to f1 or f2<BR>
  *
+ * As for Selector, a VSelector may be frozen with freeze() to select
+ * objects in constant time using an AliasTable.
+ *
  * @see Selector
+ * @see AliasTable
  */
 class VSelector {
 
@@ -83,8 +88,27 @@ public:
     theWeights.swap(s.theWeights);
     theObjects.swap(s.theObjects);
     std::swap(theSum, s.theSum);
+    theAliasTable.swap(s.theAliasTable);
   }
 
+  /**
+   * Build an AliasTable for the objects inserted so far, so that they
+   * can be selected in constant time. A given random number will in
+   * general not select the same object as before. The VSelector is
+   * unfrozen again if the probabilities are changed.
+   */
+  void freeze();
+
+  /**
+   * Remove the AliasTable built by freeze().
+   */
+  void unfreeze() { theAliasTable.clear(); }
+
+  /**
+   * Return true if the VSelector has been frozen.
+   */
+  bool frozen() const { return !theAliasTable.empty(); }
+
   /**
    * Insert an object given a probability for this object. If the
    * probability is zero or negative, the object will not be inserted
@@ -94,6 +118,7 @@ public:
   WeightType insert(WeightType d, const T & t) {
     WeightType newSum = theSum + d;
     if ( newSum <= theSum ) return d;
+    unfreeze();
     theSums.push_back(theSum = newSum);
     theWeights.push_back(d);
     theObjects.push_back(t);
@@ -259,6 +284,7 @@ public:
    * Erases all objects.
    */
   void clear() {
+    unfreeze();
     theSums.clear();
     theWeights.clear();
     theObjects.clear();
@@ -306,6 +332,11 @@ private:
    */
   WeightType theSum;
 
+  /**
+   * The alias table used if frozen.
+   */
+  AliasTable theAliasTable;
+
 };
 
 /**
@@ -11,6 +11,7 @@ namespace ThePEG {
 
 template <typename T, typename WeightType>
 WeightType VSelector<T,WeightType>::erase(const T & t) {
+  unfreeze();
   theSum = WeightType();
   int j = 0;
   for ( int i = 0, N = theWeights.size(); i < N; ++i ) {
@@ -30,6 +31,7 @@ WeightType VSelector<T,WeightType>::erase(const T & t) {
 
 template <typename T, typename WeightType>
 WeightType VSelector<T,WeightType>::reweight(WeightType d, const T & t) {
+  unfreeze();
   d = max(d, WeightType());
   theSum = WeightType();
   for ( int i = 0, N = theWeights.size(); i < N; ++i ) {
@@ -39,11 +41,25 @@ WeightType VSelector<T,WeightType>::reweight(WeightType d, const T & t) {
   return theSum;
 }
 
+template <typename T, typename WeightType>
+void VSelector<T,WeightType>::freeze() {
+  vector<double> weights(theWeights.size());
+  for ( size_type i = 0; i < weights.size(); ++i )
+    weights[i] = theWeights[i]/theSum;
+  theAliasTable.build(weights);
+}
+
 template <typename T, typename WeightType>
 typename VSelector<T,WeightType>::size_type VSelector<T,WeightType>::
 iselect(double rnd, double * remainder) const {
   if ( rnd <= 0 )
     throw range_error("Random number out of range in VSelector::select.");
+  if ( frozen() ) {
+    if ( rnd >= 1.0 )
+      throw range_error("Empty Selector, or random number out of range "
+			"in Selector::select");
+    return theAliasTable.select(rnd, remainder);
+  }
   WeightType sum = rnd*theSum;
   WIterator it = upper_bound(theSums.begin(), theSums.end(), sum);
   if ( it == theSums.end() )
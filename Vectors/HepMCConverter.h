@@ -13,6 +13,7 @@
 #include "ThePEG/Config/ThePEG.h"
 #include "ThePEG/EventRecord/Event.h"
 #include "HepMCTraits.h"
+#include <unordered_map>
 
 namespace ThePEG {
 
@@ -23,6 +24,10 @@ namespace ThePEG {
  * <code>HepMC::GenEvent</code>. All mother-daughter relationships and
  * colour information is preserved.
  *
+ * Particles are looked up from their Particle::index() in flat
+ * tables, and the tables are kept between calls in the same thread
+ * so that they are only allocated once.
+ *
  * @see Event
  * @see Particle
  *
@@ -38,17 +43,6 @@ public:
   struct HepMCConverterException: public Exception {};
   /** @endcond */
 
-  /**
-   * Help class to represent a temporary vertex which can be
-   * converted to a GenVertex.
-   */
-  struct Vertex {
-    /** Particles going in to the vertex. */
-    tcParticleSet in;
-    /** Particles going out of the vertex. */
-    tcParticleSet out;
-  };
-
   /** Forward typedefs from Traits class. */
   typedef typename Traits::ParticleT GenParticle;
   /** Forward typedefs from Traits class. */
@@ -61,14 +55,51 @@ public:
   typedef typename Traits::VertexPtrT GenVertexPtrT;
   /** Forward typedefs from Traits class. */
   typedef typename Traits::PdfInfoT PdfInfo;
-  /** Map ThePEG particles to HepMC particles. */
-  typedef map<tcPPtr,GenParticlePtrT> ParticleMap;
   /** Map ThePEG colour lines to HepMC colour indices. */
-  typedef map<tcColinePtr,long> FlowMap;
-  /** Map ThePEG particles to vertices. */
-  typedef map<tcPPtr,Vertex*> VertexMap;
-  /** Map vertices to GenVertex */
-  typedef map<const Vertex *, GenVertexPtrT> GenVertexMap;
+  typedef std::unordered_map<const ColourLine *,long> FlowMap;
+
+  /**
+   * The tables used during the conversion. Temporary vertices are
+   * represented by integers and particles by their position in the
+   * list of all particles in the event. One object is kept per
+   * thread and is reused for all conversions, so that the tables
+   * only need to be allocated for the first event.
+   */
+  struct Buffers {
+    /** All particles in the event ordered by their number. */
+    tcPVector all;
+    /** The position (plus one) in all for each Particle::index(). */
+    vector<int> slot;
+    /** The position in all of particles which are not in slot. */
+    std::unordered_map<const Particle *,int> other;
+    /** The GenParticle created for each particle in all. */
+    vector<GenParticlePtrT> gen;
+    /** The production vertex of each particle in all, or -1. */
+    vector<int> prov;
+    /** The decay vertex of each particle in all, or -1. */
+    vector<int> decv;
+    /**
+     * For each temporary vertex the vertex it has been joined with,
+     * or itself if it has not been joined.
+     */
+    vector<int> link;
+    /** The start of the incoming particles of each vertex in in. */
+    vector<int> inBegin;
+    /** The start of the outgoing particles of each vertex in out. */
+    vector<int> outBegin;
+    /** The incoming particles of all vertices. */
+    vector<int> in;
+    /** The outgoing particles of all vertices. */
+    vector<int> out;
+    /** Scratch space used when filling in and out. */
+    vector<int> cursor;
+    /** The GenVertex created for each temporary vertex. */
+    vector<GenVertexPtrT> vertex;
+    /** Set for each temporary vertex added to the GenEvent. */
+    vector<char> added;
+    /** The translation table for colour lines. */
+    FlowMap flowmap;
+  };
 
 public:
 
@@ -153,64 +184,61 @@ private:
   GenParticlePtrT createParticle(tcPPtr p) const;
 
   /**
-   * Join the decay vertex of the parent with the decay vertex of the
-   * child.
+   * Return the position of the given particle in the list of all
+   * particles, or -1 if it was not found.
    */
-  void join(tcPPtr parent, tcPPtr child);
+  int position(tcPPtr p) const;
 
   /**
-   * Create a GenVertex from a temporary Vertex.
+   * Return the temporary vertex which the vertex \a v has been joined
+   * with.
    */
-  GenVertexPtrT createVertex(Vertex * v); 
+  int root(int v);
 
   /**
-   * Create and set a PdfInfo object for the event
+   * Join the decay vertex of the parent with the decay vertex of the
+   * child.
    */
-  void setPdfInfo(const Event & e);
+  void join(tcPPtr parent, tcPPtr child);
 
   /**
-   * Create and set a HeavyIon object for the event
+   * Create a GenVertex from a temporary vertex.
    */
-  void setHeavyIon(const Event & e);
-
-private:
+  GenVertexPtrT createVertex(int v);
 
   /**
-   * The constructed GenEvent.
+   * Add the GenVertex created from the temporary vertex \a v to the
+   * GenEvent. If \a signal is true it is set as the signal process
+   * vertex.
    */
-  GenEvent * geneve;
+  void addVertex(int v, bool signal = false);
 
   /**
-   * The translation table between the ThePEG particles and the
-   * GenParticles.
+   * Return the thread-local tables used during the conversion.
    */
-  ParticleMap pmap;
+  static Buffers & buffers();
 
   /**
-   * The translation table between ThePEG ColourLine objects and HepMC
-   * Flow indices.
+   * Create and set a PdfInfo object for the event
    */
-  FlowMap flowmap;
+  void setPdfInfo(const Event & e);
 
   /**
-   * All temporary vertices created.
+   * Create and set a HeavyIon object for the event
    */
-  vector<Vertex> vertices;
+  void setHeavyIon(const Event & e);
 
-  /**
-   * The mapping of particles to their production vertices.
-   */
-  VertexMap prov;
+private:
 
   /**
-   * The mapping of particles to their decy vertices.
+   * The constructed GenEvent.
    */
-  VertexMap decv;
+  GenEvent * geneve;
 
   /**
-   * The mapping between temporary vertices and the created GenVertex Objects.
+   * The tables used during the conversion.
    */
-  GenVertexMap vmap;
+  Buffers & buf;
 
   /**
    * The energy unit to be used in the GenEvent.
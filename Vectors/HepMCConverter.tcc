@@ -53,7 +53,7 @@ convert(const Event & ev, GenEvent & gev, bool nocopies,
 template <typename HepMCEventT, typename Traits>
 HepMCConverter<HepMCEventT,Traits>::
 HepMCConverter(const Event & ev, bool nocopies, Energy eunit, Length lunit)
-  : energyUnit(eunit), lengthUnit(lunit) {
+  : buf(buffers()), energyUnit(eunit), lengthUnit(lunit) {
 
   geneve = Traits::newEvent(ev.number(), ev.weight(), ev.optionalWeights());
 
@@ -65,7 +65,7 @@ template <typename HepMCEventT, typename Traits>
 HepMCConverter<HepMCEventT,Traits>::
 HepMCConverter(const Event & ev, GenEvent & gev, bool nocopies,
 	       Energy eunit, Length lunit)
-  : energyUnit(eunit), lengthUnit(lunit) {
+  : buf(buffers()), energyUnit(eunit), lengthUnit(lunit) {
 
   geneve = &gev;
   Traits::resetEvent(geneve, ev.number(), ev.weight(), ev.optionalWeights());
@@ -103,23 +103,49 @@ void HepMCConverter<HepMCEventT,Traits>::init(const Event & ev, bool nocopies) {
 			      energyUnit);
   }
 
-  // Extract all particles and order them.
-  tcPVector all;
+  // Extract all particles and order them. The particles are normally
+  // stored in the order they were added to the event and will then
+  // already be ordered.
+  tcPVector & all = buf.all;
+  all.clear();
   ev.select(back_inserter(all), SelectAll());
-  stable_sort(all.begin(), all.end(), ParticleOrderNumberCmp());
-  vertices.reserve(all.size()*2);
-
-  // Create GenParticle's and map them to the ThePEG particles.
+  if ( !is_sorted(all.begin(), all.end(), ParticleOrderNumberCmp()) )
+    stable_sort(all.begin(), all.end(), ParticleOrderNumberCmp());
+
+  // Set up the table giving the position of each particle from its
+  // index in the event, removing any duplicates.
+  int maxIndex = 0;
+  for ( int i = 0, N = all.size(); i < N; ++i )
+    maxIndex = max(maxIndex, all[i]->index());
+  buf.slot.assign(maxIndex + 1, 0);
+  buf.other.clear();
+  int nall = 0;
   for ( int i = 0, N = all.size(); i < N; ++i ) {
+    tcPPtr p = all[i];
+    if ( position(p) >= 0 ) continue;
+    int index = p->index();
+    if ( index > 0 && !buf.slot[index] ) buf.slot[index] = nall + 1;
+    else buf.other[p.operator->()] = nall;
+    all[nall++] = p;
+  }
+  all.resize(nall);
+
+  buf.gen.assign(nall, GenParticlePtrT());
+  buf.prov.assign(nall, -1);
+  buf.decv.assign(nall, -1);
+  buf.link.clear();
+  buf.flowmap.clear();
+
+  // Create GenParticle's and temporary vertices for the ThePEG
+  // particles.
+  for ( int i = 0; i < nall; ++i ) {
     tcPPtr p = all[i];
     if ( nocopies && p->next() ) continue;
-    if ( pmap.find(p) != pmap.end() ) continue;
-    pmap[p] = createParticle(p);
+    GenParticlePtrT gp = buf.gen[i] = createParticle(p);
     if ( !p->children().empty() || p->next() ) {
       // If the particle has children it should have a decay vertex:
-      vertices.push_back(Vertex());
-      decv[p] = &vertices.back();
-      vertices.back().in.insert(p);
+      buf.decv[i] = buf.link.size();
+      buf.link.push_back(buf.decv[i]);
     }
 
     if ( !p->parents().empty() || p->previous() ||
@@ -127,14 +153,32 @@ void HepMCConverter<HepMCEventT,Traits>::init(const Event & ev, bool nocopies) {
       // If the particle has parents it should have a production
       // vertex. If neither parents or children it should still have a
       // dummy production vertex.
-      vertices.push_back(Vertex());
-      prov[p] = &vertices.back();
-      vertices.back().out.insert(p);
+      buf.prov[i] = buf.link.size();
+      buf.link.push_back(buf.prov[i]);
+    }
+
+    if ( p->hasColourInfo() ) {
+      // Check if the particle is connected to colour lines, in which
+      // case the lines are mapped to an integer and set in the
+      // GenParticle's Flow info.
+      tcColinePtr l;
+      if ( (l = p->colourLine()) ) {
+	long flow =
+	  buf.flowmap.emplace(l.operator->(), buf.flowmap.size() + 500)
+	  .first->second;
+	Traits::setColourLine(*gp, 1, flow);
+      }
+      if ( (l = p->antiColourLine()) ) {
+	long flow =
+	  buf.flowmap.emplace(l.operator->(), buf.flowmap.size() + 500)
+	  .first->second;
+	Traits::setColourLine(*gp, 2, flow);
+      }
     }
   }
 
   // Now go through the the particles again, and join the vertices.
-  for ( int i = 0, N = all.size(); i < N; ++i ) {
+  for ( int i = 0; i < nall; ++i ) {
     tcPPtr p = all[i];
     if ( nocopies ) {
       if ( p->next() ) continue;
@@ -154,39 +198,64 @@ void HepMCConverter<HepMCEventT,Traits>::init(const Event & ev, bool nocopies) {
     }
   }
 
+  // Collect the incoming and outgoing particles of the vertices
+  // which are left after joining, ordered by the particle number.
+  const int nv = buf.link.size();
+  buf.inBegin.assign(nv + 1, 0);
+  buf.outBegin.assign(nv + 1, 0);
+  for ( int i = 0; i < nall; ++i ) {
+    if ( buf.decv[i] >= 0 ) {
+      buf.decv[i] = root(buf.decv[i]);
+      ++buf.inBegin[buf.decv[i] + 1];
+    }
+    if ( buf.prov[i] >= 0 ) {
+      buf.prov[i] = root(buf.prov[i]);
+      ++buf.outBegin[buf.prov[i] + 1];
+    }
+  }
+  for ( int v = 0; v < nv; ++v ) {
+    buf.inBegin[v + 1] += buf.inBegin[v];
+    buf.outBegin[v + 1] += buf.outBegin[v];
+  }
+  buf.in.resize(buf.inBegin[nv]);
+  buf.out.resize(buf.outBegin[nv]);
+  buf.cursor.assign(buf.inBegin.begin(), buf.inBegin.end() - 1);
+  for ( int i = 0; i < nall; ++i )
+    if ( buf.decv[i] >= 0 ) buf.in[buf.cursor[buf.decv[i]]++] = i;
+  buf.cursor.assign(buf.outBegin.begin(), buf.outBegin.end() - 1);
+  for ( int i = 0; i < nall; ++i )
+    if ( buf.prov[i] >= 0 ) buf.out[buf.cursor[buf.prov[i]]++] = i;
+
   // Time to create the GenVertex's
-  for ( typename VertexMap::iterator it = prov.begin(); it != prov.end(); ++it )
-    if ( !member(vmap, it->second) )
-      vmap[it->second] = createVertex(it->second);
-  for ( typename VertexMap::iterator it = decv.begin(); it != decv.end(); ++it )
-    if ( !member(vmap, it->second) )
-      vmap[it->second] = createVertex(it->second);
+  buf.vertex.assign(nv, GenVertexPtrT());
+  buf.added.assign(nv, 0);
+  Traits::reserve(*geneve, nall, nv);
+  for ( int v = 0; v < nv; ++v )
+    if ( buf.link[v] == v ) buf.vertex[v] = createVertex(v);
 
   // First add the decay vertices for the first beam particle to avoid issue in HepMC3
-  const Vertex * prim = decv[ev.incoming().first];
-  if(prim) {
-    Traits::addVertex(*geneve, vmap[prim]);
-    vmap.erase(prim);
-  }
+  int beam = position(ev.incoming().first);
+  if ( beam >= 0 && buf.decv[beam] >= 0 ) addVertex(buf.decv[beam]);
 
   // Now find the primary signal process vertex defined to be the
   // decay vertex of the first parton coming into the primary hard
   // sub-collision.
   tSubProPtr sub = ev.primarySubProcess();
   if ( sub && sub->incoming().first && sub->incoming().first!=ev.incoming().first) {
-    const Vertex * prim = decv[sub->incoming().first];
-    Traits::setSignalProcessVertex(*geneve, vmap[prim]);
-    vmap.erase(prim);
+    int prim = position(sub->incoming().first);
+    if ( prim >= 0 && buf.decv[prim] >= 0 ) addVertex(buf.decv[prim], true);
   }
   
   // Then add the rest of the vertices.
-  for ( typename GenVertexMap::iterator it = vmap.begin();
-	it != vmap.end(); ++it )
-    Traits::addVertex(*geneve, it->second);
-
-  // and the incoming beam particles
-  Traits::setBeamParticles(*geneve,pmap[ev.incoming().first],
-			   pmap[ev.incoming().second]);
+  for ( int v = 0; v < nv; ++v )
+    if ( buf.vertex[v] && !buf.added[v] ) addVertex(v);
+
+  // and the incoming beam particles (null if not in the event)
+  int beam1 = position(ev.incoming().first);
+  int beam2 = position(ev.incoming().second);
+  Traits::setBeamParticles(*geneve,
+			   beam1 >= 0? buf.gen[beam1]: GenParticlePtrT(),
+			   beam2 >= 0? buf.gen[beam2]: GenParticlePtrT());
   // and the PDF info
   setPdfInfo(ev);
   
@@ -197,29 +266,11 @@ void HepMCConverter<HepMCEventT,Traits>::init(const Event & ev, bool nocopies) {
   Traits::setCrossSection(*geneve,
 			  eh->integratedXSec()/picobarn,
 			  eh->integratedXSecErr()/picobarn);
-  for ( int i = 0, N = all.size(); i < N; ++i ) {
-    tcPPtr p = all[i];
-    if ( pmap.find(p) == pmap.end() ) continue;
-    GenParticlePtrT gp = pmap[p];
-    if ( p->hasColourInfo() ) {
-      // Check if the particle is connected to colour lines, in which
-      // case the lines are mapped to an integer and set in the
-      // GenParticle's Flow info.
-      tcColinePtr l;
-      if ( (l = p->colourLine()) ) {
-	if ( !member(flowmap, l) ) flowmap[l] = flowmap.size() + 500;
-	Traits::setColourLine(*gp, 1, flowmap[l]);
-      }
-      if ( (l = p->antiColourLine()) ) {
-	if ( !member(flowmap, l) ) flowmap[l] = flowmap.size() + 500;
-	Traits::setColourLine(*gp, 2, flowmap[l]);
-      }
-   }
-   if ( p->spinInfo() && p->spinInfo()->hasPolarization() ) {
-    DPair pol = p->spinInfo()->polarization();
-    Traits::setPolarization(*gp, pol.first, pol.second);
-   }
-   }
+
+  // Release the references to the created objects, keeping the
+  // allocated tables for the next event.
+  buf.gen.clear();
+  buf.vertex.clear();
 }
 
 template <typename HepMCEventT, typename Traits>
@@ -265,31 +316,49 @@ HepMCConverter<HepMCEventT,Traits>::createParticle(tcPPtr p) const {
 }
 
 template <typename HepMCEventT, typename Traits>
-void HepMCConverter<HepMCEventT,Traits>::join(tcPPtr parent, tcPPtr child) {
-  Vertex * dec = decv[parent];
-  Vertex * pro = prov[child];
-  if ( !pro || !dec ) Throw<HepMCConverterException>()
-    << "Found a reference to a ThePEG::Particle which was not in the Event."
-    << Exception::eventerror;
-  if ( pro == dec ) return;
-  while ( !pro->in.empty() ) {
-    dec->in.insert(*(pro->in.begin()));
-    decv[*(pro->in.begin())] = dec;
-    pro->in.erase(pro->in.begin());
-  }
-  while ( !pro->out.empty() ) {
-    dec->out.insert(*(pro->out.begin()));
-    prov[*(pro->out.begin())] = dec;
-    pro->out.erase(pro->out.begin());
+typename HepMCConverter<HepMCEventT,Traits>::Buffers &
+HepMCConverter<HepMCEventT,Traits>::buffers() {
+  static thread_local Buffers theBuffers;
+  return theBuffers;
+}
+
+template <typename HepMCEventT, typename Traits>
+int HepMCConverter<HepMCEventT,Traits>::position(tcPPtr p) const {
+  if ( !p ) return -1;
+  int index = p->index();
+  if ( index > 0 && index < int(buf.slot.size()) ) {
+    int pos = buf.slot[index] - 1;
+    if ( pos >= 0 && buf.all[pos] == p ) return pos;
   }
+  if ( buf.other.empty() ) return -1;
+  typename std::unordered_map<const Particle *,int>::const_iterator it =
+    buf.other.find(p.operator->());
+  return it == buf.other.end()? -1: it->second;
 }
 
 template <typename HepMCEventT, typename Traits>
-typename HepMCConverter<HepMCEventT,Traits>::GenVertexPtrT
-HepMCConverter<HepMCEventT,Traits>::createVertex(Vertex * v) {
-  if ( !v ) Throw<HepMCConverterException>()
-    << "Found internal null Vertex." << Exception::abortnow;
+int HepMCConverter<HepMCEventT,Traits>::root(int v) {
+  while ( buf.link[v] != v ) v = buf.link[v] = buf.link[buf.link[v]];
+  return v;
+}
 
+template <typename HepMCEventT, typename Traits>
+void HepMCConverter<HepMCEventT,Traits>::join(tcPPtr parent, tcPPtr child) {
+  int ppos = position(parent);
+  int cpos = position(child);
+  if ( ppos < 0 || cpos < 0 ||
+       buf.decv[ppos] < 0 || buf.prov[cpos] < 0 )
+    Throw<HepMCConverterException>()
+      << "Found a reference to a ThePEG::Particle which was not in the Event."
+      << Exception::eventerror;
+  int dec = root(buf.decv[ppos]);
+  int pro = root(buf.prov[cpos]);
+  if ( pro != dec ) buf.link[pro] = dec;
+}
+
+template <typename HepMCEventT, typename Traits>
+typename HepMCConverter<HepMCEventT,Traits>::GenVertexPtrT
+HepMCConverter<HepMCEventT,Traits>::createVertex(int v) {
   GenVertexPtrT gv = Traits::newVertex();
 
   // We assume that the vertex position is the average of the decay
@@ -297,23 +366,29 @@ HepMCConverter<HepMCEventT,Traits>::createVertex(Vertex * v) {
   // outgoing particles in the lab. Note that this will probably not
   // be useful information for very small distances.
   LorentzPoint p;
-  for ( tcParticleSet::iterator it = v->in.begin();
-	it != v->in.end(); ++it ) {
-    p += (**it).labDecayVertex();
-    Traits::addIncoming(*gv, pmap[*it]);
+  for ( int i = buf.inBegin[v]; i < buf.inBegin[v + 1]; ++i ) {
+    p += buf.all[buf.in[i]]->labDecayVertex();
+    Traits::addIncoming(*gv, buf.gen[buf.in[i]]);
   }
-  for ( tcParticleSet::iterator it = v->out.begin();
-	it != v->out.end(); ++it ) {
-    p += (**it).labVertex();
-    Traits::addOutgoing(*gv, pmap[*it]);
+  for ( int i = buf.outBegin[v]; i < buf.outBegin[v + 1]; ++i ) {
+    p += buf.all[buf.out[i]]->labVertex();
+    Traits::addOutgoing(*gv, buf.gen[buf.out[i]]);
   }
 
-  p /= double(v->in.size() + v->out.size());
+  p /= double(buf.inBegin[v + 1] - buf.inBegin[v] +
+	      buf.outBegin[v + 1] - buf.outBegin[v]);
   Traits::setPosition(*gv, p, lengthUnit);
 
   return gv;
 }
 
+template <typename HepMCEventT, typename Traits>
+void HepMCConverter<HepMCEventT,Traits>::addVertex(int v, bool signal) {
+  if ( signal ) Traits::setSignalProcessVertex(*geneve, buf.vertex[v]);
+  else if ( !buf.added[v] ) Traits::addVertex(*geneve, buf.vertex[v]);
+  buf.added[v] = 1;
+}
+
 template <typename HepMCEventT, typename Traits>
 void HepMCConverter<HepMCEventT,Traits>::setPdfInfo(const Event & e) {
   // ids of the partons going into the primary sub process
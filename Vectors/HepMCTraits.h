@@ -245,6 +245,16 @@ struct HepMCTraitsBase {
     e.add_vertex(v);
   }
 
+  /** Reserve space for \a np particles and \a nv vertices in the
+      event \a e. This is a no-op if not supported by HepMC. */
+#ifdef HAVE_HEPMC3
+  static void reserve(EventT & e, size_t np, size_t nv) {
+    e.reserve(np, nv);
+  }
+#else
+  static void reserve(EventT &, size_t, size_t) {}
+#endif
+
   /** Create a new particle object with momentum \a p, PDG number \a
       id and status code \a status. The momentum will be scaled with
       \a unit which according to the HepMC documentation should be
@@ -294,11 +304,12 @@ struct HepMCTraitsBase {
     v.set_position(p_scaled);
   }
 
-  /** Set the beam particles for the event.*/
+  /** Set the beam particles for the event. Either particle may be
+      null if it was not found. */
   static void setBeamParticles(EventT & e, ParticlePtrT p1, ParticlePtrT p2) {
     e.set_beam_particles(p1,p2);
-    p1->set_status(4);
-    p2->set_status(4);
+    if ( p1 ) p1->set_status(4);
+    if ( p2 ) p2->set_status(4);
   }
 
   /** Set the PDF info for the event. */
@@ -219,6 +219,55 @@ AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[#include <cmath>
 echo "${ECHO_T}yes" 1>&6
 ],[echo "${ECHO_T}no" 1>&6])])
 
+AC_DEFUN([THEPEG_CHECK_PTHREAD],
+[echo $ECHO_N "checking whether $CXX needs -pthread for std::thread... $ECHO_C" 1>&6
+PTHREAD_CXXFLAGS=""
+AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <thread>
+]], [[std::thread t([](){}); t.join();
+]])],[echo "${ECHO_T}no" 1>&6],
+[oldCXXFLAGS="$CXXFLAGS"
+CXXFLAGS="$CXXFLAGS -pthread"
+AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <thread>
+]], [[std::thread t([](){}); t.join();
+]])],[PTHREAD_CXXFLAGS="-pthread"
+echo "${ECHO_T}yes" 1>&6],
+[AC_MSG_ERROR([ThePEG needs a working std::thread.])])
+CXXFLAGS="$oldCXXFLAGS"])
+AC_SUBST(PTHREAD_CXXFLAGS)])
+
+AC_DEFUN([THEPEG_CHECK_COMPRESSION],
+[AC_ARG_WITH(compression,
+  AS_HELP_STRING([--without-compression],
+    [do not use libbz2, liblzma and libzstd to read compressed files.]),
+  [], [with_compression=yes])
+if test "x$with_compression" != "xno"; then
+  AC_CHECK_HEADER([bzlib.h],
+    [AC_CHECK_LIB([bz2], [BZ2_bzDecompressInit],
+      [AC_DEFINE(HAVE_LIBBZ2,1,[define if libbz2 is available])
+       LIBS="-lbz2 $LIBS"])])
+  AC_CHECK_HEADER([lzma.h],
+    [AC_CHECK_LIB([lzma], [lzma_stream_decoder],
+      [AC_DEFINE(HAVE_LIBLZMA,1,[define if liblzma is available])
+       LIBS="-llzma $LIBS"])])
+  AC_CHECK_HEADER([zstd.h],
+    [AC_CHECK_LIB([zstd], [ZSTD_decompressStream],
+      [AC_DEFINE(HAVE_LIBZSTD,1,[define if libzstd is available])
+       LIBS="-lzstd $LIBS"])])
+fi])
+
+AC_DEFUN([THEPEG_CHECK_ATOMIC_REFCOUNT],
+[AC_ARG_ENABLE(atomic-refcount,
+  AS_HELP_STRING([--enable-atomic-refcount],
+    [use thread-safe reference counting for all ThePEG objects.]),
+  [], [enable_atomic_refcount=no])
+AC_MSG_CHECKING([whether to use atomic reference counting])
+if test "x$enable_atomic_refcount" != "xno"; then
+  AC_DEFINE(ThePEG_ATOMIC_REFCOUNT,1,[define to use thread-safe reference counting])
+  AC_MSG_RESULT([yes])
+else
+  AC_MSG_RESULT([no])
+fi])
+
 AC_DEFUN([THEPEG_CHECK_DLOPEN],
 [echo $ECHO_N "checking for dlopen... $ECHO_C" 1>&6
 # do this with libtool!
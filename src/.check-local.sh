@@ -10,5 +10,58 @@ time ./runThePEG --resume -d 0 SimpleLEP.dump
 diff <( grep -v '>>>>' SimpleLEP.out ) <( grep -v '>>>>' SimpleLEP.cmp )
 rm SimpleLEP.cmp
 time ./runThePEG -d 0 -m SimpleLEP.mod SimpleLEP.run
+./setupThePEG --exitonerror -r ThePEGDefaults.rpo GridLEP.in
+rm -f GridLEP.grid
+time ./runThePEG -d 0 GridLEP.run
+grep -q 'saved to the grid file' GridLEP.log
+time ./runThePEG -d 0 GridLEP.run
+grep -q 'read from the grid file' GridLEP.log
+# In a multi-threaded run only the first worker writes the grid file.
+rm -f GridLEP.grid
+time ./runThePEG -d 0 -j 2 GridLEP.run
+grep -q 'saved to the grid file' GridLEP-thread0.log
+! grep -q 'saved to the grid file' GridLEP-thread1.log
+time ./runThePEG -d 0 -j 2 GridLEP.run
+grep -q 'read from the grid file' GridLEP-thread0.log
+grep -q 'read from the grid file' GridLEP-thread1.log
+./setupThePEG --exitonerror -r ThePEGDefaults.rpo LHEFLEP.in
+time ./runThePEG -d 0 LHEFLEP.run
+./setupThePEG --exitonerror -r ThePEGDefaults.rpo LHEFRead.in
+time ./runThePEG -d 0 LHEFRead.run
+# The cross section (in nb) read back from the compressed file must
+# agree with the final one (in pb) given in the uncompressed file.
+xsec=$( sed -n '/<init>/{n;n;p;q;}' LHEFLEP.lhe )
+xread=$( grep '^Total:' LHEFRead.out | awk '{ print $4 }' | sed 's/([0-9]*)//' )
+awk -v x="$xsec" -v r="$xread" \
+  'BEGIN { split(x, a); exit !( (1000*r - a[1])^2 < 9*a[2]^2 ) }'
+# Each worker in a multi-threaded run caches the events in its own file.
+rm -f LHEFRead.cache LHEFRead.cache-thread1
+time ./runThePEG -d 0 -j 2 LHEFRead.run
+test -s LHEFRead.cache
+test -s LHEFRead.cache-thread1
 ./setupThePEG --exitonerror -r ThePEGDefaults.rpo MultiLEP.in
 time ./runThePEG -d 0 MultiLEP.run
+./setupThePEG --exitonerror -r ThePEGDefaults.rpo VegasLEP.in
+mv VegasLEP.out VegasLEP.cmp
+time ./runThePEG --resume -d 0 VegasLEP.dump
+diff <( grep -v '>>>>' VegasLEP.out ) <( grep -v '>>>>' VegasLEP.cmp )
+rm VegasLEP.cmp
+time ./runThePEG -d 0 -j 2 SimpleLEP.run
+mv SimpleLEP.out SimpleLEP.cmp
+time ./runThePEG -d 0 -j 2 --unordered SimpleLEP.run
+diff <( grep -v '>>>>' SimpleLEP.out ) <( grep -v '>>>>' SimpleLEP.cmp )
+rm SimpleLEP.cmp
+./setupThePEG --exitonerror --binary -r ThePEGDefaults.rpo SimpleLEP.in
+mv SimpleLEP.out SimpleLEP.cmp
+time ./runThePEG -d 0 SimpleLEP.run
+diff <( grep -v '>>>>' SimpleLEP.out ) <( grep -v '>>>>' SimpleLEP.cmp )
+rm SimpleLEP.cmp
+# An indexed run-file gives the same result, while only the objects
+# actually used are read in.
+./setupThePEG --exitonerror --indexed -r ThePEGDefaults.rpo SimpleLEP.in
+mv SimpleLEP.out SimpleLEP.cmp
+stats=$( ./runThePEG -d 0 --stats SimpleLEP.run | grep '^Read ' )
+diff <( grep -v '>>>>' SimpleLEP.out ) <( grep -v '>>>>' SimpleLEP.cmp )
+rm SimpleLEP.cmp
+awk -v s="$stats" 'BEGIN { split(s, a); exit !( 0 < a[2] && a[2] < a[4] ) }'
+time ./runThePEG -d 0 -j 2 SimpleLEP.run
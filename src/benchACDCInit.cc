@@ -0,0 +1,128 @@
+// -*- C++ -*-
+//
+// benchACDCInit.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark of the initialization of the ACDCSampler. Each run file
+// given on the command line (typically SimpleLEP.run) is read in and
+// initialized with the cells of the different bins built with one,
+// two and four threads, reporting the time needed for each bin and in
+// total. The resulting cross section and a few generated events are
+// compared to check that the result does not depend on the number of
+// threads (larger than one).
+//
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Handlers/StandardEventHandler.h"
+#include "ThePEG/Handlers/ACDCSampler.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/DescriptionList.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Read the generator in \a run, initialize it using \a nthreads
+ * threads to build the cells, and generate \a neve events. Returns a
+ * string summarizing the resulting cross section and events.
+ */
+string bench(string run, int nthreads, int neve) {
+  EGPtr eg;
+  PersistentIStream is(run);
+  is >> eg;
+  if ( !eg ) throw Exception() << "No generator found in " << run << "."
+			       << Exception::runerror;
+  Ptr<StandardEventHandler>::tptr eh =
+    dynamic_ptr_cast<Ptr<StandardEventHandler>::tptr>(eg->eventHandler());
+  // The ACDCSampler class lives in a dynamically loaded module, so
+  // check its class description rather than using a dynamic_cast.
+  const ClassDescriptionBase * acdc =
+    DescriptionList::find("ThePEG::ACDCSampler");
+  const ClassDescriptionBase * db = eh && eh->sampler()?
+    DescriptionList::find(typeid(*eh->sampler())): 0;
+  ACDCSampler * sampler = acdc && db && db->isA(*acdc)?
+    static_cast<ACDCSampler *>(eh->sampler().operator->()): 0;
+  if ( !sampler ) throw Exception() << "The generator in " << run
+				    << " does not use an ACDCSampler."
+				    << Exception::runerror;
+  BaseRepository::FindInterface(sampler, "InitThreads")
+    ->exec(*sampler, "set", std::to_string(nthreads));
+
+  Clock::time_point start = Clock::now();
+  eg->initialize();
+  double t = seconds(start);
+  const vector<double> & times = sampler->binTimes();
+  double sum = 0.0;
+  for ( int i = 0, N = times.size(); i < N; ++i ) sum += times[i];
+  cout << "  " << nthreads << " thread(s): " << setw(8) << 1.0e3*t
+       << " ms in total, " << setw(8) << 1.0e3*sum << " ms in "
+       << times.size() << " bins:";
+  for ( int i = 0, N = times.size(); i < N; ++i )
+    cout << " " << 1.0e3*times[i];
+  cout << endl;
+
+  ostringstream summary;
+  summary << setprecision(17) << sampler->integratedXSec()/nanobarn;
+  for ( int i = 0; i < neve; ++i ) {
+    tPVector final = eg->shoot()->getFinalState();
+    for ( int j = 0, M = final.size(); j < M; ++j )
+      summary << " " << final[j]->id() << " " << final[j]->momentum().z()/GeV;
+  }
+  eg->finalize();
+  return summary.str();
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  vector<string> runs;
+  int neve = 10;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) neve = max(atoi(argv[++iarg]), 0);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-N events] [-l load-path] "
+	   << "[-L first-load-path] run-file..." << endl;
+      return 3;
+    }
+    else runs.push_back(arg);
+  }
+
+  try {
+    for ( int i = 0, N = runs.size(); i < N; ++i ) {
+      cout << runs[i] << ":" << endl;
+      bench(runs[i], 1, neve);
+      string two = bench(runs[i], 2, neve);
+      string four = bench(runs[i], 4, neve);
+      if ( two != four ) {
+	cerr << "The results with two and four threads differ." << endl;
+	return 1;
+      }
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+// -*- C++ -*-
+//
+// benchColumns.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark of the columnar final state snapshot given by
+// Event::finalStateColumns(). Events are generated from each run file
+// given on the command line (typically SimpleLEP.run), and for each
+// event a number of identical toy analyses, summing the transverse
+// momenta and counting the central charged particles, are run either
+// by following the pointers of the event record or by using the
+// cached snapshot. The time spent in the analyses is reported and
+// the results are compared.
+//
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/PDT/ParticleData.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * The result of the toy analysis.
+ */
+struct Result {
+  Result(): sumPt(0.0), central(0) {}
+  /** The sum of the transverse momenta in GeV. */
+  double sumPt;
+  /** The number of charged particles with |y| < 2.5. */
+  long central;
+};
+
+/**
+ * The toy analysis following the pointers of the event record.
+ */
+void analyze(const tPVector & particles, Result & res) {
+  for ( int i = 0, N = particles.size(); i < N; ++i ) {
+    const Particle & p = *particles[i];
+    res.sumPt += p.momentum().perp()/GeV;
+    if ( p.data().iCharge() != 0 && abs(p.momentum().rapidity()) < 2.5 )
+      ++res.central;
+  }
+}
+
+/**
+ * The toy analysis using the columnar snapshot.
+ */
+void analyze(const ParticleColumns & c, Result & res) {
+  const double * pt = c.pt().data();
+  const double * y = c.rapidity().data();
+  const int * charge = c.iCharge().data();
+  for ( int i = 0, N = c.size(); i < N; ++i ) {
+    res.sumPt += pt[i];
+    if ( charge[i] != 0 && abs(y[i]) < 2.5 ) ++res.central;
+  }
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  vector<string> runs;
+  int neve = 1000;
+  int nana = 100;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) neve = max(atoi(argv[++iarg]), 0);
+    else if ( arg == "-A" ) nana = max(atoi(argv[++iarg]), 1);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-N events] [-A analyses] "
+	   << "[-l load-path] [-L first-load-path] run-file..." << endl;
+      return 3;
+    }
+    else runs.push_back(arg);
+  }
+
+  try {
+    for ( int i = 0, N = runs.size(); i < N; ++i ) {
+      EGPtr eg;
+      PersistentIStream is(runs[i]);
+      is >> eg;
+      if ( !eg ) throw Exception() << "No generator found in " << runs[i]
+				   << "." << Exception::runerror;
+      BaseRepository::FindInterface(eg, "NumberOfEvents")
+	->exec(*eg, "set", std::to_string(neve));
+      eg->initialize();
+      Result pointers;
+      Result columns;
+      double tpointers = 0.0;
+      double tcolumns = 0.0;
+      long nparticles = 0;
+      for ( int ieve = 0; ieve < neve; ++ieve ) {
+	EventPtr event = eg->shoot();
+	Clock::time_point start = Clock::now();
+	for ( int iana = 0; iana < nana; ++iana )
+	  analyze(event->getFinalState(), pointers);
+	tpointers += seconds(start);
+	start = Clock::now();
+	for ( int iana = 0; iana < nana; ++iana )
+	  analyze(event->finalStateColumns(), columns);
+	tcolumns += seconds(start);
+	nparticles += event->finalStateColumns().size();
+      }
+      eg->finalize();
+      cout << runs[i] << ": " << double(nparticles)/max(neve, 1)
+	   << " final state particles per event, " << nana
+	   << " analyses per event" << endl
+	   << "  pointers: " << setw(10) << 1.0e6*tpointers/max(neve, 1)
+	   << " us/event" << endl
+	   << "  columns:  " << setw(10) << 1.0e6*tcolumns/max(neve, 1)
+	   << " us/event" << endl;
+      if ( pointers.central != columns.central ||
+	   abs(pointers.sumPt - columns.sumPt) >
+	   1.0e-9*max(abs(pointers.sumPt), 1.0) ) {
+	cerr << "The results of the analyses differ." << endl;
+	return 1;
+      }
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
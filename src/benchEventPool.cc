@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// benchEventPool.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark of the EventPool used to allocate the objects of the event
+// record. Each run file given on the command line (typically
+// SimpleLEP.run) is read in and a number of events are generated,
+// first with the reuse of released objects switched off and then with
+// it switched on. The time per event and the number of objects
+// allocated from the system per event are reported, and the generated
+// events are compared to check that they do not depend on the pool.
+//
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/EventRecord/EventPool.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Read the generator in \a run, initialize it and generate \a neve
+ * events with the pool switched on or off according to \a pool.
+ * Returns a string summarizing the generated events.
+ */
+string bench(string run, bool pool, int neve) {
+  EGPtr eg;
+  PersistentIStream is(run);
+  is >> eg;
+  if ( !eg ) throw Exception() << "No generator found in " << run << "."
+			       << Exception::runerror;
+  BaseRepository::FindInterface(eg, "NumberOfEvents")
+    ->exec(*eg, "set", std::to_string(neve));
+  EventPoolBase::enabled(pool);
+  eg->initialize();
+
+  ostringstream summary;
+  summary << setprecision(17);
+  const EventPoolCounters & c = EventPoolBase::counters();
+  long first = 0;
+  long allocated = c.allocated;
+  long reused = c.reused;
+  Clock::time_point start = Clock::now();
+  for ( int i = 0; i < neve; ++i ) {
+    tPVector final = eg->shoot()->getFinalState();
+    for ( int j = 0, M = final.size(); j < M; ++j )
+      summary << " " << final[j]->id() << " " << final[j]->momentum().z()/GeV;
+    if ( i == 0 ) first = c.allocated - allocated;
+  }
+  double t = seconds(start);
+  double n = max(neve - 1, 1);
+  cout << "  pool " << ( pool? "on: ": "off:" ) << setw(10)
+       << 1.0e6*t/max(neve, 1) << " us/event, allocated " << setw(6) << first
+       << " objects in the first event and " << setw(8)
+       << ( c.allocated - allocated - first )/n << " per event after that, "
+       << setw(8) << ( c.reused - reused )/n << " reused per event" << endl;
+  eg->finalize();
+  EventPoolBase::enabled(true);
+  return summary.str();
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  vector<string> runs;
+  int neve = 10000;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) neve = max(atoi(argv[++iarg]), 0);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-N events] [-l load-path] "
+	   << "[-L first-load-path] run-file..." << endl;
+      return 3;
+    }
+    else runs.push_back(arg);
+  }
+
+  try {
+    for ( int i = 0, N = runs.size(); i < N; ++i ) {
+      cout << runs[i] << ":" << endl;
+      string off = bench(runs[i], false, neve);
+      string on = bench(runs[i], true, neve);
+      if ( off != on ) {
+	cerr << "The events generated with and without the pool differ."
+	     << endl;
+	return 1;
+      }
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
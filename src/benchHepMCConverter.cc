@@ -0,0 +1,135 @@
+// -*- C++ -*-
+//
+// benchHepMCConverter.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark of the HepMCConverter. An event is generated from each
+// run file given on the command line (typically SimpleLEP.run), after
+// which final state particles are repeatedly split in two in a new
+// step until the event contains a given number of particles (5000 by
+// default). The event is then converted to a HepMC::GenEvent a number
+// of times and the time per conversion is reported.
+//
+#include <config.h>
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/EventRecord/Step.h"
+#include "ThePEG/PDT/ParticleData.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/Exception.h"
+#include "ThePEG/Config/HepMCHelper.h"
+#include "ThePEG/Vectors/HepMCConverter.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Add a new step to \a event where final state particles are split
+ * in two until there are at least \a npart particles in the event.
+ */
+void grow(tEventPtr event, int npart) {
+  tcPVector all;
+  event->select(back_inserter(all), SelectAll());
+  int n = all.size();
+  tStepPtr step = event->newStep();
+  while ( n < npart ) {
+    tPVector final = step->getFinalState();
+    for ( int i = 0, N = final.size(); i < N && n < npart; ++i ) {
+      tPPtr p = final[i];
+      Lorentz5Momentum half(0.5*p->momentum());
+      step->addDecayProduct(p, p->data().produceParticle(half));
+      step->addDecayProduct(p, p->data().produceParticle(half));
+      n += 2;
+    }
+  }
+}
+
+/**
+ * Return the number of particles and vertices in a GenEvent.
+ */
+pair<long,long> size(const HepMC::GenEvent & gev) {
+#ifdef HAVE_HEPMC3
+  return make_pair(long(gev.particles().size()), long(gev.vertices().size()));
+#else
+  return make_pair(long(gev.particles_size()), long(gev.vertices_size()));
+#endif
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  vector<string> runs;
+  int nconv = 1000;
+  int npart = 5000;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) nconv = max(atoi(argv[++iarg]), 1);
+    else if ( arg == "-P" ) npart = max(atoi(argv[++iarg]), 0);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-N conversions] [-P particles] "
+	   << "[-l load-path] [-L first-load-path] run-file..." << endl;
+      return 3;
+    }
+    else runs.push_back(arg);
+  }
+
+  try {
+    for ( int i = 0, N = runs.size(); i < N; ++i ) {
+      EGPtr eg;
+      PersistentIStream is(runs[i]);
+      is >> eg;
+      if ( !eg ) throw Exception() << "No generator found in " << runs[i]
+				   << "." << Exception::runerror;
+      BaseRepository::FindInterface(eg, "NumberOfEvents")->exec(*eg, "set", "1");
+      eg->initialize();
+      EventPtr event = eg->shoot();
+      grow(event, npart);
+      tcPVector all;
+      event->select(back_inserter(all), SelectAll());
+
+      pair<long,long> sizes;
+      Clock::time_point start = Clock::now();
+      for ( int iconv = 0; iconv < nconv; ++iconv ) {
+	HepMC::GenEvent * geneve =
+	  HepMCConverter<HepMC::GenEvent>::convert(*event);
+	sizes = size(*geneve);
+	delete geneve;
+      }
+      double t = seconds(start);
+      eg->finalize();
+
+      cout << runs[i] << ": " << all.size() << " particles converted to "
+	   << sizes.first << " GenParticles and " << sizes.second
+	   << " GenVertices in " << setw(10) << 1.0e6*t/nconv
+	   << " us/event" << endl;
+      if ( sizes.first != long(all.size()) ) {
+	cerr << "Not all particles were converted." << endl;
+	return 1;
+      }
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
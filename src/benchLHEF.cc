@@ -0,0 +1,236 @@
+// -*- C++ -*-
+//
+// benchLHEF.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark of the Les Houches event file parsing. A synthetic event
+// file with (by default) one million 2->5 events, each with a block
+// of reweighting weights, is written and then read back with
+// LesHouchesFileReader, both directly and with events read ahead on
+// a separate thread, either owned by the reader or taken from a common
+// pool. For comparison the same file is also parsed with a
+// std::istringstream per line, as a naive reader would do.
+//
+#include "ThePEG/LesHouches/LesHouchesFileReader.h"
+#include "ThePEG/Repository/BaseRepository.h"
+#include "ThePEG/Interface/InterfaceBase.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Write a synthetic event file with \a neve events, each with \a nwgt
+ * reweighting weights.
+ */
+void writeFile(string name, long neve, int nwgt) {
+  FILE * f = std::fopen(name.c_str(), "w");
+  if ( !f ) throw Exception() << "Could not open '" << name
+			      << "' for writing." << Exception::runerror;
+  std::fprintf(f, "<LesHouchesEvents version=\"3.0\">\n<header>\n");
+  std::fprintf(f, "<initrwgt>\n<weightgroup name='scale_variation'>\n");
+  for ( int i = 0; i < nwgt; ++i )
+    std::fprintf(f, "<weight id='%d'> muR=%.1f muF=%.1f </weight>\n",
+		 1001 + i, 0.5*(1 + i%3), 0.5*(1 + i/3));
+  std::fprintf(f, "</weightgroup>\n</initrwgt>\n</header>\n<init>\n");
+  std::fprintf(f, " 2212 2212 6.5000000e+03 6.5000000e+03 0 0 "
+	       "247000 247000 -4 1\n");
+  std::fprintf(f, " 1.0000000e+01 1.0000000e-01 1.0000000e+00 1\n</init>\n");
+  std::mt19937_64 gen(4711);
+  std::uniform_real_distribution<double> flat(-1.0, 1.0);
+  const int ids[] = { 21, 2, 11, -11, 21, 1, -1 };
+  for ( long ieve = 0; ieve < neve; ++ieve ) {
+    std::fprintf(f, "<event>\n 7 1 %+.10e %.8e %.8e %.8e\n",
+		 1.0 + 0.1*flat(gen), 91.188*(1.0 + 0.5*flat(gen)),
+		 0.0078186, 0.118);
+    for ( int i = 0; i < 7; ++i ) {
+      double px = i < 2? 0.0: 100.0*flat(gen);
+      double py = i < 2? 0.0: 100.0*flat(gen);
+      double pz = i < 2? ( i? -1.0: 1.0 )*500.0*(1.0 + flat(gen)):
+	200.0*flat(gen);
+      double m = std::abs(ids[i]) == 11? 0.000511: 0.0;
+      double e = std::sqrt(px*px + py*py + pz*pz + m*m);
+      std::fprintf(f, " %8d %2d %4d %4d %4d %4d %+.10e %+.10e %+.10e "
+		   "%.10e %.10e %.4e %.4e\n",
+		   ids[i], i < 2? -1: 1, i < 2? 0: 1, i < 2? 0: 2,
+		   ids[i] > 0 && ids[i] < 11? 501: ( ids[i] == 21? 502: 0 ),
+		   ids[i] < 0 && ids[i] > -11? 501: ( ids[i] == 21? 501: 0 ),
+		   px, py, pz, e, m, 0.0, 9.0);
+    }
+    if ( nwgt > 0 ) {
+      std::fprintf(f, "<rwgt>\n");
+      for ( int i = 0; i < nwgt; ++i )
+	std::fprintf(f, "<wgt id='%d'> %+.10e </wgt>\n",
+		     1001 + i, 1.0 + 0.2*flat(gen));
+      std::fprintf(f, "</rwgt>\n");
+    }
+    std::fprintf(f, "</event>\n");
+  }
+  std::fprintf(f, "</LesHouchesEvents>\n");
+  std::fclose(f);
+}
+
+/**
+ * Helper class giving access to the protected HEPEUP block of a
+ * reader.
+ */
+struct EventAccess: public LesHouchesFileReader {
+  /** Return the HEPEUP block of \a r. */
+  static const HEPEUP & block(const LesHouchesReader & r) {
+    return r.*(&EventAccess::hepeup);
+  }
+};
+
+/**
+ * Set the interface \a name of \a reader to \a value.
+ */
+void set(Ptr<LesHouchesFileReader>::pointer reader, string name, string value) {
+  BaseRepository::FindInterface(reader, name)->exec(*reader, "set", value);
+}
+
+/**
+ * Read the file with LesHouchesFileReader, reading \a prefetch events
+ * ahead on a separate thread, and return the number of events read.
+ */
+long readThePEG(string name, double & sumw, int prefetch) {
+  Ptr<LesHouchesFileReader>::pointer reader = new_ptr(LesHouchesFileReader());
+  set(reader, "FileName", name);
+  set(reader, "CutEarly", "No");
+  set(reader, "PrefetchEvents", std::to_string(prefetch));
+  reader->open();
+  const HEPEUP & hepeup = EventAccess::block(*reader);
+  long n = 0;
+  while ( reader->readEvent() ) {
+    sumw += hepeup.XWGTUP + hepeup.PUP[6][3];
+    ++n;
+  }
+  reader->close();
+  return n;
+}
+
+/**
+ * Read the events in the file using one std::istringstream per line,
+ * and return the number of events read.
+ */
+long readStream(string name, double & sumw) {
+  std::ifstream is(name.c_str());
+  string line;
+  long n = 0;
+  HEPEUP hepeup;
+  while ( std::getline(is, line) ) {
+    if ( line.find("<event") == string::npos ) continue;
+    if ( !std::getline(is, line) ) break;
+    std::istringstream ievent(line);
+    ievent >> hepeup.NUP >> hepeup.IDPRUP >> hepeup.XWGTUP
+	   >> hepeup.SCALUP >> hepeup.AQEDUP >> hepeup.AQCDUP;
+    hepeup.resize();
+    for ( int i = 0; i < hepeup.NUP; ++i ) {
+      std::getline(is, line);
+      std::istringstream ip(line);
+      ip >> hepeup.IDUP[i] >> hepeup.ISTUP[i]
+	 >> hepeup.MOTHUP[i].first >> hepeup.MOTHUP[i].second
+	 >> hepeup.ICOLUP[i].first >> hepeup.ICOLUP[i].second
+	 >> hepeup.PUP[i][0] >> hepeup.PUP[i][1] >> hepeup.PUP[i][2]
+	 >> hepeup.PUP[i][3] >> hepeup.PUP[i][4]
+	 >> hepeup.VTIMUP[i] >> hepeup.SPINUP[i];
+    }
+    while ( std::getline(is, line) && line.find("</event>") == string::npos ) {
+      if ( line.find("<wgt") == string::npos ) continue;
+      std::istringstream iw(line);
+      string tag, id;
+      double w;
+      iw >> tag >> id >> w;
+    }
+    sumw += hepeup.XWGTUP + hepeup.PUP[6][3];
+    ++n;
+  }
+  return n;
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  string file = "benchLHEF.lhe";
+  long N = 1000000;
+  int nwgt = 9;
+  bool keep = false;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) N = atol(argv[++iarg]);
+    else if ( arg == "-w" ) nwgt = atoi(argv[++iarg]);
+    else if ( arg == "-f" ) file = argv[++iarg];
+    else if ( arg == "-k" ) keep = true;
+    else {
+      cerr << "Usage: " << argv[0] << " [-N events] [-w weights] "
+	   << "[-f file] [-k]" << endl;
+      return 3;
+    }
+  }
+
+  try {
+    Clock::time_point start = Clock::now();
+    writeFile(file, N, nwgt);
+    cout << "Wrote " << N << " events with " << nwgt << " weights to "
+	 << file << " in " << seconds(start) << " s." << endl;
+
+    double sumw = 0.0;
+    start = Clock::now();
+    long n = readThePEG(file, sumw, 0);
+    double t = seconds(start);
+    cout << "LesHouchesFileReader: " << n << " events in " << t << " s ("
+	 << n/t << " events/s, checksum " << sumw << ")" << endl;
+
+    double sumwp = 0.0;
+    start = Clock::now();
+    long np = readThePEG(file, sumwp, 64);
+    double tp = seconds(start);
+    cout << "  with prefetching:   " << np << " events in " << tp << " s ("
+	 << np/tp << " events/s, checksum " << sumwp << ")" << endl;
+
+    LesHouchesReader::prefetchThreads(1);
+    double sumwq = 0.0;
+    start = Clock::now();
+    long nq = readThePEG(file, sumwq, 64);
+    double tq = seconds(start);
+    LesHouchesReader::releasePrefetchThreads();
+    cout << "  with thread pool:   " << nq << " events in " << tq << " s ("
+	 << nq/tq << " events/s, checksum " << sumwq << ")" << endl;
+
+    double sumws = 0.0;
+    start = Clock::now();
+    long ns = readStream(file, sumws);
+    double ts = seconds(start);
+    cout << "istringstream:        " << ns << " events in " << ts << " s ("
+	 << ns/ts << " events/s, checksum " << sumws << ")" << endl;
+
+    if ( !keep ) std::remove(file.c_str());
+    if ( n != N || np != N || nq != N || ns != N ||
+	 sumw != sumws || sumwp != sumws || sumwq != sumws ) {
+      cerr << "The two readers disagree." << endl;
+      return 1;
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
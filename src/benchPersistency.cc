@@ -0,0 +1,109 @@
+// -*- C++ -*-
+//
+// benchPersistency.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Benchmark comparing the text and binary formats of the persistent
+// streams. Each run file given on the command line (typically
+// SimpleLEP.run and MultiLEP.run) is read in, and the generator is
+// then repeatedly written to and read back from memory in both
+// formats, reporting the size and the time needed.
+//
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Write and read back the generator \a eg n times in the given
+ * format, and report the timing.
+ */
+bool bench(EGPtr eg, int n, bool binary) {
+  string buffer;
+  Clock::time_point start = Clock::now();
+  for ( int i = 0; i < n; ++i ) {
+    ostringstream os;
+    PersistentOStream pos(os, eg->globalLibraries(), binary);
+    pos << eg;
+    buffer = os.str();
+  }
+  double twrite = seconds(start);
+  start = Clock::now();
+  EGPtr copy;
+  for ( int i = 0; i < n; ++i ) {
+    istringstream is(buffer);
+    PersistentIStream pis(is);
+    pis >> copy;
+    if ( !pis || !copy ) return false;
+  }
+  double tread = seconds(start);
+  cout << "  " << ( binary? "binary: ": "text:   " )
+       << setw(9) << buffer.size() << " bytes, write "
+       << setw(8) << 1.0e3*twrite/n << " ms, read "
+       << setw(8) << 1.0e3*tread/n << " ms" << endl;
+  return true;
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  vector<string> runs;
+  int n = 20;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-n" ) n = max(atoi(argv[++iarg]), 1);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-n repetitions] [-l load-path] "
+	   << "[-L first-load-path] run-file..." << endl;
+      return 3;
+    }
+    else runs.push_back(arg);
+  }
+
+  try {
+    for ( int i = 0, N = runs.size(); i < N; ++i ) {
+      EGPtr eg;
+      {
+	Clock::time_point start = Clock::now();
+	PersistentIStream is(runs[i]);
+	is >> eg;
+	if ( !eg ) {
+	  cerr << "No generator found in " << runs[i] << "." << endl;
+	  return 1;
+	}
+	cout << runs[i] << " (" << ( is.binary()? "binary": "text" )
+	     << ", read in " << 1.0e3*seconds(start) << " ms):" << endl;
+      }
+      if ( !bench(eg, n, false) || !bench(eg, n, true) ) {
+	cerr << "Failed to read back the generator from "
+	     << runs[i] << "." << endl;
+	return 1;
+      }
+    }
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,168 @@
+// -*- C++ -*-
+//
+// benchRefCount.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Microbenchmark comparing plain and atomic reference counting. The
+// first part mimics the RCPtr traffic of a typical event, where
+// particles are created, copied into a number of containers and
+// released again, using both ReferenceCounterPolicy alternatives. If
+// a run file is given, the second part generates events with it using
+// the counting policy this version of ThePEG was built with, so that
+// builds with and without --enable-atomic-refcount can be compared.
+//
+#include "ThePEG/Repository/EventGenerator.h"
+#include "ThePEG/EventRecord/Event.h"
+#include "ThePEG/Persistency/PersistentIStream.h"
+#include "ThePEG/Utilities/Debug.h"
+#include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Utilities/Exception.h"
+#include <chrono>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * A minimal reference counted object using the given policy.
+ */
+template <typename Policy>
+struct Counted {
+  Counted(): count(1) {}
+  typename Policy::StorageType count;
+  double momentum[5];
+};
+
+/**
+ * A minimal intrusive pointer to a Counted object.
+ */
+template <typename Policy>
+class Handle {
+public:
+  Handle(): ptr(0) {}
+  explicit Handle(Counted<Policy> * p): ptr(p) {}
+  Handle(const Handle & h): ptr(h.ptr) {
+    if ( ptr ) Policy::increment(ptr->count);
+  }
+  Handle & operator=(const Handle & h) {
+    if ( h.ptr ) Policy::increment(h.ptr->count);
+    release();
+    ptr = h.ptr;
+    return *this;
+  }
+  ~Handle() { release(); }
+private:
+  void release() {
+    if ( ptr && Policy::decrement(ptr->count) ) delete ptr;
+  }
+  Counted<Policy> * ptr;
+};
+
+/**
+ * Simulate nevents events with nparticles particles each. Every
+ * particle is referred to from a step, from the final state and from
+ * a couple of temporary selections, as for a typical LEP event.
+ */
+template <typename Policy>
+double churn(long nevents, int nparticles) {
+  typedef Handle<Policy> H;
+  Clock::time_point start = Clock::now();
+  for ( long ieve = 0; ieve < nevents; ++ieve ) {
+    vector<H> step, final, charged;
+    step.reserve(nparticles);
+    for ( int i = 0; i < nparticles; ++i )
+      step.push_back(H(new Counted<Policy>()));
+    for ( int istep = 0; istep < 4; ++istep ) {
+      vector<H> copy(step);
+      final = copy;
+      charged.clear();
+      for ( int i = 0; i < nparticles; i += 2 ) charged.push_back(copy[i]);
+    }
+  }
+  return seconds(start);
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  string run;
+  long N = 1000;
+  long nchurn = 20000;
+  int nparticles = 200;
+
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) N = atoi(argv[++iarg]);
+    else if ( arg == "-C" ) nchurn = atoi(argv[++iarg]);
+    else if ( arg == "-P" ) nparticles = atoi(argv[++iarg]);
+    else if ( arg == "-l" ) DynamicLoader::appendPath(argv[++iarg]);
+    else if ( arg == "-L" ) DynamicLoader::prependPath(argv[++iarg]);
+    else if ( arg == "-h" ) {
+      cerr << "Usage: " << argv[0] << " [-N events] [-C churn-events] "
+	   << "[-P particles] [-l load-path] [-L first-load-path] [run-file]"
+	   << endl;
+      return 3;
+    }
+    else run = arg;
+  }
+
+  double nops = double(nchurn)*double(nparticles);
+
+  double tplain = churn< Pointer::ReferenceCounterPolicy<false> >
+    (nchurn, nparticles);
+  double tatomic = churn< Pointer::ReferenceCounterPolicy<true> >
+    (nchurn, nparticles);
+
+  cout << "Synthetic particle churn (" << nchurn << " events with "
+       << nparticles << " particles):" << endl
+       << "  plain counter:  " << setw(8) << tplain << " s ("
+       << 1.0e9*tplain/nops << " ns/particle)" << endl
+       << "  atomic counter: " << setw(8) << tatomic << " s ("
+       << 1.0e9*tatomic/nops << " ns/particle)" << endl
+       << "  overhead:       " << setw(8)
+       << 100.0*(tatomic - tplain)/tplain << " %" << endl;
+
+  if ( run.empty() ) return 0;
+
+  try {
+    PersistentIStream is(run);
+    EGPtr eg;
+    is >> eg;
+    if ( !eg ) {
+      cerr << "No generator found in " << run << "." << endl;
+      return 1;
+    }
+    eg->initialize();
+    // The generator may stop before N events if so specified in the
+    // run file.
+    long n = 0;
+    Clock::time_point start = Clock::now();
+    while ( n < N && eg->shoot() ) ++n;
+    double t = seconds(start);
+    eg->finalize();
+    cout << "Generated " << n << " events from " << run << " with "
+#ifdef ThePEG_ATOMIC_REFCOUNT
+	 << "atomic"
+#else
+	 << "plain"
+#endif
+	 << " reference counting: " << t << " s ("
+	 << 1.0e3*t/max(n, 1L) << " ms/event)" << endl;
+  }
+  catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
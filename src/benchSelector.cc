@@ -0,0 +1,129 @@
+// -*- C++ -*-
+//
+// benchSelector.cc is a part of ThePEG - Toolkit for HEP Event Generation
+// Copyright (C) 1999-2019 Leif Lonnblad
+//
+// ThePEG is licenced under version 3 of the GPL, see COPYING for details.
+// Please respect the MCnet academic guidelines, see GUIDELINES for details.
+//
+// Microbenchmark comparing the selection time of Selector and
+// VSelector with and without the alias table built by freeze(), for
+// selectors with between 2 and 10000 objects with random weights. The
+// frequencies of the selected objects and the mean of the remainders
+// are compared to the expected ones, to check that the frozen
+// selectors give the same distributions.
+//
+#include "ThePEG/Utilities/Selector.h"
+#include "ThePEG/Utilities/VSelector.h"
+#include <chrono>
+#include <random>
+
+using namespace ThePEG;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Flat random numbers in the interval ]0,1[.
+ */
+struct Random {
+  Random(): engine(4711) {}
+  double operator()() {
+    double r = 0.0;
+    while ( r <= 0.0 ) r = flat(engine);
+    return r;
+  }
+  std::mt19937_64 engine;
+  std::uniform_real_distribution<double> flat;
+};
+
+/**
+ * The result of selecting a number of times from a selector.
+ */
+struct Result {
+  /** The time per selection in nanoseconds. */
+  double ns;
+  /** The largest deviation from the expected frequency in standard
+      deviations. */
+  double pull;
+  /** The mean of the remainders. */
+  double remainder;
+};
+
+/**
+ * Select \a nsel times from \a sel, which has objects 0..n-1 with the
+ * given \a weights, and compare with the expected frequencies.
+ */
+template <typename Sel>
+Result bench(const Sel & sel, const vector<double> & weights, long nsel) {
+  Random rnd;
+  vector<long> count(weights.size(), 0);
+  double sumrem = 0.0;
+  Clock::time_point start = Clock::now();
+  for ( long i = 0; i < nsel; ++i ) {
+    double rem = 0.0;
+    ++count[sel.select(rnd(), &rem)];
+    sumrem += rem;
+  }
+  Result res;
+  res.ns = 1.0e9*seconds(start)/nsel;
+  double sum = 0.0;
+  for ( int i = 0, N = weights.size(); i < N; ++i ) sum += weights[i];
+  res.pull = 0.0;
+  for ( int i = 0, N = weights.size(); i < N; ++i ) {
+    double expect = nsel*weights[i]/sum;
+    if ( expect > 0.0 )
+      res.pull = max(res.pull, abs(count[i] - expect)/sqrt(expect));
+  }
+  res.remainder = sumrem/nsel;
+  return res;
+}
+
+void print(string name, const Result & res) {
+  cout << "  " << setw(16) << left << name << right
+       << setw(8) << setprecision(3) << res.ns << " ns  max pull "
+       << setw(6) << setprecision(3) << res.pull << "  <remainder> "
+       << setprecision(4) << res.remainder << endl;
+}
+
+}
+
+int main(int argc, char * argv[]) {
+
+  long nsel = 10000000;
+  for ( int iarg = 1; iarg < argc; ++iarg ) {
+    string arg = argv[iarg];
+    if ( arg == "-N" ) nsel = atol(argv[++iarg]);
+    else {
+      cerr << "Usage: " << argv[0] << " [-N selections]" << endl;
+      return 3;
+    }
+  }
+
+  int sizes[] = { 2, 10, 100, 1000, 10000 };
+  for ( int size : sizes ) {
+    Random rnd;
+    vector<double> weights(size);
+    Selector<int> sel;
+    VSelector<int> vsel;
+    for ( int i = 0; i < size; ++i ) {
+      weights[i] = rnd();
+      sel.insert(weights[i], i);
+      vsel.insert(weights[i], i);
+    }
+    cout << size << " objects:" << endl;
+    print("Selector", bench(sel, weights, nsel));
+    print("VSelector", bench(vsel, weights, nsel));
+    sel.freeze();
+    vsel.freeze();
+    print("Selector alias", bench(sel, weights, nsel));
+    print("VSelector alias", bench(vsel, weights, nsel));
+  }
+
+  return 0;
+}
@@ -25,8 +25,11 @@ int main(int argc, char * argv[]) {
   string mainclass;
   bool tics = false;
   bool resume = false;
+  unsigned int nthreads = 1;
+  bool ordered = true;
   string tag = "";
   string setupfile = "";
+  bool stats = false;
 
   for ( int iarg = 1; iarg < argc; ++iarg ) {
     string arg = argv[iarg];
@@ -51,12 +54,19 @@ int main(int argc, char * argv[]) {
     else if ( arg == "--seed" || arg == "-seed" ) seed = atol(argv[++iarg]);
     else if ( arg == "--tics" || arg == "-tics" ) tics = true;
     else if ( arg == "--resume" ) resume = true;
+    else if ( arg == "-j" || arg == "--threads" ) nthreads = atoi(argv[++iarg]);
+    else if ( arg.substr(0,2) == "-j" ) nthreads = atoi(arg.substr(2).c_str());
+    else if ( arg.substr(0,10) == "--threads=" )
+      nthreads = atoi(arg.substr(10).c_str());
+    else if ( arg == "--unordered" ) ordered = false;
+    else if ( arg == "--stats" ) stats = true;
     else if ( arg == "-t" ) tag = argv[++iarg];
     else if ( arg.substr(0,2) == "-t" ) tag = arg.substr(2);
     else if ( arg.substr(0,6) == "--tag=" ) tag = arg.substr(6);
     else if ( arg == "--help" || arg == "-h" ) {
     cerr << "Usage: " << argv[0] << " [-d {debuglevel|-debugitem}] "
-	 << "[-l load-path] [-L first-load-path] [-m setup-file] run-file" << endl;
+	 << "[-l load-path] [-L first-load-path] [-m setup-file] "
+	 << "[-j threads [--unordered]] [--stats] run-file" << endl;
       return 3;
     }
     else if ( arg == "-v" || arg == "--version" ) {
@@ -76,14 +86,15 @@ int main(int argc, char * argv[]) {
 
   try {
 
+    // If requested, the stream is kept during the run, so that the
+    // number of objects read in from an indexed run-file can be
+    // reported at the end.
     EGPtr eg;
-    if ( run == "-" ) {
-      PersistentIStream is(cin);
-      is >> eg;
-    } else {
-      PersistentIStream is(run);
-      is >> eg;
-    }
+    std::unique_ptr<PersistentIStream> is;
+    if ( run == "-" ) is.reset(new PersistentIStream(cin));
+    else is.reset(new PersistentIStream(run));
+    *is >> eg;
+    if ( !stats ) is.reset();
 
     breakThePEG();
 
@@ -105,7 +116,14 @@ int main(int argc, char * argv[]) {
       if ( !eg->loadMain(mainclass) )
 	std::cout << "Main class file '" << mainclass << "' not found." << endl;
     } else {
-      eg->go(resume? -1: 1, N, tics);
+      eg->go(resume? -1: 1, N, tics, nthreads, ordered);
+    }
+
+    if ( stats ) {
+      unsigned long nread = is->objectsRead();
+      unsigned long nall = is->indexed()? is->objectsIndexed(): nread;
+      cout << "Read " << nread << " of " << nall << " objects from "
+	   << run << "." << endl;
     }
   }
   catch ( Exception & e ) {
@@ -17,6 +17,7 @@
 #include "ThePEG/Utilities/Debug.h"
 #include "ThePEG/Utilities/Exception.h"
 #include "ThePEG/Utilities/DynamicLoader.h"
+#include "ThePEG/Persistency/PersistentOStream.h"
 
 int main(int argc, char * argv[]) {
   using namespace ThePEG;
@@ -47,6 +48,8 @@ int main(int argc, char * argv[]) {
       Debug::level = 0;
     }
     else if ( arg == "--exitonerror" ) repository.exitOnError() = 1;
+    else if ( arg == "--binary" ) PersistentOStream::binaryDefault() = true;
+    else if ( arg == "--indexed" ) PersistentOStream::indexedDefault() = true;
     else if ( arg == "-s" ) {
       DynamicLoader::load(argv[++iarg]);
       repository.globalLibraries().push_back(argv[iarg]);
@@ -82,7 +85,8 @@ int main(int argc, char * argv[]) {
     else if ( arg == "-h" || arg == "--help" ) {
       cerr << "Usage: " << argv[0]
 	 << " {cmdfile} [-d {debuglevel|-debugitem}] [-r input-repository-file]"
-	 << " [-l load-path] [-L first-load-path]" << endl;
+	 << " [-l load-path] [-L first-load-path] [--binary] [--indexed]"
+	 << endl;
       return 3;
     }
     else if ( arg == "-v" || arg == "--version" ) {